@@ -18,6 +18,22 @@ local function qtDebugLib(libname)
 	end
 end
 
+local function fuzzerDefines()
+	if (_OPTIONS["fuzzer"]) then
+		return {"BURGWAR_LIBFUZZER"}
+	else
+		return {}
+	end
+end
+
+local function fuzzerOptions()
+	if (_OPTIONS["fuzzer"]) then
+		return {"-fsanitize=fuzzer,address,undefined"}
+	else
+		return {}
+	end
+end
+
 WorkspaceName = "Burgwar"
 Projects = {
 	{
@@ -150,6 +166,47 @@ Projects = {
 		LibsDebug = {qtDebugLib("Qt5Core"), qtDebugLib("Qt5Gui"), qtDebugLib("Qt5Widgets"), "NazaraAudio-d", "NazaraCore-d", "NazaraLua-d", "NazaraGraphics-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraRenderer-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraPlatform-d", "NazaraSDK-d", "NazaraUtility-d"},
 		LibsRelease = {"Qt5Core", "Qt5Gui", "Qt5Widgets", "NazaraAudio", "NazaraCore", "NazaraLua", "NazaraGraphics", "NazaraNetwork", "NazaraNoise", "NazaraRenderer", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraPlatform", "NazaraSDK", "NazaraUtility"},
 		AdditionalDependencies = {"Newton", "libsndfile-1", "soft_oal"}
+	},
+	{
+		Group = "Tools",
+		Name = "BWPacketBench",
+		Kind = "ConsoleApp",
+		Defines = {},
+		Files = {
+			"../src/PacketBench/**.hpp",
+			"../src/PacketBench/**.inl",
+			"../src/PacketBench/**.cpp"
+		},
+		Frameworks = {"Nazara"},
+		LinkStatic = {},
+		LinkStaticDebug = {"CoreLib-d", "lua-d", "libfmt-d"},
+		LinkStaticRelease = {"CoreLib", "lua", "libfmt"},
+		Libs = {},
+		LibsDebug = {"NazaraCore-d", "NazaraLua-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraSDKServer-d", "NazaraUtility-d"},
+		LibsRelease = {"NazaraCore", "NazaraLua", "NazaraNetwork", "NazaraNoise", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraSDKServer", "NazaraUtility"},
+		AdditionalDependencies = {"Newton"}
+	},
+	{
+		Group = "Tools",
+		Name = "BWPacketFuzz",
+		Kind = "ConsoleApp",
+		Defines = fuzzerDefines(),
+		BuildOptions = fuzzerOptions(),
+		LinkOptions = fuzzerOptions(),
+		Files = {
+			"../src/CoreLib/Protocol/Packets.cpp", -- built again here so the fuzzer instruments it
+			"../src/PacketFuzz/**.hpp",
+			"../src/PacketFuzz/**.inl",
+			"../src/PacketFuzz/**.cpp"
+		},
+		Frameworks = {"Nazara"},
+		LinkStatic = {},
+		LinkStaticDebug = {"CoreLib-d", "lua-d", "libfmt-d"},
+		LinkStaticRelease = {"CoreLib", "lua", "libfmt"},
+		Libs = {},
+		LibsDebug = {"NazaraCore-d", "NazaraLua-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraSDKServer-d", "NazaraUtility-d"},
+		LibsRelease = {"NazaraCore", "NazaraLua", "NazaraNetwork", "NazaraNoise", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraSDKServer", "NazaraUtility"},
+		AdditionalDependencies = {"Newton"}
 	}
 }
 
@@ -296,6 +353,14 @@ workspace("Burgwar")
 				defines(projectData.Defines)
 				files(projectData.Files)
 
+				if (projectData.BuildOptions) then
+					buildoptions(projectData.BuildOptions)
+				end
+
+				if (projectData.LinkOptions) then
+					linkoptions(projectData.LinkOptions)
+				end
+
 				if (not projectData.DisableWarnings) then
 					warnings("Extra")
 				end
@@ -445,6 +510,11 @@ workspace("Burgwar")
 		}
 	})
 
+	newoption({
+		trigger     = "fuzzer",
+		description = "Build BWPacketFuzz against libFuzzer (clang only) instead of the standalone/AFL entry point"
+	})
+
 	newaction {
 		trigger = "thirdparty_sync",
 		description = "Update .dll files from thirdparty directory",
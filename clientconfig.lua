@@ -1,16 +1,46 @@
 Assets = {
 	ResourceFolder = "resources",
+	ScriptCacheFolder = "scriptcache",
 	ScriptFolder  = "scripts"
 }
 Debug = {
+	NetworkSimulation = {
+		Bandwidth = 0, -- bytes per second, 0 for unlimited
+		DuplicationChance = 0.0,
+		Jitter = 0, -- ms
+		JitterDistribution = "uniform", -- uniform|normal
+		Latency = 0, -- ms, one-way
+		LossBurstLength = 1.0,
+		LossChance = 0.0,
+		ReorderChance = 0.0
+	},
 	SendServerState = false,
 	ShowConnectionData = "ping", -- ping|download|upload|usage
 	ShowServerGhosts = false
 }
 GameSettings = {
+	EntityInstantiationBudget = 4000, -- microseconds per frame spent instantiating received entities
+	LayerCacheSize = 10000, -- entities of disabled layers kept for a fast re-entry, 0 to disable
 	MapFile = "mapdetest.bmap",
+	ScriptMemoryLimit = 256, -- MiB, 0 for unlimited
 	TickRate = 33,
 }
+Network = {
+	ConnectionLimits = { -- incoming peers stay pending until their first packet
+		AddressBurst = 5,
+		AddressRate = 1.0, -- connections per second and per address, 0 for unlimited
+		MaxPending = 16, -- oldest pending connections are dropped beyond this, the server also reserves as many extra peer slots for them
+		MaxPendingPerAddress = 2,
+		PendingTimeout = 2000 -- ms
+	},
+	PacketBudgets = { -- per session, excess packets are dropped
+		KickThreshold = 20, -- dropped packets before kicking, 0 to never kick
+		PlayerChat = { Burst = 5, Rate = 1.0 }, -- Rate in packets per second, 0 for unlimited
+		PlayerConsoleCommand = { Burst = 10, Rate = 2.0 },
+		ScriptPacket = { Burst = 60, Rate = 30.0 },
+		UpdatePlayerName = { Burst = 3, Rate = 0.2 }
+	}
+}
 WindowSettings = {
 	AntialiasingLevel = 8,
 	Fullscreen = false,
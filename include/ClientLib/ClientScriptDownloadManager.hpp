@@ -8,6 +8,10 @@
 #define BURGWAR_CLIENTLIB_DOWNLOADMANAGER_HPP
 
 #include <ClientLib/ClientSession.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
+#include <array>
+#include <atomic>
 #include <filesystem>
 #include <vector>
 
@@ -17,30 +21,54 @@ namespace bw
 	{
 		public:
 			ClientScriptDownloadManager(std::filesystem::path clientFileCache, std::shared_ptr<ClientSession> clientSession);
-			~ClientScriptDownloadManager() = default;
+			~ClientScriptDownloadManager();
 
 			void RegisterFile(const std::string& filePath, const std::array<Nz::UInt8, 20> & checksum);
 
 			void Start();
 
+			void Update();
+
 			NazaraSignal(OnDownloadRequest, ClientScriptDownloadManager* /*downloadManager*/, const Packets::DownloadClientScriptRequest& /*request*/);
 			NazaraSignal(OnFileChecked, ClientScriptDownloadManager* /*downloadManager*/, const std::string& /*downloadPath*/, const std::vector<Nz::UInt8>& /*content*/);
 			NazaraSignal(OnFinished, ClientScriptDownloadManager* /*downloadManager*/);
 
+			static constexpr std::size_t MaxPendingRequests = 32;
+
 		private:
 			void HandlePacket(const Packets::DownloadClientScriptResponse& packet);
-			void RequestNextFile();
+			void LoadCacheIndex();
+			void RequestFiles();
+			void SaveCacheIndex();
+			void UpdateCacheIndex(const std::filesystem::path& cachedFilePath);
+			void ValidateCache();
 
-			struct PendingFile
+			struct CacheEntry
 			{
-				std::string downloadPath;
+				Nz::Int64 lastWriteTime;
+				Nz::UInt64 size;
+			};
+
+			struct RegisteredFile
+			{
+				std::array<Nz::UInt8, 20> checksum;
 				std::filesystem::path outputPath;
+				std::string downloadPath;
+				std::vector<Nz::UInt8> content;
+				bool isValid = false;
 			};
 
+			std::atomic_bool m_cancelValidation;
+			std::atomic_bool m_isValidationDone;
 			std::filesystem::path m_clientFileCache;
 			std::shared_ptr<ClientSession> m_clientSession;
-			std::size_t m_currentFileIndex;
-			std::vector<PendingFile> m_downloadList;
+			std::size_t m_nextRequestIndex;
+			std::size_t m_nextResponseIndex;
+			std::vector<std::size_t> m_downloadList;
+			std::vector<RegisteredFile> m_files;
+			tsl::hopscotch_map<std::string /*outputPath*/, CacheEntry> m_cacheIndex;
+			Nz::Thread m_validationThread;
+			bool m_isStarted;
 
 			NazaraSlot(ClientSession, OnDownloadClientScriptResponse, m_onDownloadResponseSlot);
 	};
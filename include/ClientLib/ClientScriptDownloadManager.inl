@@ -6,10 +6,4 @@
 
 namespace bw
 {
-	inline ClientScriptDownloadManager::ClientScriptDownloadManager(std::filesystem::path clientFileCache, std::shared_ptr<ClientSession> clientSession) :
-	m_clientFileCache(std::move(clientFileCache)),
-	m_clientSession(std::move(clientSession)),
-	m_currentFileIndex(0)
-	{
-	}
 }
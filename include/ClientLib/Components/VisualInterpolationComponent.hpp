@@ -10,6 +10,7 @@
 #include <ClientLib/LocalLayerEntity.hpp>
 #include <Nazara/Math/Angle.hpp>
 #include <NDK/Component.hpp>
+#include <array>
 
 namespace bw
 {
@@ -18,19 +19,46 @@ namespace bw
 		friend class VisualInterpolationSystem;
 
 		public:
+			struct Snapshot;
+
 			inline VisualInterpolationComponent();
 			~VisualInterpolationComponent() = default;
 
+			inline void ClearSnapshots();
+
+			inline void EnableSnapshotInterpolation(bool enable = true);
+
+			inline bool IsSnapshotInterpolationEnabled() const;
+
+			inline void PushSnapshot(double time, const Nz::Vector2f& position, const Nz::RadianAnglef& rotation, const Nz::Vector2f& linearVelocity, const Nz::RadianAnglef& angularVelocity);
+
+			struct Snapshot
+			{
+				Nz::RadianAnglef angularVelocity;
+				Nz::RadianAnglef rotation;
+				Nz::Vector2f linearVelocity;
+				Nz::Vector2f position;
+				double time;
+			};
+
+			static constexpr std::size_t MaxSnapshotCount = 16;
+
 			static Ndk::ComponentIndex componentIndex;
 
 		private:
 			inline const Nz::Vector2f& GetLastPosition();
 			inline const Nz::RadianAnglef& GetLastRotation();
+			inline const Snapshot& GetSnapshot(std::size_t snapshotIndex) const;
+			inline std::size_t GetSnapshotCount() const;
 
 			inline void UpdateLastStates(const Nz::Vector2f& position, const Nz::RadianAnglef& rotation);
 
+			std::array<Snapshot, MaxSnapshotCount> m_snapshots; //< ring buffer of server states, oldest first from m_firstSnapshot
+			std::size_t m_firstSnapshot;
+			std::size_t m_snapshotCount;
 			Nz::RadianAnglef m_lastRotation;
 			Nz::Vector2f m_lastPosition;
+			bool m_isSnapshotInterpolationEnabled;
 	};
 }
 
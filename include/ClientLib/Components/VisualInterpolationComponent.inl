@@ -3,15 +3,53 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <ClientLib/Components/VisualInterpolationComponent.hpp>
+#include <cassert>
 
 namespace bw
 {
 	inline VisualInterpolationComponent::VisualInterpolationComponent() :
+	m_firstSnapshot(0),
+	m_snapshotCount(0),
+	m_lastRotation(Nz::RadianAnglef::Zero()),
 	m_lastPosition(Nz::Vector2f::Zero()),
-	m_lastRotation(Nz::RadianAnglef::Zero())
+	m_isSnapshotInterpolationEnabled(true)
 	{
 	}
 
+	inline void VisualInterpolationComponent::ClearSnapshots()
+	{
+		m_firstSnapshot = 0;
+		m_snapshotCount = 0;
+	}
+
+	inline void VisualInterpolationComponent::EnableSnapshotInterpolation(bool enable)
+	{
+		m_isSnapshotInterpolationEnabled = enable;
+		if (!enable)
+			ClearSnapshots();
+	}
+
+	inline bool VisualInterpolationComponent::IsSnapshotInterpolationEnabled() const
+	{
+		return m_isSnapshotInterpolationEnabled;
+	}
+
+	inline void VisualInterpolationComponent::PushSnapshot(double time, const Nz::Vector2f& position, const Nz::RadianAnglef& rotation, const Nz::Vector2f& linearVelocity, const Nz::RadianAnglef& angularVelocity)
+	{
+		std::size_t snapshotIndex = (m_firstSnapshot + m_snapshotCount) % MaxSnapshotCount;
+		if (m_snapshotCount == MaxSnapshotCount)
+			m_firstSnapshot = (m_firstSnapshot + 1) % MaxSnapshotCount; //< Overwrite oldest snapshot
+		else
+			m_snapshotCount++;
+
+		Snapshot& snapshot = m_snapshots[snapshotIndex];
+		snapshot.angularVelocity = angularVelocity;
+		snapshot.linearVelocity = linearVelocity;
+		snapshot.position = position;
+		snapshot.rotation = rotation;
+		snapshot.time = time;
+	}
+
 	inline const Nz::Vector2f& VisualInterpolationComponent::GetLastPosition()
 	{
 		return m_lastPosition;
@@ -21,6 +59,17 @@ namespace bw
 	{
 		return m_lastRotation;
 	}
+
+	inline auto VisualInterpolationComponent::GetSnapshot(std::size_t snapshotIndex) const -> const Snapshot&
+	{
+		assert(snapshotIndex < m_snapshotCount);
+		return m_snapshots[(m_firstSnapshot + snapshotIndex) % MaxSnapshotCount];
+	}
+
+	inline std::size_t VisualInterpolationComponent::GetSnapshotCount() const
+	{
+		return m_snapshotCount;
+	}
 	
 	inline void VisualInterpolationComponent::UpdateLastStates(const Nz::Vector2f& position, const Nz::RadianAnglef& rotation)
 	{
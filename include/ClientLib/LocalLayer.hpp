@@ -32,7 +32,7 @@ namespace bw
 			LocalLayer(LocalLayer&&) noexcept;
 			~LocalLayer();
 
-			inline void Disable();
+			void Disable(bool keepServerEntities = false);
 			void Enable(bool enable = true);
 			inline void EnablePrediction(bool enable = true);
 
@@ -43,6 +43,10 @@ namespace bw
 			inline std::optional<std::reference_wrapper<LocalLayerEntity>> GetEntity(Nz::UInt32 serverId);
 			LocalMatch& GetLocalMatch();
 
+			inline bool HasPendingEntities() const;
+
+			void InstantiatePendingEntities(const Nz::Vector2f& focusPosition, Nz::UInt64 deadline);
+
 			inline bool IsEnabled() const;
 			inline bool IsPredictionEnabled() const;
 
@@ -71,14 +75,18 @@ namespace bw
 			void CreateEntity(Nz::UInt32 entityId, const Packets::Helper::EntityData& entityData);
 			void HandleClientEntityDestruction(Ndk::Entity* entity);
 			void HandleServerEntityDestruction(Nz::UInt32 serverId);
-			void HandlePacket(const Packets::CreateEntities::Entity* entities, std::size_t entityCount);
+			void HandlePacket(Packets::CreateEntities::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::DeleteEntities::Entity* entities, std::size_t entityCount);
-			void HandlePacket(const Packets::EnableLayer::Entity* entities, std::size_t entityCount);
+			void HandlePacket(Packets::EnableLayer::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::EntitiesAnimation::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::EntitiesDeath::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::EntitiesInputs::Entity* entities, std::size_t entityCount);
+			void HandlePacket(const Packets::EntitiesLayerChange::Entity* entities, std::size_t entityCount, LocalLayer& newLayer);
+			void HandlePacket(const Packets::EntitiesPropertyUpdate::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::HealthUpdate::Entity* entities, std::size_t entityCount);
 			void HandlePacket(const Packets::MatchState::Entity* entities, std::size_t entityCount);
+			bool InstantiatePendingEntity(Nz::UInt32 serverId);
+			void RemoveDormantEntity(Nz::UInt32 serverId);
 
 			struct EntityData
 			{
@@ -109,7 +117,9 @@ namespace bw
 
 			tsl::hopscotch_map<Ndk::EntityId /*clientEntityId*/, EntityData /*localEntity*/> m_clientEntities;
 			tsl::hopscotch_map<Nz::UInt32 /*serverEntityId*/, EntityData /*localEntity*/> m_serverEntities;
+			tsl::hopscotch_map<Nz::UInt32 /*serverEntityId*/, Packets::Helper::EntityData> m_pendingEntities; //< received but not instantiated yet
 			std::vector<std::optional<SoundData>> m_sounds;
+			std::vector<std::pair<float /*squaredDistance*/, Nz::UInt32 /*serverEntityId*/>> m_pendingEntityOrder;
 			Nz::Bitset<Nz::UInt64> m_freeSoundIds;
 			Nz::Color m_backgroundColor;
 			bool m_isEnabled;
@@ -6,11 +6,6 @@
 
 namespace bw
 {
-	inline void LocalLayer::Disable()
-	{
-		return Enable(false);
-	}
-
 	inline void LocalLayer::EnablePrediction(bool enable)
 	{
 		m_isPredictionEnabled = enable;
@@ -56,6 +51,11 @@ namespace bw
 		return it.value().layerEntity;
 	}
 
+	inline bool LocalLayer::HasPendingEntities() const
+	{
+		return !m_pendingEntities.empty();
+	}
+
 	inline bool LocalLayer::IsEnabled() const
 	{
 		return m_isEnabled;
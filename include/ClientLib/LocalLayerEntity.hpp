@@ -60,6 +60,8 @@ namespace bw
 			bool IsFacingRight() const;
 			bool IsPhysical() const;
 
+			void MoveToLayer(LocalLayer& layer, Nz::UInt32 serverEntityId);
+
 			void SyncVisuals();
 
 			void UpdateAnimation(Nz::UInt8 animationId);
@@ -121,7 +123,7 @@ namespace bw
 			Nz::Int64 m_uniqueId;
 			Nz::UInt32 m_serverEntityId;
 			LocalLayerEntityHandle m_weaponEntity;
-			LocalLayer& m_layer;
+			LocalLayer* m_layer;
 	};
 }
 
@@ -81,6 +81,7 @@ namespace bw
 			const NetworkStringStore& GetNetworkStringStore() const override;
 			inline ParticleRegistry& GetParticleRegistry();
 			inline const ParticleRegistry& GetParticleRegistry() const;
+			const std::shared_ptr<ScriptingContext>& GetScriptingContext() const override;
 			inline Ndk::World& GetRenderWorld();
 			ClientWeaponStore& GetWeaponStore() override;
 			const ClientWeaponStore& GetWeaponStore() const override;
@@ -93,6 +94,7 @@ namespace bw
 			inline void Quit();
 
 			void RegisterEntity(Nz::Int64 uniqueId, LocalLayerEntityHandle entity);
+			void ReloadScripts(const std::shared_ptr<VirtualDirectory>& scriptDir, const std::vector<std::string>& changedScripts);
 			
 			const Ndk::EntityHandle& RetrieveEntityByUniqueId(Nz::Int64 uniqueId) const override;
 			Nz::Int64 RetrieveUniqueIdByEntity(const Ndk::EntityHandle& entity) const override;
@@ -121,6 +123,8 @@ namespace bw
 				Packets::EntitiesAnimation,
 				Packets::EntitiesDeath,
 				Packets::EntitiesInputs,
+				Packets::EntitiesLayerChange,
+				Packets::EntitiesPropertyUpdate,
 				Packets::EntityWeapon,
 				Packets::HealthUpdate,
 				Packets::MatchState,
@@ -147,6 +151,8 @@ namespace bw
 			void HandleTickPacket(Packets::EntitiesAnimation&& packet);
 			void HandleTickPacket(Packets::EntitiesDeath&& packet);
 			void HandleTickPacket(Packets::EntitiesInputs&& packet);
+			void HandleTickPacket(Packets::EntitiesLayerChange&& packet);
+			void HandleTickPacket(Packets::EntitiesPropertyUpdate&& packet);
 			void HandleTickPacket(Packets::EntityWeapon&& packet);
 			void HandleTickPacket(Packets::HealthUpdate&& packet);
 			void HandleTickPacket(Packets::MatchState&& packet);
@@ -155,6 +161,7 @@ namespace bw
 			void HandleTickError(Nz::UInt16 serverTick, Nz::Int32 tickError);
 			void InitializeRemoteConsole();
 			void InitializeScoreboard();
+			void InstantiatePendingEntities();
 			void OnTick(bool lastTick) override;
 			void PushTickPacket(Nz::UInt16 tick, const TickPacketContent& packet);
 			bool SendInputs(Nz::UInt16 serverTick, bool force);
@@ -176,6 +183,14 @@ namespace bw
 				PlayerInputData lastInputData;
 			};
 
+			struct PhysicsState
+			{
+				Nz::RadianAnglef angularVelocity;
+				Nz::RadianAnglef rotation;
+				Nz::Vector2f linearVelocity;
+				Nz::Vector2f position;
+			};
+
 			struct PredictedInput
 			{
 				struct MovementData
@@ -198,6 +213,7 @@ namespace bw
 					PlayerInputData input;
 					PlayerInputData previousInput;
 					std::optional<MovementData> movement;
+					std::optional<PhysicsState> predictedState; //< controlled entity state after this tick
 					std::vector<WeaponData> weapons;
 				};
 
@@ -217,6 +233,12 @@ namespace bw
 				TickPacketContent content;
 			};
 
+			static std::optional<PhysicsState> RetrievePhysicsState(const Ndk::EntityHandle& entity);
+
+			// Server state differing less than this from our prediction doesn't trigger a re-simulation
+			static constexpr float PredictionPositionErrorThreshold = 1.f;
+			static constexpr float PredictionVelocityErrorThreshold = 5.f;
+
 			NazaraSlot(Nz::RenderTarget, OnRenderTargetSizeChange, m_onRenderTargetSizeChange);
 			NazaraSlot(Nz::EventHandler, OnGainedFocus, m_onGainedFocus);
 			NazaraSlot(Nz::EventHandler, OnLostFocus, m_onLostFocus);
@@ -251,6 +273,7 @@ namespace bw
 			Nz::Int64 m_freeClientId;
 			Nz::RenderTarget* m_renderTarget;
 			Nz::RenderWindow* m_window;
+			Nz::UInt64 m_entityInstantiationBudget; //< microseconds per frame spent instantiating received entities
 			Nz::UInt16 m_activeLayerIndex;
 			tsl::hopscotch_map<Nz::Int64, LocalLayerEntityHandle> m_entitiesByUniqueId;
 			AnimationManager m_animationManager;
@@ -7,6 +7,7 @@
 #ifndef BURGWAR_CLIENTLIB_LOCALSESSIONMANAGER_HPP
 #define BURGWAR_CLIENTLIB_LOCALSESSIONMANAGER_HPP
 
+#include <CoreLib/NetworkConditionSimulator.hpp>
 #include <CoreLib/SessionManager.hpp>
 #include <Nazara/Core/MemoryPool.hpp>
 #include <optional>
@@ -30,9 +31,11 @@ namespace bw
 
 			void Poll() override;
 
+			void SimulateNetworkConditions(const NetworkConditions& conditions);
+
 		private:
 			void DisconnectPeer(std::size_t peerId);
-			void SendPacket(std::size_t peerId, Nz::NetPacket&& packet, bool isServer);
+			void SendPacket(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet, bool isServer);
 
 			struct Peer
 			{
@@ -40,10 +43,13 @@ namespace bw
 				std::shared_ptr<LocalSessionBridge> serverBridge;
 				std::vector<Nz::NetPacket> clientPackets;
 				std::vector<Nz::NetPacket> serverPackets;
+				std::optional<NetworkConditionSimulator> clientSimulator;
+				std::optional<NetworkConditionSimulator> serverSimulator;
 				MatchClientSession* session;
 				bool disconnectionRequested = false;
 			};
 
+			std::optional<NetworkConditions> m_simulatedConditions;
 			std::vector<std::optional<Peer>> m_peers;
 	};
 }
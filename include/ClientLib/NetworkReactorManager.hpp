@@ -9,6 +9,7 @@
 
 #include <CoreLib/NetworkReactor.hpp>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace bw
@@ -30,6 +31,8 @@ namespace bw
 			inline const std::unique_ptr<NetworkReactor>& GetReactor(std::size_t reactorId);
 			inline std::size_t GetReactorCount() const;
 
+			void SimulateNetworkConditions(const NetworkConditions& conditions);
+
 			void Update();
 
 		private:
@@ -38,6 +41,7 @@ namespace bw
 			void HandlePeerPacket(std::size_t peerId, Nz::NetPacket& packet);
 
 			std::vector<std::unique_ptr<NetworkReactor>> m_reactors;
+			std::optional<NetworkConditions> m_simulatedConditions;
 			std::vector<std::shared_ptr<NetworkSessionBridge>> m_connections;
 			const Logger& m_logger;
 	};
@@ -14,6 +14,9 @@ namespace bw
 
 	inline std::size_t NetworkReactorManager::AddReactor(std::unique_ptr<NetworkReactor> reactor)
 	{
+		if (m_simulatedConditions)
+			reactor->SimulateNetworkConditions(*m_simulatedConditions);
+
 		m_reactors.emplace_back(std::move(reactor));
 		return m_reactors.size() - 1;
 	}
@@ -7,21 +7,43 @@
 #ifndef BURGWAR_CLIENTLIB_SYSTEMS_VISUALINTERPOLATIONSYSTEM_HPP
 #define BURGWAR_CLIENTLIB_SYSTEMS_VISUALINTERPOLATIONSYSTEM_HPP
 
+#include <Nazara/Math/Angle.hpp>
+#include <Nazara/Math/Vector2.hpp>
 #include <NDK/System.hpp>
+#include <optional>
 
 namespace bw
 {
+	class VisualInterpolationComponent;
+
 	class VisualInterpolationSystem : public Ndk::System<VisualInterpolationSystem>
 	{
 		public:
 			VisualInterpolationSystem();
 			~VisualInterpolationSystem() = default;
 
+			inline double GetCurrentTime() const;
+			inline float GetInterpolationDelay() const;
+
+			double RegisterSnapshot();
+
+			static constexpr float MaxExtrapolation = 0.25f;
+			static constexpr float MaxInterpolationDelay = 0.5f;
+			static constexpr float MinInterpolationDelay = 0.05f;
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
 			void OnEntityAdded(Ndk::Entity* entity) override;
 			void OnUpdate(float elapsedTime) override;
+
+			static void InterpolateSnapshots(const VisualInterpolationComponent& entityLerp, double renderTime, Nz::Vector2f& position, Nz::RadianAnglef& rotation);
+
+			std::optional<double> m_lastSnapshotTime;
+			double m_currentTime; //< double so snapshots stay accurate in long sessions
+			float m_interpolationDelay;
+			float m_snapshotInterval;
+			float m_snapshotJitter;
 	};
 }
 
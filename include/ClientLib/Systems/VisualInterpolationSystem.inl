@@ -6,4 +6,13 @@
 
 namespace bw
 {
+	inline double VisualInterpolationSystem::GetCurrentTime() const
+	{
+		return m_currentTime;
+	}
+
+	inline float VisualInterpolationSystem::GetInterpolationDelay() const
+	{
+		return m_interpolationDelay;
+	}
 }
@@ -36,6 +36,7 @@ namespace bw
 			void SerializePacket(Nz::NetPacket& packet, const T& data) const;
 
 			bool UnserializePacket(PeerRef peer, Nz::NetPacket& packet) const;
+			template<typename F> bool UnserializePacket(PeerRef peer, Nz::NetPacket& packet, F&& acceptCommand) const;
 
 			using UnserializeFunction = std::function<void(PeerRef peer, Nz::NetPacket& packet)>;
 
@@ -44,6 +45,8 @@ namespace bw
 				bool enabled = false;
 				UnserializeFunction unserialize;
 				const char* name;
+				float budgetBurst = 0.f;
+				float budgetRate = 0.f; //< packets per second, 0 means unlimited
 			};
 
 			struct OutgoingCommand
@@ -57,6 +60,7 @@ namespace bw
 		protected:
 			template<typename T, typename CB> void RegisterIncomingCommand(const char* name, CB&& callback);
 			template<typename T> void RegisterOutgoingCommand(const char* name, Nz::ENetPacketFlags flags, Nz::UInt8 channelId);
+			template<typename T> void SetIncomingCommandBudget(float rate, float burst);
 
 		private:
 			using HandleFunction = std::function<void(Nz::NetPacket& packet)>;
@@ -52,7 +52,7 @@ namespace bw
 
 		IncomingCommand& newCommand = m_incomingCommands[packetId];
 		newCommand.enabled = true;
-		newCommand.unserialize = [this, cb = std::forward<CB>(callback)](PeerRef peer, Nz::NetPacket& packet)
+		newCommand.unserialize = [this, name, cb = std::forward<CB>(callback)](PeerRef peer, Nz::NetPacket& packet)
 		{
 			T data;
 			try
@@ -61,9 +61,9 @@ namespace bw
 
 				Packets::Serialize(serializer, data);
 			}
-			catch (const std::exception&)
+			catch (const std::exception& e)
 			{
-				bwLog(m_logger, LogLevel::Error, "Failed to unserialize packet");
+				bwLog(m_logger, LogLevel::Error, "Failed to unserialize packet {0}: {1}", name, e.what());
 				return false;
 			}
 
@@ -105,8 +105,27 @@ namespace bw
 		packet.FlushBits();
 	}
 
+	template<typename Peer>
+	template<typename T>
+	void CommandStore<Peer>::SetIncomingCommandBudget(float rate, float burst)
+	{
+		std::size_t packetId = static_cast<std::size_t>(T::Type);
+		assert(m_incomingCommands.size() > packetId && m_incomingCommands[packetId].enabled);
+
+		IncomingCommand& command = m_incomingCommands[packetId];
+		command.budgetBurst = burst;
+		command.budgetRate = rate;
+	}
+
 	template<typename Peer>
 	bool CommandStore<Peer>::UnserializePacket(PeerRef peer, Nz::NetPacket& packet) const
+	{
+		return UnserializePacket(peer, packet, [](Nz::UInt8 /*opcode*/, const IncomingCommand& /*command*/) { return true; });
+	}
+
+	template<typename Peer>
+	template<typename F>
+	bool CommandStore<Peer>::UnserializePacket(PeerRef peer, Nz::NetPacket& packet, F&& acceptCommand) const
 	{
 		Nz::UInt8 opcode;
 		try
@@ -125,7 +144,12 @@ namespace bw
 			return false;
 		}
 
-		m_incomingCommands[opcode].unserialize(peer, packet);
+		// Filter happens before decoding, rejected packets cost nothing more than their opcode
+		const IncomingCommand& command = m_incomingCommands[opcode];
+		if (!acceptCommand(opcode, command))
+			return false;
+
+		command.unserialize(peer, packet);
 		return true;
 	}
 }
@@ -26,6 +26,8 @@ namespace bw
 
 			inline void Heal(Nz::UInt16 heal);
 
+			inline void ResetHealth();
+
 			static Ndk::ComponentIndex componentIndex;
 
 			NazaraSignal(OnDying, HealthComponent* /*emitter*/, const Ndk::EntityHandle& /*attacker*/);
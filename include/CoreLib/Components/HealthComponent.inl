@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/Components/HealthComponent.hpp>
+#include <CoreLib/Components/MatchComponent.hpp>
 
 namespace bw
 {
@@ -40,7 +41,11 @@ namespace bw
 				if (m_currentHealth == 0)
 				{
 					OnDied(this, attacker);
-					m_entity->Kill();
+
+					if (m_entity->HasComponent<MatchComponent>())
+						m_entity->GetComponent<MatchComponent>().Kill();
+					else
+						m_entity->Kill();
 				}
 			}
 		}
@@ -77,4 +82,10 @@ namespace bw
 			OnHealthChange(this);
 		}
 	}
+
+	inline void HealthComponent::ResetHealth()
+	{
+		// No signal, this is only used on entities which are not part of the world (recycling)
+		m_currentHealth = m_maxHealth;
+	}
 }
@@ -24,6 +24,11 @@ namespace bw
 			inline Match& GetMatch() const;
 			inline Nz::Int64 GetUniqueId() const;
 
+			void Kill(); //< poolable entities go back to their layer pool instead
+
+			inline void UpdateLayerIndex(LayerIndex layerIndex);
+			inline void UpdateUniqueId(Nz::Int64 uniqueId);
+
 			static Ndk::ComponentIndex componentIndex;
 
 		private:
@@ -27,4 +27,14 @@ namespace bw
 	{
 		return m_uniqueId;
 	}
+
+	inline void MatchComponent::UpdateLayerIndex(LayerIndex layerIndex)
+	{
+		m_layerIndex = layerIndex;
+	}
+
+	inline void MatchComponent::UpdateUniqueId(Nz::Int64 uniqueId)
+	{
+		m_uniqueId = uniqueId;
+	}
 }
@@ -8,9 +8,11 @@
 #define BURGWAR_CORELIB_COMPONENTS_SCRIPTCOMPONENT_HPP
 
 #include <CoreLib/EntityProperties.hpp>
+#include <CoreLib/EntityPropertyContainer.hpp>
 #include <CoreLib/LogSystem/EntityLogger.hpp>
 #include <CoreLib/Scripting/ScriptedElement.hpp>
 #include <CoreLib/Scripting/ScriptingContext.hpp>
+#include <Nazara/Core/Signal.hpp>
 #include <NDK/Component.hpp>
 #include <functional>
 #include <optional>
@@ -22,7 +24,7 @@ namespace bw
 	class ScriptComponent : public Ndk::Component<ScriptComponent>
 	{
 		public:
-			ScriptComponent(const Logger& logger, std::shared_ptr<const ScriptedElement> element, std::shared_ptr<ScriptingContext> context, sol::table entityTable, EntityProperties properties);
+			ScriptComponent(const Logger& logger, std::shared_ptr<const ScriptedElement> element, std::shared_ptr<ScriptingContext> context, sol::table entityTable, EntityPropertyContainer properties);
 			~ScriptComponent();
 
 			template<typename... Args>
@@ -31,15 +33,23 @@ namespace bw
 			inline const std::shared_ptr<ScriptingContext>& GetContext();
 			inline const std::shared_ptr<const ScriptedElement>& GetElement() const;
 			inline const EntityLogger& GetLogger() const;
+			inline const EntityPropertyContainer& GetProperties() const;
 			inline std::optional<std::reference_wrapper<const EntityProperty>> GetProperty(const std::string& keyName) const;
-			inline const EntityProperties& GetProperties() const;
+			inline const EntityProperty* GetProperty(std::size_t propertyIndex) const;
 			inline sol::table& GetTable();
 
-			inline void UpdateElement(std::shared_ptr<const ScriptedElement> element);
+			void Recycle(std::shared_ptr<const ScriptedElement> element, sol::table entityTable, EntityPropertyContainer properties);
+			bool Release(); //< detaches the entity from its table, scripts still holding it see a removed entity
+
+			void SetProperty(std::size_t propertyIndex, EntityProperty value);
+
+			void UpdateElement(std::shared_ptr<const ScriptedElement> element);
 			void UpdateEntity(const Ndk::EntityHandle& entity);
 
 			static Ndk::ComponentIndex componentIndex;
 
+			NazaraSignal(OnPropertyUpdate, ScriptComponent* /*emitter*/, std::size_t /*propertyIndex*/);
+
 		private:
 			void OnAttached() override;
 
@@ -47,7 +57,7 @@ namespace bw
 			std::shared_ptr<ScriptingContext> m_context;
 			sol::table m_entityTable;
 			EntityLogger m_logger;
-			EntityProperties m_properties;
+			EntityPropertyContainer m_properties;
 	};
 }
 
@@ -12,6 +12,8 @@ namespace bw
 		sol::protected_function callback = m_entityTable[callbackName];
 		if (callback)
 		{
+			LuaAllocator::OwnerScope allocationOwner(m_context->GetAllocator(), m_element->fullName);
+
 			auto co = m_context->CreateCoroutine(callback);
 
 			auto result = co(m_entityTable, std::forward<Args>(args)...);
@@ -43,32 +45,30 @@ namespace bw
 		return m_logger;
 	}
 
+	inline const EntityPropertyContainer& ScriptComponent::GetProperties() const
+	{
+		return m_properties;
+	}
+
 	inline std::optional<std::reference_wrapper<const EntityProperty>> ScriptComponent::GetProperty(const std::string& keyName) const
 	{
-		// Check specific value
-		if (auto it = m_properties.find(keyName); it != m_properties.end())
-			return it->second;
+		auto it = m_element->properties.find(keyName);
+		if (it == m_element->properties.end())
+			return std::nullopt; // Not found, return nil for now (should we throw an error?)
 
-		// Check default value
-		if (auto it = m_element->properties.find(keyName); it != m_element->properties.end())
-			return it->second.defaultValue;
+		if (const EntityProperty* property = GetProperty(it->second.index))
+			return *property;
 
-		// Not found, return nil for now (should we throw an error?)
 		return std::nullopt;
 	}
 
-	inline const EntityProperties& ScriptComponent::GetProperties() const
+	inline const EntityProperty* ScriptComponent::GetProperty(std::size_t propertyIndex) const
 	{
-		return m_properties;
+		return m_properties.GetProperty(propertyIndex);
 	}
 
 	inline sol::table& ScriptComponent::GetTable()
 	{
 		return m_entityTable;
 	}
-
-	inline void ScriptComponent::UpdateElement(std::shared_ptr<const ScriptedElement> element)
-	{
-		m_element = std::move(element);
-	}
 }
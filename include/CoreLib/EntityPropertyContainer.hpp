@@ -0,0 +1,52 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_ENTITYPROPERTYCONTAINER_HPP
+#define BURGWAR_CORELIB_ENTITYPROPERTYCONTAINER_HPP
+
+#include <CoreLib/EntityProperties.hpp>
+#include <bitset>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace bw
+{
+	// Index-addressed property storage, values block is shared (copy-on-write) with the element default values until modified
+	class EntityPropertyContainer
+	{
+		public:
+			using PropertyBlock = std::vector<std::optional<EntityProperty>>;
+
+			inline EntityPropertyContainer();
+			inline explicit EntityPropertyContainer(std::shared_ptr<PropertyBlock> defaultValues);
+			EntityPropertyContainer(const EntityPropertyContainer&) = default;
+			EntityPropertyContainer(EntityPropertyContainer&&) noexcept = default;
+			~EntityPropertyContainer() = default;
+
+			template<typename F> void ForEachOverriddenProperty(F&& func) const;
+
+			inline const EntityProperty* GetProperty(std::size_t propertyIndex) const;
+			inline std::size_t GetPropertyCount() const;
+
+			inline bool IsOverridden(std::size_t propertyIndex) const;
+
+			inline void SetProperty(std::size_t propertyIndex, EntityProperty value);
+
+			EntityPropertyContainer& operator=(const EntityPropertyContainer&) = default;
+			EntityPropertyContainer& operator=(EntityPropertyContainer&&) noexcept = default;
+
+		private:
+			inline void EnsureUniqueBlock();
+
+			std::bitset<MaxPropertyCount> m_overriddenProperties;
+			std::shared_ptr<PropertyBlock> m_values;
+	};
+}
+
+#include <CoreLib/EntityPropertyContainer.inl>
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/EntityPropertyContainer.hpp>
+#include <cassert>
+
+namespace bw
+{
+	inline EntityPropertyContainer::EntityPropertyContainer() :
+	m_values(std::make_shared<PropertyBlock>())
+	{
+	}
+
+	inline EntityPropertyContainer::EntityPropertyContainer(std::shared_ptr<PropertyBlock> defaultValues) :
+	m_values(std::move(defaultValues))
+	{
+		assert(m_values);
+		assert(m_values->size() <= MaxPropertyCount);
+	}
+
+	template<typename F>
+	void EntityPropertyContainer::ForEachOverriddenProperty(F&& func) const
+	{
+		if (m_overriddenProperties.none())
+			return;
+
+		std::size_t propertyCount = m_values->size();
+		for (std::size_t i = 0; i < propertyCount; ++i)
+		{
+			if (m_overriddenProperties.test(i))
+			{
+				assert((*m_values)[i].has_value());
+				func(i, *(*m_values)[i]);
+			}
+		}
+	}
+
+	inline const EntityProperty* EntityPropertyContainer::GetProperty(std::size_t propertyIndex) const
+	{
+		if (propertyIndex >= m_values->size())
+			return nullptr;
+
+		const auto& value = (*m_values)[propertyIndex];
+		if (!value)
+			return nullptr;
+
+		return &value.value();
+	}
+
+	inline std::size_t EntityPropertyContainer::GetPropertyCount() const
+	{
+		return m_values->size();
+	}
+
+	inline bool EntityPropertyContainer::IsOverridden(std::size_t propertyIndex) const
+	{
+		assert(propertyIndex < MaxPropertyCount);
+		return m_overriddenProperties.test(propertyIndex);
+	}
+
+	inline void EntityPropertyContainer::SetProperty(std::size_t propertyIndex, EntityProperty value)
+	{
+		assert(propertyIndex < MaxPropertyCount);
+
+		EnsureUniqueBlock();
+
+		if (propertyIndex >= m_values->size())
+			m_values->resize(propertyIndex + 1);
+
+		(*m_values)[propertyIndex] = std::move(value);
+		m_overriddenProperties.set(propertyIndex);
+	}
+
+	inline void EntityPropertyContainer::EnsureUniqueBlock()
+	{
+		// Values are shared with the element (or another container), copy them before writing
+		if (m_values.use_count() > 1)
+			m_values = std::make_shared<PropertyBlock>(*m_values);
+	}
+}
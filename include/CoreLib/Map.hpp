@@ -9,6 +9,8 @@
 
 #include <CoreLib/EntityProperties.hpp>
 #include <CoreLib/LayerIndex.hpp>
+#include <Nazara/Core/Bitset.hpp>
+#include <Nazara/Core/ByteStream.hpp>
 #include <Nazara/Core/Color.hpp>
 #include <Nazara/Math/Angle.hpp>
 #include <Nazara/Math/Vector2.hpp>
@@ -16,6 +18,7 @@
 #include <Thirdparty/tsl/hopscotch_map.h>
 #include <array>
 #include <filesystem>
+#include <memory>
 #include <vector>
 
 namespace bw
@@ -60,6 +63,8 @@ namespace bw
 			inline Layer& GetLayer(std::size_t layerIndex);
 			inline const Layer& GetLayer(std::size_t layerIndex) const;
 			inline std::size_t GetLayerCount() const;
+			inline const Layer& GetLayerHeader(std::size_t layerIndex) const; //< doesn't decode layer entities, they may be missing
+			std::vector<Nz::Int64> GetLayerUniqueIds(std::size_t layerIndex) const; //< doesn't decode layer entities
 			inline const MapInfo& GetMapInfo() const;
 
 			inline bool IsValid() const;
@@ -97,13 +102,22 @@ namespace bw
 			static inline Map LoadFromFolder(const std::filesystem::path& mapFolder);
 
 		private:
+			struct BinaryData;
+
+			inline void EnsureLayerLoaded(std::size_t layerIndex) const;
+			void LoadAllLayers() const;
 			void LoadFromBinaryInternal(const std::filesystem::path& mapFile);
+			void LoadFromBinaryV0(Nz::ByteStream& stream);
+			void LoadFromBinaryV1(std::vector<Nz::UInt8> content);
 			void LoadFromTextInternal(const std::filesystem::path& mapFolder);
+			void LoadLayer(std::size_t layerIndex) const;
 			void Sanitize();
 			void SetupDefault();
 
+			mutable std::shared_ptr<const BinaryData> m_binaryData; //< v1 binary content, kept until every layer has been decoded
 			std::vector<Asset> m_assets;
-			std::vector<Layer> m_layers;
+			mutable std::vector<Layer> m_layers; //< layers are decoded on first access when loaded from a v1 binary map
+			mutable Nz::Bitset<Nz::UInt64> m_pendingLayers;
 			Nz::Int64 m_freeUniqueId;
 			MapInfo m_mapInfo;
 			bool m_isValid;
@@ -24,8 +24,7 @@ namespace bw
 	auto Map::AddEntity(std::size_t layerIndex, Args&&... args) -> Entity&
 	{
 		assert(IsValid());
-		assert(layerIndex < m_layers.size());
-		auto& layer = m_layers[layerIndex];
+		auto& layer = GetLayer(layerIndex);
 		auto& newEntity = layer.entities.emplace_back(std::forward<Args>(args)...);
 		newEntity.uniqueId = m_freeUniqueId++;
 
@@ -35,6 +34,8 @@ namespace bw
 	template<typename... Args> 
 	auto Map::AddLayer(Args&&... args) -> Layer&
 	{
+		LoadAllLayers();
+
 		Layer& layer = m_layers.emplace_back(std::forward<Args>(args)...);
 		for (auto& entity : layer.entities)
 			entity.uniqueId = m_freeUniqueId++;
@@ -44,6 +45,8 @@ namespace bw
 
 	inline auto Map::DropLayer(std::size_t layerIndex) -> Layer
 	{
+		LoadAllLayers();
+
 		Layer layer = std::move(GetLayer(layerIndex));
 		m_layers.erase(m_layers.begin() + layerIndex);
 		//TODO: Should the map fix entity properties?
@@ -64,6 +67,8 @@ namespace bw
 	template<typename... Args> 
 	auto Map::EmplaceLayer(std::size_t index, Args&&... args) -> Layer&
 	{
+		LoadAllLayers();
+
 		Layer& layer = *m_layers.emplace(m_layers.begin() + index, std::forward<Args>(args)...);
 		for (auto& entity : layer.entities)
 			entity.uniqueId = m_freeUniqueId++;
@@ -74,6 +79,8 @@ namespace bw
 	template<typename F>
 	void Map::ForeachEntity(F&& func)
 	{
+		LoadAllLayers();
+
 		for (auto& layer : m_layers)
 		{
 			for (auto& entity : layer.entities)
@@ -119,12 +126,16 @@ namespace bw
 	inline auto Map::GetLayer(std::size_t layerIndex) -> Layer&
 	{
 		assert(layerIndex < m_layers.size());
+		EnsureLayerLoaded(layerIndex);
+
 		return m_layers[layerIndex];
 	}
 
 	inline auto Map::GetLayer(std::size_t layerIndex) const -> const Layer&
 	{
 		assert(layerIndex < m_layers.size());
+		EnsureLayerLoaded(layerIndex);
+
 		return m_layers[layerIndex];
 	}
 
@@ -133,6 +144,12 @@ namespace bw
 		return m_layers.size();
 	}
 
+	inline auto Map::GetLayerHeader(std::size_t layerIndex) const -> const Layer&
+	{
+		assert(layerIndex < m_layers.size());
+		return m_layers[layerIndex];
+	}
+
 	inline const MapInfo& Map::GetMapInfo() const
 	{
 		return m_mapInfo;
@@ -154,6 +171,12 @@ namespace bw
 		return targetLayer.entities.back();
 	}
 
+	inline void Map::EnsureLayerLoaded(std::size_t layerIndex) const
+	{
+		if (layerIndex < m_pendingLayers.GetSize() && m_pendingLayers.Test(layerIndex))
+			LoadLayer(layerIndex);
+	}
+
 	inline Map Map::LoadFromBinary(const std::filesystem::path& mapFile)
 	{
 		Map map;
@@ -21,7 +21,10 @@
 #include <CoreLib/Scripting/ScriptingContext.hpp>
 #include <CoreLib/Scripting/ServerEntityStore.hpp>
 #include <CoreLib/Scripting/ServerWeaponStore.hpp>
+#include <CoreLib/Utility/FileWatcher.hpp>
 #include <Thirdparty/tsl/hopscotch_map.h>
+#include <functional>
+#include <future>
 #include <memory>
 #include <optional>
 #include <string>
@@ -33,6 +36,7 @@ namespace bw
 	class Player;
 	class ServerGamemode;
 	class ServerScriptingLibrary;
+	struct ServerStatus;
 	class Terrain;
 
 	using PlayerHandle = Nz::ObjectHandle<Player>;
@@ -52,6 +56,8 @@ namespace bw
 			struct Asset;
 			struct ClientScript;
 
+			using EntityMigrationCallback = std::function<void(const Ndk::EntityHandle& oldEntity, const Ndk::EntityHandle& newEntity, LayerIndex previousLayerIndex)>;
+
 			Match(BurgApp& app, std::string matchName, std::filesystem::path gamemodeFolder, Map map, std::size_t maxPlayerCount, float tickDuration);
 			Match(const Match&) = delete;
 			Match(Match&&) = delete;
@@ -63,9 +69,14 @@ namespace bw
 
 			template<typename T> void BuildClientAssetListPacket(T& clientAsset) const;
 			template<typename T> void BuildClientScriptListPacket(T& clientScript) const;
+			void BuildStatus(ServerStatus& status) const;
+
+			void ChangeMap(std::filesystem::path mapFile);
 
 			Player* CreatePlayer(MatchClientSession& session, Nz::UInt8 localIndex, std::string name);
 
+			void FlushNetworkStrings();
+
 			void ForEachEntity(std::function<void(const Ndk::EntityHandle& entity)> func) override;
 			template<typename F> void ForEachPlayer(F&& func);
 
@@ -80,7 +91,11 @@ namespace bw
 			const TerrainLayer& GetLayer(LayerIndex layerIndex) const override;
 			LayerIndex GetLayerCount() const override;
 			inline sol::state& GetLuaState();
+			inline Nz::UInt32 GetMapRevision() const;
+			const std::shared_ptr<ScriptingContext>& GetScriptingContext() const override;
 			inline const Packets::MatchData& GetMatchData() const;
+			const std::shared_ptr<const Nz::ByteArray>& GetSerializedMatchData();
+			const std::shared_ptr<const Nz::ByteArray>& GetSerializedNetworkStrings();
 			const NetworkStringStore& GetNetworkStringStore() const override;
 			inline MatchSessions& GetSessions();
 			inline const MatchSessions& GetSessions() const;
@@ -92,6 +107,8 @@ namespace bw
 
 			void InitDebugGhosts();
 
+			void MoveEntityToLayer(const Ndk::EntityHandle& entity, LayerIndex layerIndex, EntityMigrationCallback callback = nullptr);
+
 			void RegisterAsset(const std::filesystem::path& assetPath);
 			void RegisterAsset(std::string assetPath, Nz::UInt64 assetSize, Nz::ByteArray assetChecksum);
 			void RegisterClientScript(const std::filesystem::path& clientScript);
@@ -104,8 +121,11 @@ namespace bw
 			void RemovePlayer(Player* player, DisconnectionReason disconnection);
 
 			const Ndk::EntityHandle& RetrieveEntityByUniqueId(Nz::Int64 uniqueId) const override;
+			const Ndk::EntityHandle& RetrieveLoadedEntityByUniqueId(Nz::Int64 uniqueId) const; //< doesn't load the entity layer, safe to call while building packets
 			Nz::Int64 RetrieveUniqueIdByEntity(const Ndk::EntityHandle& entity) const override;
 
+			void UnregisterEntity(Nz::Int64 uniqueId);
+
 			void Update(float elapsedTime);
 
 			Match& operator=(const Match&) = delete;
@@ -125,10 +145,21 @@ namespace bw
 			};
 
 		private:
+			void ApplyMapChange(Map map);
+			void BroadcastClientScriptChanges(const tsl::hopscotch_map<std::string, Nz::ByteArray>& previousChecksums);
+			void BuildMapChangePacket(Packets::MapChange& mapChange) const;
 			void BuildMatchData();
 			void OnPlayerReady(Player* player);
 			void OnTick(bool lastTick) override;
+			void ProcessLayerChanges();
+			void ReloadScriptElement(const std::filesystem::path& elementPath);
+			void RetrieveClientScriptChecksums(tsl::hopscotch_map<std::string, Nz::ByteArray>& checksums) const;
 			void SendPingUpdate();
+			void SendPlayerList(MatchClientSession& session);
+			void UpdateScriptWatcher(Nz::UInt64 appTime);
+
+			static constexpr std::size_t ParallelPacketBuildingThreshold = 4;
+			static constexpr Nz::UInt64 ScriptReloadDelay = 200; //< ms without file events before reloading
 
 			struct Debug
 			{
@@ -143,17 +174,32 @@ namespace bw
 				NazaraSlot(Ndk::Entity, OnEntityDestruction, onDestruction);
 			};
 
+			struct PendingLayerChange
+			{
+				Ndk::EntityHandle entity;
+				EntityMigrationCallback callback;
+				LayerIndex layerIndex;
+			};
+
 			std::filesystem::path m_gamemodePath;
 			std::optional<AssetStore> m_assetStore;
 			std::optional<Debug> m_debug;
 			std::optional<ServerEntityStore> m_entityStore;
+			std::optional<FileWatcher> m_scriptWatcher;
+			std::optional<std::future<Map>> m_nextMap;
 			std::optional<ServerWeaponStore> m_weaponStore;
 			std::size_t m_maxPlayerCount;
 			std::shared_ptr<ServerGamemode> m_gamemode;
 			std::shared_ptr<ScriptingContext> m_scriptingContext;
 			std::shared_ptr<ServerScriptingLibrary> m_scriptingLibrary;
+			std::shared_ptr<const Nz::ByteArray> m_serializedMatchData;
+			std::shared_ptr<const Nz::ByteArray> m_serializedNetworkStrings;
 			std::string m_name;
 			std::unique_ptr<Terrain> m_terrain;
+			std::vector<std::filesystem::path> m_changedScripts;
+			std::vector<std::filesystem::path> m_pendingElementReloads;
+			std::vector<PendingLayerChange> m_pendingLayerChanges;
+			std::vector<MatchClientSession*> m_packetBuildingSessions;
 			std::vector<std::unique_ptr<Player>> m_players;
 			mutable Packets::MatchData m_matchData;
 			tsl::hopscotch_map<std::string, Asset> m_assets;
@@ -161,11 +207,16 @@ namespace bw
 			tsl::hopscotch_map<Nz::Int64, Entity> m_entitiesByUniqueId;
 			Nz::Bitset<> m_freePlayerId;
 			Nz::Int64 m_nextUniqueId;
+			Nz::UInt32 m_flushedNetworkStringCount;
+			Nz::UInt32 m_mapRevision;
+			Nz::UInt32 m_serializedNetworkStringCount;
 			Nz::UInt64 m_lastPingUpdate;
+			Nz::UInt64 m_lastScriptChange;
 			BurgApp& m_app;
 			Map m_map;
 			MatchSessions m_sessions;
 			NetworkStringStore m_networkStringStore;
+			bool m_pendingFullScriptReload;
 	};
 }
 
@@ -94,6 +94,11 @@ namespace bw
 		return m_scriptingContext->GetLuaState();
 	}
 
+	inline Nz::UInt32 Match::GetMapRevision() const
+	{
+		return m_mapRevision;
+	}
+
 	inline const Packets::MatchData& Match::GetMatchData() const
 	{
 		m_matchData.currentTick = GetNetworkTick();
@@ -12,7 +12,9 @@
 #include <CoreLib/PlayerCommandStore.hpp>
 #include <CoreLib/SessionBridge.hpp>
 #include <CoreLib/Protocol/Packets.hpp>
+#include <CoreLib/Utility/TokenBucket.hpp>
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace bw
@@ -31,15 +33,20 @@ namespace bw
 		friend PlayerCommandStore;
 
 		public:
+			struct IncomingPacketStatistics;
+
 			MatchClientSession(Match& match, std::size_t sessionId, PlayerCommandStore& commandStore, std::shared_ptr<SessionBridge> bridge);
 			MatchClientSession(const MatchClientSession&) = delete;
 			MatchClientSession(MatchClientSession&&) = delete;
 			~MatchClientSession();
 
+			void BuildPackets();
+
 			void Disconnect();
 
 			template<typename F> void ForEachPlayer(F&& func);
 
+			inline const IncomingPacketStatistics& GetIncomingPacketStatistics() const;
 			inline Nz::UInt32 GetPing() const;
 			inline std::size_t GetSessionId() const;
 			inline MatchClientVisibility& GetVisibility();
@@ -47,6 +54,12 @@ namespace bw
 
 			void HandleIncomingPacket(Nz::NetPacket& packet);
 
+			void NotifyMapChange(const Packets::MapChange& mapChange);
+
+			template<typename T> void QueuePacket(const T& packet);
+
+			void ResetVisibility();
+
 			template<typename T> void SendPacket(const T& packet);
 
 			void Update(float elapsedTime);
@@ -54,7 +67,16 @@ namespace bw
 			MatchClientSession& operator=(const MatchClientSession&) = delete;
 			MatchClientSession& operator=(MatchClientSession&&) = delete;
 
+			struct IncomingPacketStatistics
+			{
+				Nz::UInt32 droppedPackets = 0;
+				Nz::UInt32 receivedPackets = 0;
+				std::vector<Nz::UInt32> droppedPacketsByOpcode;
+			};
+
 		private:
+			bool ConsumePacketBudget(Nz::UInt8 opcode, const PlayerCommandStore::IncomingCommand& command);
+			void FlushPackets();
 			void HandleIncomingPacket(const Packets::Auth& packet);
 			void HandleIncomingPacket(const Packets::DownloadClientScriptRequest& packet);
 			void HandleIncomingPacket(Packets::PlayerChat&& packet);
@@ -64,16 +86,31 @@ namespace bw
 			void HandleIncomingPacket(const Packets::Ready& packet);
 			void HandleIncomingPacket(const Packets::ScriptPacket& packet);
 			void HandleIncomingPacket(Packets::UpdatePlayerName&& packet);
+			template<typename T, typename... Args> void SendSerializedPacket(const Nz::ByteArray& payload, const Args&... prefix);
 			void UpdatePeerInfo(const SessionBridge::SessionInfo& sessionInfo);
 
+			struct QueuedPacket
+			{
+				Nz::ENetPacketFlags flags;
+				Nz::NetPacket data;
+				Nz::UInt8 channelId;
+			};
+
 			Match& m_match;
 			PlayerCommandStore& m_commandStore;
 			std::size_t m_sessionId;
 			std::shared_ptr<SessionBridge> m_bridge;
+			std::optional<TokenBucket> m_packetDropBudget;
 			std::unique_ptr<MatchClientVisibility> m_visibility;
+			std::vector<std::optional<TokenBucket>> m_packetBudgets;
 			std::vector<PlayerHandle> m_players;
+			std::vector<QueuedPacket> m_queuedPackets;
+			IncomingPacketStatistics m_incomingPacketStatistics;
 			Nz::UInt32 m_ping;
+			Nz::UInt32 m_mapRevision; //< revision of the map the client has been sent
 			float m_peerInfoUpdateCounter;
+			bool m_isKicked;
+			bool m_isLoadingMap;
 	};
 }
 
@@ -17,6 +17,11 @@ namespace bw
 		}
 	}
 
+	inline auto MatchClientSession::GetIncomingPacketStatistics() const -> const IncomingPacketStatistics&
+	{
+		return m_incomingPacketStatistics;
+	}
+
 	inline Nz::UInt32 MatchClientSession::GetPing() const
 	{
 		return m_ping;
@@ -37,6 +42,18 @@ namespace bw
 		return *m_visibility;
 	}
 
+	template<typename T>
+	void MatchClientSession::QueuePacket(const T& packet)
+	{
+		const auto& command = m_commandStore.GetOutgoingCommand<T>();
+
+		QueuedPacket& queuedPacket = m_queuedPackets.emplace_back();
+		queuedPacket.channelId = command.channelId;
+		queuedPacket.flags = command.flags;
+
+		m_commandStore.SerializePacket(queuedPacket.data, packet);
+	}
+
 	template<typename T>
 	void MatchClientSession::SendPacket(const T& packet)
 	{
@@ -46,4 +63,16 @@ namespace bw
 		const auto& command = m_commandStore.GetOutgoingCommand<T>();
 		m_bridge->SendPacket(command.channelId, command.flags, std::move(data));
 	}
+
+	template<typename T, typename... Args>
+	void MatchClientSession::SendSerializedPacket(const Nz::ByteArray& payload, const Args&... prefix)
+	{
+		Nz::NetPacket data;
+		data << static_cast<Nz::UInt8>(T::Type);
+		(data << ... << prefix);
+		data.Write(payload.GetConstBuffer(), payload.GetSize());
+
+		const auto& command = m_commandStore.GetOutgoingCommand<T>();
+		m_bridge->SendPacket(command.channelId, command.flags, std::move(data));
+	}
 }
@@ -31,9 +31,11 @@ namespace bw
 		Destruction,
 		HealthUpdate,
 		InputUpdate,
+		LayerChange,
 		PlayAnimation,
+		PropertyUpdate,
 
-		Max = PlayAnimation
+		Max = PropertyUpdate
 	};
 }
 
@@ -56,8 +58,12 @@ namespace bw
 			inline MatchClientVisibility(Match& match, MatchClientSession& session);
 			~MatchClientVisibility() = default;
 
+			void BuildPackets();
+
 			inline void ClearLayers();
 
+			inline std::size_t GetLayerCacheSize() const;
+
 			inline void HideLayer(LayerIndex layerIndex);
 
 			inline bool IsLayerVisible(LayerIndex layerIndex) const;
@@ -67,21 +73,38 @@ namespace bw
 			inline void PushLayerUpdate(Nz::UInt8 localPlayerIndex, LayerIndex layerIndex);
 
 			inline void SetEntityControlledStatus(LayerIndex layerIndex, Nz::UInt32 entityId, bool isControlled);
+			inline void SetLayerCacheSize(std::size_t entityCount);
 
 			void ShowLayer(LayerIndex layerIndex);
 
 			void Update();
 
 		private:
+			struct CachedLayer;
+			struct Layer;
+
 			void BuildMovementPacket(Packets::MatchState::Entity& packetData, const NetworkSyncSystem::EntityMovement& eventData);
 			void FillEntityData(const NetworkSyncSystem::EntityCreation& creationEvent, Packets::Helper::EntityData& entityData);
+			static void FillPropertyValue(const EntityProperty& property, Packets::Helper::Properties::PropertyValue& value, bool& isArray);
 			void HandleEntityCreation(LayerIndex layerIndex, const NetworkSyncSystem::EntityCreation& eventData);
 			void HandleEntityRemove(LayerIndex layerIndex, Ndk::EntityId entityId, bool deathEvent);
+			void PrepareLayerCache(LayerIndex layerIndex, const Layer& layer);
+			void ResolveLayerChanges();
 			void SendMatchState();
+			std::shared_ptr<const Nz::ByteArray> SerializeEntityData(const NetworkSyncSystem::EntityCreation& creationEvent);
+			bool StoreLayerCache(LayerIndex layerIndex, CachedLayer&& cachedLayer, Nz::UInt16 networkTick);
 
 			using EntityPacketSendFunction = std::function<void()>;
 			using PendingCreationEventMap = tsl::hopscotch_map<Nz::UInt64 /*entityId*/, std::optional<NetworkSyncSystem::EntityCreation>>;
 
+			struct CachedLayer
+			{
+				Nz::Bitset<Nz::UInt64> entities; //< held by the client, as they were at revision
+				Nz::UInt64 revision;
+				Nz::UInt64 storeOrder = 0;
+				std::size_t entityCount = 0;
+			};
+
 			struct PendingLayerUpdate
 			{
 				Nz::UInt8 localPlayerIndex;
@@ -99,22 +122,26 @@ namespace bw
 			{
 				Nz::Bitset<Nz::UInt64> visibleEntities;
 				std::size_t visibilityCounter = 1;
+				Nz::UInt64 clientRevision = 0; //< client is up to date with the sync system up to this revision
 
 				PendingCreationEventMap creationEvents;
 				tsl::hopscotch_map<Nz::UInt32 /*entityId*/, NetworkSyncSystem::EntityInputs> inputUpdateEvents;
 				tsl::hopscotch_map<Nz::UInt32 /*entityId*/, NetworkSyncSystem::EntityHealth> healthUpdateEvents;
 				tsl::hopscotch_map<Nz::UInt32 /*entityId*/, NetworkSyncSystem::EntityMovement> staticMovementUpdateEvents;
 				tsl::hopscotch_map<Nz::UInt32 /*entityId*/, NetworkSyncSystem::EntityPlayAnimation> playAnimationEvents;
+				tsl::hopscotch_map<Nz::UInt32 /*entityId*/, NetworkSyncSystem::EntityPropertyUpdate> propertyUpdateEvents;
 				tsl::hopscotch_set<Nz::UInt32 /*entityId*/> deathEvents;
 				tsl::hopscotch_set<Nz::UInt32 /*entityId*/> destructionEvents;
-
-				NazaraSlot(NetworkSyncSystem, OnEntityCreated,        onEntityCreatedSlot);
-				NazaraSlot(NetworkSyncSystem, OnEntityDeath,          onEntityDeath);
-				NazaraSlot(NetworkSyncSystem, OnEntityDeleted,        onEntityDeletedSlot);
-				NazaraSlot(NetworkSyncSystem, OnEntityInvalidated,    onEntityInvalidated);
-				NazaraSlot(NetworkSyncSystem, OnEntityPlayAnimation,  onEntityPlayAnimation);
-				NazaraSlot(NetworkSyncSystem, OnEntitiesHealthUpdate, onEntitiesHealthUpdate);
-				NazaraSlot(NetworkSyncSystem, OnEntitiesInputUpdate,  onEntitiesInputUpdate);
+				tsl::hopscotch_set<Nz::UInt32 /*entityId*/> layerChangeCandidates; //< destroyed entities the client holds an up-to-date version of
+
+				NazaraSlot(NetworkSyncSystem, OnEntityCreated,          onEntityCreatedSlot);
+				NazaraSlot(NetworkSyncSystem, OnEntityDeath,            onEntityDeath);
+				NazaraSlot(NetworkSyncSystem, OnEntityDeleted,          onEntityDeletedSlot);
+				NazaraSlot(NetworkSyncSystem, OnEntityInvalidated,      onEntityInvalidated);
+				NazaraSlot(NetworkSyncSystem, OnEntityPlayAnimation,    onEntityPlayAnimation);
+				NazaraSlot(NetworkSyncSystem, OnEntitiesHealthUpdate,   onEntitiesHealthUpdate);
+				NazaraSlot(NetworkSyncSystem, OnEntitiesInputUpdate,    onEntitiesInputUpdate);
+				NazaraSlot(NetworkSyncSystem, OnEntitiesPropertyUpdate, onEntitiesPropertyUpdate);
 			};
 
 			Nz::Bitset<Nz::UInt64> m_tempBitset; //< For optimization purpose
@@ -122,21 +149,28 @@ namespace bw
 			Nz::Bitset<Nz::UInt64> m_newlyVisibleLayers;
 			Nz::Bitset<Nz::UInt64> m_clientVisibleLayers;
 			Nz::Flags<VisibilityEventType> m_pendingEvents;
+			tsl::hopscotch_map<LayerIndex /*layerId*/, CachedLayer> m_cachedLayers; //< disabled layers kept by the client
+			tsl::hopscotch_map<LayerIndex /*layerId*/, CachedLayer> m_hiddenLayerCaches; //< waiting for their DisableLayer packet
 			tsl::hopscotch_map<LayerIndex /*layerId*/, std::unique_ptr<Layer>> m_layers;
 			tsl::hopscotch_map<Nz::UInt64 /*layerId|entityId*/, std::vector<EntityPacketSendFunction>> m_pendingEntitiesEvent;
 			tsl::hopscotch_set<Nz::UInt64 /*layerId|entityId*/> m_controlledEntities;
 			std::vector<PendingLayerUpdate> m_pendingLayerUpdates;
 			std::vector<PendingMultipleEntities> m_multiplePendingEntitiesEvent;
+			std::size_t m_cachedEntityCount;
+			std::size_t m_layerCacheSize;
 			Match& m_match;
 			MatchClientSession& m_session;
-
-			Packets::CreateEntities    m_createEntitiesPacket;
-			Packets::DeleteEntities    m_deleteEntitiesPacket;
-			Packets::HealthUpdate      m_healthUpdatePacket;
-			Packets::EntitiesAnimation m_entitiesAnimationPacket;
-			Packets::EntitiesDeath     m_entitiesDeathPacket;
-			Packets::EntitiesInputs    m_inputUpdatePacket;
-			Packets::MatchState        m_matchStatePacket;
+			Nz::UInt64 m_nextCacheStoreOrder;
+
+			Packets::CreateEntities         m_createEntitiesPacket;
+			Packets::DeleteEntities         m_deleteEntitiesPacket;
+			Packets::HealthUpdate           m_healthUpdatePacket;
+			Packets::EntitiesAnimation      m_entitiesAnimationPacket;
+			Packets::EntitiesDeath          m_entitiesDeathPacket;
+			Packets::EntitiesInputs         m_inputUpdatePacket;
+			Packets::EntitiesLayerChange    m_entitiesLayerChangePacket;
+			Packets::EntitiesPropertyUpdate m_propertyUpdatePacket;
+			Packets::MatchState             m_matchStatePacket;
 	};
 }
 
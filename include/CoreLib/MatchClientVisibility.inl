@@ -25,8 +25,11 @@ namespace bw
 	}
 
 	inline MatchClientVisibility::MatchClientVisibility(Match& match, MatchClientSession& session) :
+	m_cachedEntityCount(0),
+	m_layerCacheSize(0),
 	m_match(match),
-	m_session(session)
+	m_session(session),
+	m_nextCacheStoreOrder(0)
 	{
 	}
 
@@ -37,12 +40,20 @@ namespace bw
 			m_newlyVisibleLayers.UnboundedReset(layerIndex);
 
 			if (m_clientVisibleLayers.UnboundedTest(layerIndex))
+			{
+				PrepareLayerCache(layerIndex, *layer);
 				m_newlyHiddenLayers.UnboundedSet(layerIndex);
+			}
 		}
 
 		m_layers.clear();
 	}
 
+	inline std::size_t MatchClientVisibility::GetLayerCacheSize() const
+	{
+		return m_layerCacheSize;
+	}
+
 	inline void MatchClientVisibility::HideLayer(LayerIndex layerIndex)
 	{
 		auto it = m_layers.find(layerIndex);
@@ -54,7 +65,10 @@ namespace bw
 		m_newlyVisibleLayers.UnboundedReset(layerIndex);
 
 		if (m_clientVisibleLayers.UnboundedTest(layerIndex))
+		{
+			PrepareLayerCache(layerIndex, layer);
 			m_newlyHiddenLayers.UnboundedSet(layerIndex);
+		}
 
 		m_layers.erase(it);
 	}
@@ -78,6 +92,11 @@ namespace bw
 			m_controlledEntities.erase(entityKey);
 	}
 
+	inline void MatchClientVisibility::SetLayerCacheSize(std::size_t entityCount)
+	{
+		m_layerCacheSize = entityCount;
+	}
+
 	template<typename T>
 	void MatchClientVisibility::PushEntityPacket(LayerIndex layerIndex, Nz::UInt32 entityId, T&& packet)
 	{
@@ -0,0 +1,119 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_NETWORKCONDITIONSIMULATOR_HPP
+#define BURGWAR_CORELIB_NETWORKCONDITIONSIMULATOR_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Network/Enums.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+#include <random>
+#include <vector>
+
+namespace bw
+{
+	class ConfigFile;
+
+	enum class JitterDistribution
+	{
+		Normal,
+		Uniform
+	};
+
+	struct NetworkConditions
+	{
+		JitterDistribution jitterDistribution = JitterDistribution::Uniform;
+		Nz::UInt32 bandwidth = 0; //< bytes per second, 0 means unlimited
+		Nz::UInt32 jitter = 0;    //< milliseconds
+		Nz::UInt32 latency = 0;   //< milliseconds, one-way
+		float duplicationChance = 0.f;
+		float lossBurstLength = 1.f; //< average count of consecutive packets lost once a loss occurs
+		float lossChance = 0.f;
+		float reorderChance = 0.f;
+
+		inline bool IsPerfect() const;
+
+		static NetworkConditions FromConfig(const ConfigFile& config);
+	};
+
+	// Delays, drops, duplicates and reorders packets of one direction of a link, honoring ENet channel/reliability semantics:
+	// reliable packets are never lost (losses turn into retransmission delays) and stay ordered on their channel,
+	// sequenced packets older than the last delivered one of their channel are discarded, unsequenced packets are left as-is
+	class NetworkConditionSimulator
+	{
+		public:
+			struct Statistics;
+
+			NetworkConditionSimulator(const NetworkConditions& conditions);
+			NetworkConditionSimulator(const NetworkConditionSimulator&) = delete;
+			NetworkConditionSimulator(NetworkConditionSimulator&&) = default;
+			~NetworkConditionSimulator() = default;
+
+			inline const NetworkConditions& GetConditions() const;
+			inline const Statistics& GetStatistics() const;
+
+			inline bool HasPendingPackets() const;
+
+			template<typename F> void Poll(Nz::UInt64 now, F&& callback);
+
+			void Push(Nz::UInt64 now, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet);
+
+			inline void UpdateConditions(const NetworkConditions& conditions);
+
+			NetworkConditionSimulator& operator=(const NetworkConditionSimulator&) = delete;
+			NetworkConditionSimulator& operator=(NetworkConditionSimulator&&) = default;
+
+			struct Statistics
+			{
+				Nz::UInt32 droppedPackets = 0;
+				Nz::UInt32 duplicatedPackets = 0;
+				Nz::UInt32 reorderedPackets = 0;
+				Nz::UInt32 retransmittedPackets = 0;
+				Nz::UInt32 stalePackets = 0;
+			};
+
+			static constexpr Nz::UInt64 MinRetransmissionDelay = 50'000;
+
+		private:
+			struct ChannelState
+			{
+				Nz::UInt64 lastReliableDeliveryTime = 0;
+				Nz::UInt32 lastDeliveredSequence = 0;
+				Nz::UInt32 nextSequence = 1;
+			};
+
+			struct PendingPacket
+			{
+				Nz::ENetPacketFlags flags;
+				Nz::NetPacket packet;
+				Nz::UInt8 channelId;
+				Nz::UInt32 sequence;
+				Nz::UInt64 deliveryTime;
+				Nz::UInt64 order;
+			};
+
+			Nz::UInt64 ComputeTransitDelay();
+			ChannelState& GetChannel(Nz::UInt8 channelId);
+			void Schedule(Nz::UInt64 deliveryTime, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::UInt32 sequence, Nz::NetPacket&& packet);
+			bool ShouldLosePacket();
+
+			static bool ComparePendingPackets(const PendingPacket& lhs, const PendingPacket& rhs);
+			static Nz::NetPacket DuplicatePacket(const Nz::NetPacket& packet);
+
+			std::minstd_rand m_randomGenerator;
+			std::vector<ChannelState> m_channels;
+			std::vector<PendingPacket> m_pendingPackets; //< min-heap on delivery time
+			NetworkConditions m_conditions;
+			Statistics m_statistics;
+			Nz::UInt64 m_linkAvailableTime;
+			Nz::UInt64 m_nextOrder;
+			bool m_isInLossBurst;
+	};
+}
+
+#include <CoreLib/NetworkConditionSimulator.inl>
+
+#endif
@@ -0,0 +1,61 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/NetworkConditionSimulator.hpp>
+#include <algorithm>
+
+namespace bw
+{
+	inline bool NetworkConditions::IsPerfect() const
+	{
+		return bandwidth == 0 && jitter == 0 && latency == 0 && duplicationChance <= 0.f && lossChance <= 0.f && reorderChance <= 0.f;
+	}
+
+	inline const NetworkConditions& NetworkConditionSimulator::GetConditions() const
+	{
+		return m_conditions;
+	}
+
+	inline auto NetworkConditionSimulator::GetStatistics() const -> const Statistics&
+	{
+		return m_statistics;
+	}
+
+	inline bool NetworkConditionSimulator::HasPendingPackets() const
+	{
+		return !m_pendingPackets.empty();
+	}
+
+	template<typename F>
+	void NetworkConditionSimulator::Poll(Nz::UInt64 now, F&& callback)
+	{
+		while (!m_pendingPackets.empty() && m_pendingPackets.front().deliveryTime <= now)
+		{
+			std::pop_heap(m_pendingPackets.begin(), m_pendingPackets.end(), &NetworkConditionSimulator::ComparePendingPackets);
+			PendingPacket pendingPacket = std::move(m_pendingPackets.back());
+			m_pendingPackets.pop_back();
+
+			if (!(pendingPacket.flags & Nz::ENetPacketFlag_Reliable) && !(pendingPacket.flags & Nz::ENetPacketFlag_Unsequenced))
+			{
+				// Sequenced packets arriving after a more recent one are discarded by ENet
+				ChannelState& channel = GetChannel(pendingPacket.channelId);
+				if (pendingPacket.sequence <= channel.lastDeliveredSequence)
+				{
+					m_statistics.stalePackets++;
+					continue;
+				}
+
+				channel.lastDeliveredSequence = pendingPacket.sequence;
+			}
+
+			callback(pendingPacket.channelId, pendingPacket.flags, std::move(pendingPacket.packet));
+		}
+	}
+
+	inline void NetworkConditionSimulator::UpdateConditions(const NetworkConditions& conditions)
+	{
+		m_conditions = conditions;
+		m_isInLossBurst = false;
+	}
+}
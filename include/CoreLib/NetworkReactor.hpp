@@ -7,11 +7,17 @@
 #ifndef BURGWAR_CORELIB_NETWORK_REACTOR_HPP
 #define BURGWAR_CORELIB_NETWORK_REACTOR_HPP
 
+#include <CoreLib/NetworkConditionSimulator.hpp>
+#include <CoreLib/Utility/TokenBucket.hpp>
+#include <Nazara/Core/Bitset.hpp>
 #include <Nazara/Core/Thread.hpp>
 #include <Nazara/Network/ENetHost.hpp>
 #include <Thirdparty/concurrentqueue/concurrentqueue.h>
+#include <Thirdparty/tsl/hopscotch_map.h>
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <variant>
 #include <vector>
 
@@ -24,13 +30,17 @@ namespace bw
 		Normal  // Disconnect
 	};
 
+	class StatusQueryResponder;
+
 	class NetworkReactor
 	{
 		public:
+			struct ConnectionLimits;
+			struct ConnectionStatistics;
 			struct PeerInfo;
 			using PeerInfoCallback = std::function<void(PeerInfo& peerInfo)>;
 
-			NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient);
+			NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient, std::size_t pendingSlotCount = 0);
 			NetworkReactor(const NetworkReactor&) = delete;
 			NetworkReactor(NetworkReactor&&) = delete;
 			~NetworkReactor();
@@ -38,18 +48,48 @@ namespace bw
 			std::size_t ConnectTo(Nz::IpAddress address, Nz::UInt32 data = 0);
 			void DisconnectPeer(std::size_t peerId, Nz::UInt32 data = 0, DisconnectionType type = DisconnectionType::Normal);
 
-			template<typename ConnectCB, typename DisconnectCB, typename DataCB>
-			void Poll(ConnectCB&& onConnection, DisconnectCB&& onDisconnection, DataCB&& onData);
+			void EnableStatusQueries(std::shared_ptr<StatusQueryResponder> responder);
 
+			ConnectionStatistics GetConnectionStatistics() const;
 			inline Nz::NetProtocol GetProtocol() const;
 
+			template<typename ConnectCB, typename DisconnectCB, typename DataCB>
+			void Poll(ConnectCB&& onConnection, DisconnectCB&& onDisconnection, DataCB&& onData);
+
 			void QueryInfo(std::size_t peerId, PeerInfoCallback callback);
 
 			void SendData(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet);
 
+			void SetConnectionLimits(const ConnectionLimits& limits);
+
+			void SimulateNetworkConditions(const NetworkConditions& conditions);
+
 			NetworkReactor& operator=(const NetworkReactor&) = delete;
 			NetworkReactor& operator=(NetworkReactor&&) = delete;
 
+			// Incoming peers stay pending until they send their first packet, the owner only hears about them once they do
+			// The host has pendingSlotCount slots on top of maxClient, pending peers can't take the place of a client (peers over maxClient are refused when they send their first packet)
+			// Requests that never complete the ENet handshake (spoofed addresses) are still out of our reach: ENet allocates them a slot and only ENet can time them out,
+			// a flood big enough to fill every slot still blocks new players until then
+			struct ConnectionLimits
+			{
+				float addressBurst = 5.f;
+				float addressRate = 1.f; //< connections per second and per address, 0 means unlimited
+				std::size_t maxPendingConnections = 16;
+				std::size_t maxPendingConnectionsPerAddress = 2;
+				Nz::UInt64 pendingTimeout = 2000; //< ms, legitimate clients authenticate right after connecting
+			};
+
+			struct ConnectionStatistics
+			{
+				Nz::UInt64 abandonedConnections = 0; //< disconnected while pending
+				Nz::UInt64 acceptedConnections = 0;
+				Nz::UInt64 evictedConnections = 0;   //< dropped to make room for a newer one
+				Nz::UInt64 expiredConnections = 0;
+				Nz::UInt64 refusedConnections = 0;   //< over per-address limits or clients capacity
+				std::size_t pendingConnections = 0;
+			};
+
 			struct PeerInfo
 			{
 				Nz::UInt32 ping;
@@ -64,10 +104,22 @@ namespace bw
 			static constexpr std::size_t InvalidPeerId = std::numeric_limits<std::size_t>::max();
 	
 		private:
+			struct PendingConnection;
+			struct SimulatedPeer;
+
+			bool AcceptPendingConnection(std::size_t peerId, const moodycamel::ProducerToken& producterToken);
+			std::size_t CountClients() const;
 			void EnsureProperDisconnection(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token);
+			void ExpirePendingConnections();
 			void HandleConnectionRequests(moodycamel::ConsumerToken& token);
+			void NotifyConnection(std::size_t peerId, bool outgoing, Nz::UInt32 data, const moodycamel::ProducerToken& producterToken);
 			void ReceivePackets(const moodycamel::ProducerToken& producterToken);
+			void RegisterPendingConnection(Nz::ENetPeer* peer, Nz::UInt32 data);
+			void RemovePendingConnection(std::vector<PendingConnection>::iterator it);
+			SimulatedPeer* RetrieveSimulatedPeer(std::size_t peerId);
 			void SendPackets(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token);
+			void UpdateSimulatedPeer(std::size_t peerId, const moodycamel::ProducerToken& producterToken, Nz::UInt64 now);
+			void UpdateSimulatedPeers(const moodycamel::ProducerToken& producterToken);
 			void WorkerThread();
 
 			struct ConnectionRequest
@@ -127,19 +179,75 @@ namespace bw
 					PeerInfoCallback callback;
 				};
 
+				struct SimulateConditions
+				{
+					NetworkConditions conditions;
+				};
+
+				struct SetConnectionLimits
+				{
+					ConnectionLimits limits;
+				};
+
+				struct StatusQueries
+				{
+					std::shared_ptr<StatusQueryResponder> responder;
+				};
+
 				std::size_t peerId = InvalidPeerId;
-				std::variant<DisconnectEvent, PacketEvent, QueryPeerInfo> data;
+				std::variant<DisconnectEvent, PacketEvent, QueryPeerInfo, SetConnectionLimits, SimulateConditions, StatusQueries> data;
+			};
+
+			struct AtomicConnectionStatistics
+			{
+				std::atomic<Nz::UInt64> abandonedConnections{ 0 };
+				std::atomic<Nz::UInt64> acceptedConnections{ 0 };
+				std::atomic<Nz::UInt64> evictedConnections{ 0 };
+				std::atomic<Nz::UInt64> expiredConnections{ 0 };
+				std::atomic<Nz::UInt64> refusedConnections{ 0 };
+				std::atomic<std::size_t> pendingConnections{ 0 };
+			};
+
+			struct ConnectionSource
+			{
+				TokenBucket budget;
+				Nz::UInt64 lastConnectionTime;
+				std::size_t pendingConnectionCount;
+			};
+
+			struct PendingConnection
+			{
+				Nz::IpAddress address;
+				Nz::UInt64 connectionTime;
+				Nz::UInt32 data;
+				std::size_t peerId;
+			};
+
+			struct SimulatedPeer
+			{
+				NetworkConditionSimulator incoming;
+				NetworkConditionSimulator outgoing;
 			};
 
 			std::atomic_bool m_running;
 			std::size_t m_firstId;
+			std::size_t m_maxClient;
+			std::optional<ConnectionLimits> m_connectionLimits;
+			std::optional<NetworkConditions> m_simulatedConditions;
+			std::shared_ptr<StatusQueryResponder> m_statusResponder;
 			std::vector<Nz::ENetPeer*> m_clients;
+			std::vector<PendingConnection> m_pendingConnections; //< oldest first
+			std::vector<std::optional<SimulatedPeer>> m_simulatedPeers;
+			tsl::hopscotch_map<Nz::IpAddress, ConnectionSource> m_connectionSources;
 			moodycamel::ConcurrentQueue<ConnectionRequest> m_connectionRequests;
 			moodycamel::ConcurrentQueue<IncomingEvent> m_incomingQueue;
 			moodycamel::ConcurrentQueue<OutgoingEvent> m_outgoingQueue;
+			AtomicConnectionStatistics m_connectionStatistics;
+			Nz::Bitset<> m_pendingPeers;
 			Nz::ENetHost m_host;
 			Nz::NetProtocol m_protocol;
 			Nz::Thread m_thread;
+			Nz::UInt64 m_lastConnectionSourcePruning;
 	};
 }
 
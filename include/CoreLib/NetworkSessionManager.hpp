@@ -23,15 +23,26 @@ namespace bw
 			NetworkSessionManager(MatchSessions* owner, Nz::UInt16 port, std::size_t maxClient);
 			~NetworkSessionManager();
 
+			inline void EnableStatusQueries(std::shared_ptr<StatusQueryResponder> responder);
+
+			inline NetworkReactor::ConnectionStatistics GetConnectionStatistics() const;
+
 			void Poll() override;
 
+			inline void SimulateNetworkConditions(const NetworkConditions& conditions);
+
+			static constexpr Nz::UInt64 ConnectionReportInterval = 1000;
+
 		private:
 			void HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data);
 			void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data);
 			void HandlePeerPacket(std::size_t peerId, Nz::NetPacket&& packet);
+			void ReportConnectionStatistics();
 
 			std::vector<MatchClientSession*> m_peerIdToSession;
 			NetworkReactor m_reactor;
+			NetworkReactor::ConnectionStatistics m_lastConnectionStatistics;
+			Nz::UInt64 m_lastConnectionReport;
 	};
 }
 
@@ -3,3 +3,21 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/NetworkSessionManager.hpp>
+
+namespace bw
+{
+	inline void NetworkSessionManager::EnableStatusQueries(std::shared_ptr<StatusQueryResponder> responder)
+	{
+		m_reactor.EnableStatusQueries(std::move(responder));
+	}
+
+	inline NetworkReactor::ConnectionStatistics NetworkSessionManager::GetConnectionStatistics() const
+	{
+		return m_reactor.GetConnectionStatistics();
+	}
+
+	inline void NetworkSessionManager::SimulateNetworkConditions(const NetworkConditions& conditions)
+	{
+		m_reactor.SimulateNetworkConditions(conditions);
+	}
+}
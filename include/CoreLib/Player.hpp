@@ -84,6 +84,8 @@ namespace bw
 
 		private:
 			void OnDeath(const Ndk::EntityHandle& attacker);
+			void OnEntityLayerChange(const Ndk::EntityHandle& oldEntity, const Ndk::EntityHandle& newEntity, LayerIndex previousLayerIndex);
+			void OnMapChange();
 			void SetReady();
 
 			NazaraSlot(Ndk::Entity, OnEntityDestruction, m_onPlayerEntityDestruction);
@@ -11,12 +11,13 @@
 
 namespace bw
 {
+	class ConfigFile;
 	class MatchClientSession;
 
 	class PlayerCommandStore : public CommandStore<MatchClientSession>
 	{
 		public:
-			PlayerCommandStore(const Logger& logger);
+			PlayerCommandStore(const Logger& logger, const ConfigFile& config);
 			~PlayerCommandStore() = default;
 	};
 }
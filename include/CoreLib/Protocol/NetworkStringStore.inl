@@ -32,6 +32,11 @@ namespace bw
 		return m_strings[id];
 	}
 
+	inline Nz::UInt32 NetworkStringStore::GetStringCount() const
+	{
+		return static_cast<Nz::UInt32>(m_strings.size());
+	}
+
 	inline Nz::UInt32 NetworkStringStore::GetStringIndex(const std::string& string) const
 	{
 		auto it = m_stringMap.find(string);
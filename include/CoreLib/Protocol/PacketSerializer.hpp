@@ -8,6 +8,7 @@
 #define BURGWAR_CORELIB_NETWORK_PACKETSERIALIZER_HPP
 
 #include <Nazara/Network/NetPacket.hpp>
+#include <string>
 #include <vector>
 
 namespace bw
@@ -18,6 +19,8 @@ namespace bw
 			inline PacketSerializer(Nz::NetPacket& packetBuffer, bool isWriting);
 			~PacketSerializer() = default;
 
+			inline void CheckArraySize(Nz::UInt64 arraySize) const;
+
 			inline void Read(void* ptr, std::size_t size);
 
 			inline bool IsWriting() const;
@@ -25,6 +28,7 @@ namespace bw
 			inline void Write(const void* ptr, std::size_t size);
 
 			template<typename DataType> void Serialize(DataType& data);
+			inline void Serialize(std::string& str);
 			template<typename DataType> void Serialize(std::vector<DataType>& dataVec);
 			template<typename DataType> void Serialize(const DataType& data) const;
 			template<typename PacketType, typename DataType> void Serialize(DataType& data);
@@ -37,6 +41,8 @@ namespace bw
 			template<typename DataType> void operator&=(const DataType& data) const;
 
 		private:
+			inline std::size_t GetRemainingSize() const;
+
 			Nz::NetPacket& m_buffer;
 			bool m_isWriting;
 	};
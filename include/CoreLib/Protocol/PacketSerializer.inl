@@ -15,6 +15,13 @@ namespace bw
 	{
 	}
 
+	inline void PacketSerializer::CheckArraySize(Nz::UInt64 arraySize) const
+	{
+		// For element counts that aren't serialized by SerializeArraySize (such as the sum of per-layer counts)
+		if (!IsWriting() && arraySize > Nz::UInt64(GetRemainingSize()) * 8)
+			throw std::runtime_error("Array size exceeds packet size");
+	}
+
 	inline void PacketSerializer::Read(void* ptr, std::size_t size)
 	{
 		if (m_buffer.Read(ptr, size) != size)
@@ -41,6 +48,24 @@ namespace bw
 			m_buffer << data;
 	}
 
+	inline void PacketSerializer::Serialize(std::string& str)
+	{
+		if (!IsWriting())
+		{
+			// Same layout as Nazara string serialization, but the size is checked before allocating
+			Nz::UInt32 size;
+			m_buffer >> size;
+
+			if (size > GetRemainingSize())
+				throw std::runtime_error("String size exceeds packet size");
+
+			str.resize(size);
+			Read(str.data(), size);
+		}
+		else
+			m_buffer << str;
+	}
+
 	template<typename DataType>
 	void PacketSerializer::Serialize(std::vector<DataType>& dataVec)
 	{
@@ -89,7 +114,13 @@ namespace bw
 		Serialize(arraySize);
 
 		if (!IsWriting())
+		{
+			// Every element takes at least one bit, don't let a malformed packet make us allocate more than it can hold
+			if (arraySize > GetRemainingSize() * 8)
+				throw std::runtime_error("Array size exceeds packet size");
+
 			array.resize(arraySize);
+		}
 	}
 
 	template<typename T>
@@ -101,6 +132,11 @@ namespace bw
 		Serialize(arraySize);
 	}
 
+	inline std::size_t PacketSerializer::GetRemainingSize() const
+	{
+		return static_cast<std::size_t>(m_buffer.GetSize() - m_buffer.GetStream()->GetCursorPos());
+	}
+
 	template<typename DataType>
 	void PacketSerializer::operator&=(DataType& data)
 	{
@@ -12,6 +12,7 @@
 #include <CoreLib/Protocol/CompressedInteger.hpp>
 #include <CoreLib/Protocol/PacketSerializer.hpp>
 #include <Nazara/Prerequisites.hpp>
+#include <Nazara/Core/ByteArray.hpp>
 #include <Nazara/Core/Color.hpp>
 #include <Nazara/Core/String.hpp>
 #include <Nazara/Math/Angle.hpp>
@@ -20,6 +21,7 @@
 #include <Nazara/Math/Vector3.hpp>
 #include <Nazara/Network/NetPacket.hpp>
 #include <array>
+#include <memory>
 #include <optional>
 #include <variant>
 #include <vector>
@@ -45,9 +47,12 @@ namespace bw
 		EntitiesAnimation,
 		EntitiesDeath,
 		EntitiesInputs,
+		EntitiesLayerChange,
+		EntitiesPropertyUpdate,
 		EntityWeapon,
 		InputTimingCorrection,
 		HealthUpdate,
+		MapChange,
 		MatchData,
 		MatchState,
 		NetworkStrings,
@@ -144,6 +149,7 @@ namespace bw
 			};
 
 			std::vector<Player> players;
+			CompressedUnsigned<Nz::UInt32> layerCacheSize; //< how many entities of disabled layers the client is willing to keep
 		};
 
 		DeclarePacket(AuthFailure)
@@ -214,6 +220,7 @@ namespace bw
 			{
 				CompressedUnsigned<Nz::UInt32> id;
 				Helper::EntityData data;
+				std::shared_ptr<const Nz::ByteArray> serializedData; //< if set, written as-is instead of data (which is left empty)
 			};
 
 			struct Layer
@@ -249,6 +256,7 @@ namespace bw
 		{
 			Nz::UInt16 stateTick;
 			CompressedUnsigned<LayerIndex> layerIndex;
+			bool keepEntities; //< if the layer is already disabled, false releases its dormant entities
 		};
 
 		DeclarePacket(DownloadClientScriptRequest)
@@ -271,7 +279,9 @@ namespace bw
 
 			Nz::UInt16 stateTick;
 			CompressedUnsigned<LayerIndex> layerIndex;
-			std::vector<Entity> layerEntities;
+			std::vector<CompressedUnsigned<Nz::UInt32>> removedEntities;
+			std::vector<Entity> layerEntities; //< replaces dormant entities with the same id
+			bool isDelta; //< dormant entities which are neither removed nor replaced are kept
 		};
 
 		DeclarePacket(EntitiesAnimation)
@@ -330,6 +340,53 @@ namespace bw
 			std::vector<Layer> layers;
 		};
 
+		DeclarePacket(EntitiesLayerChange)
+		{
+			struct Entity
+			{
+				CompressedUnsigned<Nz::UInt32> id;
+				CompressedUnsigned<Nz::UInt32> newEntityId;
+				std::optional<CompressedUnsigned<Nz::UInt32>> newParentId;
+			};
+
+			struct Layer
+			{
+				CompressedUnsigned<LayerIndex> layerIndex;
+				CompressedUnsigned<LayerIndex> newLayerIndex;
+				CompressedUnsigned<Nz::UInt32> entityCount;
+			};
+
+			Nz::UInt16 stateTick;
+			std::vector<Entity> entities;
+			std::vector<Layer> layers;
+		};
+
+		DeclarePacket(EntitiesPropertyUpdate)
+		{
+			struct Property
+			{
+				Nz::UInt8 index;
+				Helper::Properties::PropertyValue value;
+				bool isArray;
+			};
+
+			struct Entity
+			{
+				CompressedUnsigned<Nz::UInt32> id;
+				std::vector<Property> properties;
+			};
+
+			struct Layer
+			{
+				CompressedUnsigned<LayerIndex> layerIndex;
+				CompressedUnsigned<Nz::UInt32> entityCount;
+			};
+
+			Nz::UInt16 stateTick;
+			std::vector<Entity> entities;
+			std::vector<Layer> layers;
+		};
+
 		DeclarePacket(EntityWeapon)
 		{
 			Nz::UInt16 stateTick;
@@ -365,6 +422,26 @@ namespace bw
 			CompressedSigned<Nz::Int32> tickError;
 		};
 
+		DeclarePacket(MapChange)
+		{
+			struct Asset
+			{
+				std::array<Nz::UInt8, 20> sha1Checksum;
+				std::string path;
+				CompressedUnsigned<Nz::UInt64> size;
+			};
+
+			struct Layer
+			{
+				Nz::Color backgroundColor;
+			};
+
+			std::vector<std::string> fastDownloadUrls;
+			std::vector<Asset> assets; //< only assets the client doesn't have yet or which changed
+			std::vector<Layer> layers;
+			Nz::UInt16 stateTick;
+		};
+
 		DeclarePacket(MatchData)
 		{
 			struct Asset
@@ -541,9 +618,12 @@ namespace bw
 		void Serialize(PacketSerializer& serializer, EntitiesAnimation& data);
 		void Serialize(PacketSerializer& serializer, EntitiesDeath& data);
 		void Serialize(PacketSerializer& serializer, EntitiesInputs& data);
+		void Serialize(PacketSerializer& serializer, EntitiesLayerChange& data);
+		void Serialize(PacketSerializer& serializer, EntitiesPropertyUpdate& data);
 		void Serialize(PacketSerializer& serializer, EntityWeapon& data);
 		void Serialize(PacketSerializer& serializer, HealthUpdate& data);
 		void Serialize(PacketSerializer& serializer, InputTimingCorrection& data);
+		void Serialize(PacketSerializer& serializer, MapChange& data);
 		void Serialize(PacketSerializer& serializer, MatchData& data);
 		void Serialize(PacketSerializer& serializer, MatchState& data);
 		void Serialize(PacketSerializer& serializer, NetworkStrings& data);
@@ -564,6 +644,7 @@ namespace bw
 		// Helpers
 		void Serialize(PacketSerializer& serializer, PlayerInputData& data);
 		void Serialize(PacketSerializer& serializer, Helper::EntityData& data);
+		void Serialize(PacketSerializer& serializer, Helper::Properties::PropertyValue& value, bool isArray);
 	}
 }
 
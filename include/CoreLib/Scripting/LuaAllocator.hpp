@@ -0,0 +1,99 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_SCRIPTING_LUAALLOCATOR_HPP
+#define BURGWAR_CORELIB_SCRIPTING_LUAALLOCATOR_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bw
+{
+	// Lua allocator pooling small blocks (most Lua objects) and keeping track of memory usage and of allocations per owner (element)
+	class LuaAllocator
+	{
+		public:
+			class OwnerScope;
+
+			inline LuaAllocator(std::size_t memoryLimit = 0);
+			LuaAllocator(const LuaAllocator&) = delete;
+			LuaAllocator(LuaAllocator&&) = delete;
+			~LuaAllocator() = default;
+
+			template<typename F> void ForEachOwnerAllocation(F&& func) const;
+
+			inline std::size_t GetMemoryLimit() const;
+			inline std::size_t GetMemoryUsage() const;
+			inline std::size_t GetPeakMemoryUsage() const;
+
+			inline void ResetOwnerStatistics();
+
+			inline void SetMemoryLimit(std::size_t memoryLimit);
+
+			LuaAllocator& operator=(const LuaAllocator&) = delete;
+			LuaAllocator& operator=(LuaAllocator&&) = delete;
+
+			static void* Allocate(void* userdata, void* ptr, std::size_t oldSize, std::size_t newSize);
+
+			static constexpr std::size_t MaxPooledSize = 256;
+			static constexpr std::size_t PoolGranularity = 16;
+			static constexpr std::size_t PoolPageSize = 64 * 1024;
+
+			// Attributes allocations made during its lifetime to an owner (until another scope is opened)
+			class OwnerScope
+			{
+				public:
+					inline OwnerScope(LuaAllocator& allocator, const std::string& ownerName);
+					OwnerScope(const OwnerScope&) = delete;
+					OwnerScope(OwnerScope&&) = delete;
+					inline ~OwnerScope();
+
+					OwnerScope& operator=(const OwnerScope&) = delete;
+					OwnerScope& operator=(OwnerScope&&) = delete;
+
+				private:
+					LuaAllocator& m_allocator;
+					const std::string* m_previousOwner;
+			};
+
+		private:
+			void* AllocateFromPool(std::size_t sizeClass);
+			inline void ChangeOwner(const std::string* owner);
+			void FreeToPool(void* ptr, std::size_t sizeClass);
+			void* Reallocate(void* ptr, std::size_t oldSize, std::size_t newSize);
+
+			static inline std::size_t GetSizeClass(std::size_t size);
+
+			static constexpr std::size_t SizeClassCount = MaxPooledSize / PoolGranularity;
+			static constexpr std::size_t Unpooled = std::numeric_limits<std::size_t>::max();
+
+			struct FreeSlot
+			{
+				FreeSlot* next;
+			};
+
+			std::array<FreeSlot*, SizeClassCount> m_freeSlots;
+			std::vector<std::unique_ptr<Nz::UInt8[]>> m_pages;
+			tsl::hopscotch_map<std::string /*owner*/, std::size_t /*allocatedBytes*/> m_allocatedBytesByOwner;
+			const std::string* m_currentOwner;
+			std::size_t m_allocatedBytes; //< cumulative, used to attribute allocations to owners
+			std::size_t m_memoryLimit;
+			std::size_t m_memoryUsage;
+			std::size_t m_ownerStartBytes;
+			std::size_t m_pageOffset;
+			std::size_t m_peakMemoryUsage;
+	};
+}
+
+#include <CoreLib/Scripting/LuaAllocator.inl>
+
+#endif
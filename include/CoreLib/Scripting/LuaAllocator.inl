@@ -0,0 +1,84 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Scripting/LuaAllocator.hpp>
+#include <cassert>
+
+namespace bw
+{
+	inline LuaAllocator::LuaAllocator(std::size_t memoryLimit) :
+	m_currentOwner(nullptr),
+	m_allocatedBytes(0),
+	m_memoryLimit(memoryLimit),
+	m_memoryUsage(0),
+	m_ownerStartBytes(0),
+	m_pageOffset(PoolPageSize),
+	m_peakMemoryUsage(0)
+	{
+		m_freeSlots.fill(nullptr);
+	}
+
+	template<typename F>
+	void LuaAllocator::ForEachOwnerAllocation(F&& func) const
+	{
+		for (auto&& [ownerName, allocatedBytes] : m_allocatedBytesByOwner)
+			func(ownerName, allocatedBytes);
+	}
+
+	inline std::size_t LuaAllocator::GetMemoryLimit() const
+	{
+		return m_memoryLimit;
+	}
+
+	inline std::size_t LuaAllocator::GetMemoryUsage() const
+	{
+		return m_memoryUsage;
+	}
+
+	inline std::size_t LuaAllocator::GetPeakMemoryUsage() const
+	{
+		return m_peakMemoryUsage;
+	}
+
+	inline void LuaAllocator::ResetOwnerStatistics()
+	{
+		m_allocatedBytesByOwner.clear();
+		m_ownerStartBytes = m_allocatedBytes;
+	}
+
+	inline void LuaAllocator::SetMemoryLimit(std::size_t memoryLimit)
+	{
+		m_memoryLimit = memoryLimit;
+	}
+
+	inline void LuaAllocator::ChangeOwner(const std::string* owner)
+	{
+		if (m_currentOwner && m_allocatedBytes != m_ownerStartBytes)
+			m_allocatedBytesByOwner[*m_currentOwner] += m_allocatedBytes - m_ownerStartBytes;
+
+		m_currentOwner = owner;
+		m_ownerStartBytes = m_allocatedBytes;
+	}
+
+	inline std::size_t LuaAllocator::GetSizeClass(std::size_t size)
+	{
+		assert(size > 0);
+		if (size > MaxPooledSize)
+			return Unpooled;
+
+		return (size - 1) / PoolGranularity;
+	}
+
+	inline LuaAllocator::OwnerScope::OwnerScope(LuaAllocator& allocator, const std::string& ownerName) :
+	m_allocator(allocator),
+	m_previousOwner(allocator.m_currentOwner)
+	{
+		m_allocator.ChangeOwner(&ownerName);
+	}
+
+	inline LuaAllocator::OwnerScope::~OwnerScope()
+	{
+		m_allocator.ChangeOwner(m_previousOwner);
+	}
+}
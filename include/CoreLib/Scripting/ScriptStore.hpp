@@ -51,8 +51,10 @@ namespace bw
 			static constexpr std::size_t InvalidIndex = std::numeric_limits<std::size_t>::max();
 
 		protected:
+			EntityPropertyContainer BuildEntityProperties(const ScriptedElement& element, const EntityProperties& properties) const;
 			virtual std::shared_ptr<Element> CreateElement() const;
 			const Ndk::EntityHandle& CreateEntity(Ndk::World& world, std::shared_ptr<const ScriptedElement> element, const EntityProperties& properties) const;
+			sol::table CreateEntityTable(const ScriptedElement& element) const;
 			virtual void InitializeElementTable(sol::table& elementTable);
 			virtual void InitializeElement(sol::table& elementTable, Element& element) = 0;
 			bool InitializeEntity(const Element& entityClass, const Ndk::EntityHandle& entity) const;
@@ -64,6 +66,8 @@ namespace bw
 			void SetTableName(std::string tableName);
 
 		private:
+			static bool HasSamePropertyLayout(const ScriptedElement& first, const ScriptedElement& second);
+
 			sol::table m_elementMetatable;
 			std::shared_ptr<ScriptingContext> m_context;
 			std::string m_elementTypeName;
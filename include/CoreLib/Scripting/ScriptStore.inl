@@ -78,6 +78,8 @@ namespace bw
 		if (auto it = m_elementsByName.find(entityElement->fullName); it != m_elementsByName.end())
 		{
 			const auto& newElement = m_elements[it->second];
+			if (newElement == entityElement)
+				return;
 
 			sol::table& entityTable = entityScript.GetTable();
 			entityTable[sol::metatable_key] = newElement->elementTable;
@@ -153,6 +155,8 @@ namespace bw
 		element->postFrameFunction = element->elementTable["OnPostFrame"];
 		element->tickFunction = element->elementTable["OnTick"];
 
+		element->defaultProperties = std::make_shared<EntityPropertyContainer::PropertyBlock>();
+
 		sol::object properties = element->elementTable["Properties"];
 		if (properties)
 		{
@@ -167,6 +171,9 @@ namespace bw
 
 				try
 				{
+					if (propertyIndex >= MaxPropertyCount)
+						throw std::runtime_error("Too many properties (max: " + std::to_string(MaxPropertyCount) + ")");
+
 					ScriptedElement::Property property;
 					property.index = propertyIndex;
 					property.type = propertyTable["Type"];
@@ -184,10 +191,17 @@ namespace bw
 						property.defaultValue = TranslateEntityPropertyFromLua(nullptr, propertyDefault, property.type, property.isArray);
 
 					auto it = element->properties.find(propertyName);
-					if (it == element->properties.end())
-						element->properties.emplace(std::move(propertyName), std::move(property));
-					else
+					if (it != element->properties.end())
 						throw std::runtime_error("Property " + propertyName + " found twice");
+
+					auto& defaultProperties = *element->defaultProperties;
+					if (defaultProperties.size() <= propertyIndex)
+						defaultProperties.resize(propertyIndex + 1);
+
+					defaultProperties[propertyIndex] = property.defaultValue;
+					element->sharedProperties.set(propertyIndex, property.shared);
+
+					element->properties.emplace(std::move(propertyName), std::move(property));
 				}
 				catch (const std::exception& e)
 				{
@@ -198,6 +212,17 @@ namespace bw
 			}
 		}
 
+		auto elementIt = m_elementsByName.find(element->fullName);
+		if (elementIt != m_elementsByName.end())
+		{
+			// Properties are sent by index and peers may still run the previous version, a new layout requires a full reload
+			if (!HasSamePropertyLayout(*m_elements[elementIt->second], *element))
+			{
+				bwLog(m_logger, LogLevel::Error, "{0} {1} properties changed, keeping previous version until next full reload", m_elementTypeName, element->name);
+				return false;
+			}
+		}
+
 		try
 		{
 			InitializeElement(element->elementTable, *element);
@@ -207,8 +232,16 @@ namespace bw
 			bwLog(m_logger, LogLevel::Error, "Failed to initialize {0} {1}: {2}", m_elementTypeName, elementName, e.what());
 		}
 
-		m_elementsByName[element->fullName] = m_elements.size();
-		m_elements.emplace_back(std::move(element));
+		if (elementIt != m_elementsByName.end())
+		{
+			// Element reloaded on its own, keep its index so live entities and network ids stay valid
+			m_elements[elementIt->second] = std::move(element);
+		}
+		else
+		{
+			m_elementsByName[element->fullName] = m_elements.size();
+			m_elements.emplace_back(std::move(element));
+		}
 
 		return true;
 	}
@@ -238,19 +271,12 @@ namespace bw
 	}
 
 	template<typename Element>
-	std::shared_ptr<Element> ScriptStore<Element>::CreateElement() const
-	{
-		return std::make_shared<Element>();
-	}
-
-	template<typename Element>
-	const Ndk::EntityHandle& ScriptStore<Element>::CreateEntity(Ndk::World& world, std::shared_ptr<const ScriptedElement> element, const EntityProperties& properties) const
+	EntityPropertyContainer ScriptStore<Element>::BuildEntityProperties(const ScriptedElement& element, const EntityProperties& properties) const
 	{
-		const Ndk::EntityHandle& entity = world.CreateEntity();
+		// Starts by sharing the element default values, only entities with custom values get their own block
+		EntityPropertyContainer entityProperties(element.defaultProperties);
 
-		EntityProperties filteredProperties; //< Without potential unused properties (FIXME: Is it really necessary?)
-
-		for (auto&& [propertyName, propertyInfo] : element->properties)
+		for (auto&& [propertyName, propertyInfo] : element.properties)
 		{
 			if (auto it = properties.find(propertyName); it != properties.end())
 			{
@@ -258,7 +284,7 @@ namespace bw
 
 				//TODO: Check property type
 
-				filteredProperties.emplace(propertyName, it->second);
+				entityProperties.SetProperty(propertyInfo.index, it->second);
 			}
 			else
 			{
@@ -268,19 +294,52 @@ namespace bw
 			}
 		}
 
-		const auto& scriptingContext = GetScriptingContext();
+		return entityProperties;
+	}
+
+	template<typename Element>
+	std::shared_ptr<Element> ScriptStore<Element>::CreateElement() const
+	{
+		return std::make_shared<Element>();
+	}
+
+	template<typename Element>
+	const Ndk::EntityHandle& ScriptStore<Element>::CreateEntity(Ndk::World& world, std::shared_ptr<const ScriptedElement> element, const EntityProperties& properties) const
+	{
+		EntityPropertyContainer entityProperties = BuildEntityProperties(*element, properties);
+
+		const Ndk::EntityHandle& entity = world.CreateEntity();
 
-		sol::state& state = scriptingContext->GetLuaState();
+		const auto& scriptingContext = GetScriptingContext();
 
-		sol::table entityTable = state.create_table();
+		sol::table entityTable = CreateEntityTable(*element);
 		entityTable["_Entity"] = entity;
-		entityTable[sol::metatable_key] = element->elementTable;
 
-		entity->AddComponent<ScriptComponent>(m_logger, std::move(element), scriptingContext, std::move(entityTable), std::move(filteredProperties));
+		entity->AddComponent<ScriptComponent>(m_logger, std::move(element), scriptingContext, std::move(entityTable), std::move(entityProperties));
 
 		return entity;
 	}
 
+	template<typename Element>
+	sol::table ScriptStore<Element>::CreateEntityTable(const ScriptedElement& element) const
+	{
+		sol::table entityTable;
+		if (element.entityPool && !element.entityPool->entityTables.empty())
+		{
+			// Pooled tables have never been given to scripts
+			auto& pooledTables = element.entityPool->entityTables;
+
+			entityTable = std::move(pooledTables.back());
+			pooledTables.pop_back();
+		}
+		else
+			entityTable = GetScriptingContext()->GetLuaState().create_table();
+
+		entityTable[sol::metatable_key] = element.elementTable;
+
+		return entityTable;
+	}
+
 	template<typename Element>
 	void ScriptStore<Element>::InitializeElementTable(sol::table& /*elementTable*/)
 	{
@@ -302,6 +361,26 @@ namespace bw
 
 		return true;
 	}
+	template<typename Element>
+	bool ScriptStore<Element>::HasSamePropertyLayout(const ScriptedElement& first, const ScriptedElement& second)
+	{
+		if (first.properties.size() != second.properties.size())
+			return false;
+
+		for (auto&& [propertyName, propertyData] : first.properties)
+		{
+			auto it = second.properties.find(propertyName);
+			if (it == second.properties.end())
+				return false;
+
+			const ScriptedElement::Property& otherProperty = it->second;
+			if (propertyData.index != otherProperty.index || propertyData.type != otherProperty.type || propertyData.isArray != otherProperty.isArray || propertyData.shared != otherProperty.shared)
+				return false;
+		}
+
+		return true;
+	}
+
 	template<typename Element>
 	sol::state& ScriptStore<Element>::GetLuaState()
 	{
@@ -8,17 +8,26 @@
 #define BURGWAR_CORELIB_SCRIPTING_SCRIPTEDELEMENT_HPP
 
 #include <CoreLib/EntityProperties.hpp>
+#include <CoreLib/EntityPropertyContainer.hpp>
 #include <Nazara/Prerequisites.hpp>
 #include <Thirdparty/tsl/hopscotch_map.h>
 #include <Thirdparty/sol3/sol.hpp>
+#include <bitset>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace bw
 {
 	struct ScriptedElement : std::enable_shared_from_this<ScriptedElement>
 	{
+		struct EntityPool
+		{
+			std::size_t capacity;
+			std::vector<sol::table> entityTables;
+		};
+
 		struct Property
 		{
 			PropertyType type;
@@ -32,9 +41,13 @@ namespace bw
 		sol::protected_function frameFunction;
 		sol::protected_function initializeFunction;
 		sol::protected_function postFrameFunction;
+		sol::protected_function resetFunction;
 		sol::protected_function tickFunction;
 		std::string name;
 		std::string fullName;
+		std::shared_ptr<EntityPropertyContainer::PropertyBlock> defaultProperties; //< indexed by Property::index, shared by entities
+		std::shared_ptr<EntityPool> entityPool; //< only set for poolable elements, holds prewarmed entity tables
+		std::bitset<MaxPropertyCount> sharedProperties; //< indexed by Property::index
 		tsl::hopscotch_map<std::string /*key*/, Property> properties;
 	};
 }
@@ -8,10 +8,15 @@
 #define BURGWAR_CORELIB_SCRIPTINGCONTEXT_HPP
 
 #include <CoreLib/Scripting/AbstractScriptingLibrary.hpp>
+#include <CoreLib/Scripting/LuaAllocator.hpp>
 #include <CoreLib/Utility/VirtualDirectory.hpp>
 #include <Thirdparty/sol3/sol.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace bw
@@ -26,6 +31,11 @@ namespace bw
 
 			template<typename... Args> sol::coroutine CreateCoroutine(Args&&... args);
 
+			inline void EnableBytecodeCache(std::filesystem::path cacheFolder);
+			void EnableManualGarbageCollection(bool enable = true);
+
+			inline LuaAllocator& GetAllocator();
+			inline const LuaAllocator& GetAllocator() const;
 			inline const std::filesystem::path& GetCurrentFile() const;
 			inline const std::filesystem::path& GetCurrentFolder() const;
 			inline sol::state& GetLuaState();
@@ -36,20 +46,31 @@ namespace bw
 
 			void ReloadLibraries();
 
+			void StepGarbageCollector(float maxDuration);
+
 			void Update();
 			inline void UpdateScriptDirectory(std::shared_ptr<VirtualDirectory> scriptDir);
 
 		private:
+			sol::load_result CompileChunk(const std::string_view& source, const std::string& chunkName);
 			sol::thread& CreateThread();
+			bool Execute(const std::string_view& source, const std::filesystem::path& path);
+			const std::vector<Nz::UInt8>* RetrieveBytecode(const std::string& cacheKey);
+			void StoreBytecode(const std::string& cacheKey, const sol::protected_function& chunk);
 
+			std::optional<std::filesystem::path> m_bytecodeCacheFolder;
 			std::filesystem::path m_currentFile;
 			std::filesystem::path m_currentFolder;
 			std::shared_ptr<VirtualDirectory> m_scriptDirectory;
 			std::vector<std::shared_ptr<AbstractScriptingLibrary>> m_libraries;
 			std::vector<sol::thread> m_availableThreads;
 			std::vector<sol::thread> m_runningThreads;
+			LuaAllocator m_allocator; //< must outlive the Lua state
 			sol::state m_luaState;
+			tsl::hopscotch_map<std::string /*cacheKey*/, std::vector<Nz::UInt8>> m_bytecodeCache;
 			const Logger& m_logger;
+			Nz::UInt64 m_lastMemoryWarning;
+			bool m_manualGarbageCollection;
 	};
 }
 
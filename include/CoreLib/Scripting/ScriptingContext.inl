@@ -12,7 +12,10 @@ namespace bw
 {
 	ScriptingContext::ScriptingContext(const Logger& logger, std::shared_ptr<VirtualDirectory> scriptDir) :
 	m_scriptDirectory(std::move(scriptDir)),
-	m_logger(logger)
+	m_luaState(sol::default_at_panic, &LuaAllocator::Allocate, &m_allocator),
+	m_logger(logger),
+	m_lastMemoryWarning(0),
+	m_manualGarbageCollection(false)
 	{
 	}
 
@@ -24,6 +27,21 @@ namespace bw
 		return sol::coroutine(thread.state(), std::forward<Args>(args)...);
 	}
 
+	inline void ScriptingContext::EnableBytecodeCache(std::filesystem::path cacheFolder)
+	{
+		m_bytecodeCacheFolder = std::move(cacheFolder);
+	}
+
+	inline LuaAllocator& ScriptingContext::GetAllocator()
+	{
+		return m_allocator;
+	}
+
+	inline const LuaAllocator& ScriptingContext::GetAllocator() const
+	{
+		return m_allocator;
+	}
+
 	inline const std::filesystem::path& ScriptingContext::GetCurrentFile() const
 	{
 		return m_currentFile;
@@ -11,6 +11,9 @@
 #include <CoreLib/Scripting/ScriptedEntity.hpp>
 #include <CoreLib/Scripting/SharedEntityStore.hpp>
 #include <NDK/Entity.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
+#include <memory>
+#include <string>
 
 namespace bw
 {
@@ -24,9 +27,15 @@ namespace bw
 
 			const Ndk::EntityHandle& InstantiateEntity(TerrainLayer& layer, std::size_t entityIndex, Nz::Int64 uniqueId, const Nz::Vector2f& position, const Nz::DegreeAnglef& rotation, const EntityProperties& properties, const Ndk::EntityHandle& parent = Ndk::EntityHandle::InvalidHandle) const;
 
+			Ndk::EntityHandle RecycleEntity(TerrainLayer& layer, std::size_t entityIndex, Nz::Int64 uniqueId, const Nz::Vector2f& position, const Nz::DegreeAnglef& rotation, const EntityProperties& properties, const Ndk::EntityHandle& parent = Ndk::EntityHandle::InvalidHandle) const; //< only reuses the entity and its components, the script table and unique id are new
+
+			static constexpr std::size_t DefaultPoolSize = 32;
+
 		private:
 			void InitializeElementTable(sol::table& elementTable) override;
 			void InitializeElement(sol::table& elementTable, ScriptedEntity& element) override;
+
+			tsl::hopscotch_map<std::string /*entityClass*/, std::shared_ptr<ScriptedElement::EntityPool>> m_entityPools; //< outlives elements so reloads keep the prewarmed tables
 	};
 }
 
@@ -29,6 +29,8 @@ namespace bw
 			Ndk::World& GetWorld();
 			const Ndk::World& GetWorld() const;
 
+			const Ndk::EntityHandle& MigrateEntity(const Ndk::EntityHandle& entity);
+
 			virtual void TickUpdate(float elapsedTime);
 
 			SharedLayer& operator=(const SharedLayer&) = delete;
@@ -46,6 +46,7 @@ namespace bw
 			inline Nz::UInt16 GetNetworkTick(Nz::UInt64 tick) const;
 			inline ScriptHandlerRegistry& GetScriptPacketHandlerRegistry();
 			inline const ScriptHandlerRegistry& GetScriptPacketHandlerRegistry() const;
+			virtual const std::shared_ptr<ScriptingContext>& GetScriptingContext() const = 0;
 			inline float GetTickDuration() const;
 			inline TimerManager& GetTimerManager();
 			virtual SharedWeaponStore& GetWeaponStore() = 0;
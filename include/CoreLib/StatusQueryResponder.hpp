@@ -0,0 +1,114 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_STATUSQUERYRESPONDER_HPP
+#define BURGWAR_CORELIB_STATUSQUERYRESPONDER_HPP
+
+#include <CoreLib/Utility/TokenBucket.hpp>
+#include <Nazara/Core/AbstractHash.hpp>
+#include <Nazara/Core/ByteArray.hpp>
+#include <Nazara/Network/IpAddress.hpp>
+#include <Nazara/Network/UdpSocket.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bw
+{
+	struct ServerStatus
+	{
+		struct Player
+		{
+			std::string name;
+			Nz::UInt16 ping;
+		};
+
+		std::string gamemode;
+		std::string map;
+		std::string name;
+		std::vector<Player> players;
+		Nz::UInt16 maxPlayerCount = 0;
+		Nz::UInt32 peakUpdateTime = 0;   //< microseconds, since last publication
+		float effectiveTickRate = 0.f;   //< ticks per second, since last publication
+		float tickRate = 0.f;
+	};
+
+	// Answers connectionless status queries on its own UDP socket, meant to be polled by a NetworkReactor thread
+	// Request (little-endian, padded to RequestSize): magic, UInt8 type, UInt32 challenge
+	// A challenge reply is never bigger than the request, the status is only sent to sources which echoed a valid challenge
+	class StatusQueryResponder
+	{
+		public:
+			struct Settings;
+
+			StatusQueryResponder(Nz::NetProtocol protocol, Nz::UInt16 port, const Settings& settings);
+			StatusQueryResponder(const StatusQueryResponder&) = delete;
+			StatusQueryResponder(StatusQueryResponder&&) = delete;
+			~StatusQueryResponder() = default;
+
+			void Poll();
+
+			void Publish(const ServerStatus& status);
+
+			StatusQueryResponder& operator=(const StatusQueryResponder&) = delete;
+			StatusQueryResponder& operator=(StatusQueryResponder&&) = delete;
+
+			struct Settings
+			{
+				float globalBurst = 100.f;
+				float globalRate = 200.f; //< replies per second, all sources together
+				float sourceBurst = 4.f;
+				float sourceRate = 1.f;   //< replies per second and per source address
+			};
+
+			enum class QueryType : Nz::UInt8
+			{
+				ChallengeRequest = 0,
+				StatusRequest    = 1,
+				Challenge        = 2,
+				Status           = 3
+			};
+
+			static constexpr std::size_t MaxQueriesPerPoll = 64;
+			static constexpr std::size_t MaxResponseSize = 1200; //< stay below common path MTU
+			static constexpr std::size_t MaxTrackedSources = 4096; //< sources beyond this only consume the global budget
+			static constexpr std::size_t RequestSize = 16;
+			static constexpr Nz::UInt32 QueryMagic = 0x51535742; //< "BWSQ"
+			static constexpr Nz::UInt64 SecretRotationInterval = 30'000;
+			static constexpr Nz::UInt64 SourceExpiration = 10'000;
+
+		private:
+			struct Source
+			{
+				TokenBucket budget;
+				Nz::UInt64 lastQueryTime;
+			};
+
+			Nz::UInt32 ComputeChallenge(const Nz::IpAddress& address, Nz::UInt64 secret);
+			bool ConsumeBudget(Nz::UInt64 now, const Nz::IpAddress& address);
+			void HandleQuery(Nz::UInt64 now, const Nz::IpAddress& address, const Nz::UInt8* data, std::size_t size);
+			void PruneSources(Nz::UInt64 now);
+			void SendChallenge(const Nz::IpAddress& address);
+
+			std::array<Nz::UInt64, 2> m_secrets; //< current and previous, a challenge stays valid through one rotation
+			std::mt19937_64 m_secretGenerator;
+			std::shared_ptr<const Nz::ByteArray> m_response; //< accessed with std::atomic_load/atomic_store
+			std::unique_ptr<Nz::AbstractHash> m_hash;
+			tsl::hopscotch_map<Nz::IpAddress, Source> m_sources;
+			Nz::UdpSocket m_socket;
+			Nz::UInt64 m_lastSecretRotation;
+			Nz::UInt64 m_lastSourcePruning;
+			Settings m_settings;
+			TokenBucket m_globalBudget;
+	};
+}
+
+#include <CoreLib/StatusQueryResponder.inl>
+
+#endif
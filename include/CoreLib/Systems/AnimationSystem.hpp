@@ -7,7 +7,9 @@
 #ifndef BURGWAR_CLIENTLIB_SYSTEMS_ANIMATIONSYSTEM_HPP
 #define BURGWAR_CLIENTLIB_SYSTEMS_ANIMATIONSYSTEM_HPP
 
+#include <CoreLib/Components/AnimationComponent.hpp>
 #include <NDK/System.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
 #include <vector>
 
 namespace bw
@@ -23,8 +25,21 @@ namespace bw
 			static Ndk::SystemIndex systemIndex;
 
 		private:
+			void OnEntityAdded(Ndk::Entity* entity) override;
+			void OnEntityRemoved(Ndk::Entity* entity) override;
 			void OnUpdate(float elapsedTime) override;
+			void RegisterAnimationEnd(AnimationComponent& animComponent);
 
+			struct PendingAnimationEnd
+			{
+				Ndk::EntityHandle entity;
+				Nz::UInt64 endTime;
+			};
+
+			static bool ComparePendingAnimationEnds(const PendingAnimationEnd& lhs, const PendingAnimationEnd& rhs);
+
+			tsl::hopscotch_map<Ndk::EntityId, NazaraSlotType(AnimationComponent, OnAnimationStart)> m_animationStartSlots;
+			std::vector<PendingAnimationEnd> m_pendingAnimationEnds; //< min-heap on end time, entries of replaced animations are skipped when popped
 			SharedMatch& m_match;
 	};
 }
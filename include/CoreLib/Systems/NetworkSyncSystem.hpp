@@ -12,12 +12,17 @@
 #include <CoreLib/Components/HealthComponent.hpp>
 #include <CoreLib/Components/InputComponent.hpp>
 #include <CoreLib/Components/NetworkSyncComponent.hpp>
+#include <CoreLib/Components/ScriptComponent.hpp>
 #include <CoreLib/Scripting/ScriptedElement.hpp>
+#include <Nazara/Core/ByteArray.hpp>
 #include <Nazara/Core/Signal.hpp>
 #include <Nazara/Math/Angle.hpp>
 #include <Nazara/Math/Vector2.hpp>
 #include <NDK/System.hpp>
 #include <Thirdparty/tsl/hopscotch_map.h>
+#include <bitset>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <variant>
@@ -42,9 +47,20 @@ namespace bw
 			
 			inline TerrainLayer& GetLayer();
 			inline const TerrainLayer& GetLayer() const;
-			
+			inline Nz::UInt64 GetPublishedRevision() const;
+			inline Nz::UInt64 GetRevision() const;
+
+			// Revision is increased by every change to the data sent on entity creation, allowing clients to keep disabled layers around
+			bool HasEntityChangedSince(Ndk::EntityId entityId, Nz::UInt64 revision) const;
+
+			// Calls callback with the movement snapshot taken by the last UpdateMovementSnapshot call, can be called from multiple threads
 			void MoveEntities(const std::function<void(const EntityMovement* entityMovement, std::size_t entityCount)>& callback) const;
 
+			// Next creation event of this entity will reference its previous location, allowing clients to move it instead of recreating it
+			void NotifyLayerChange(Ndk::EntityId entityId, LayerIndex previousLayer, Ndk::EntityId previousEntityId);
+
+			void UpdateMovementSnapshot();
+
 			static Ndk::SystemIndex systemIndex;
 
 			struct HealthProperties
@@ -72,6 +88,13 @@ namespace bw
 				Nz::UInt64 startTime;
 			};
 
+			// Network encoding of a creation event, made by the first session sending it and spliced as-is by the others
+			struct CreationPayload
+			{
+				std::once_flag encodeFlag;
+				Nz::ByteArray data;
+			};
+
 			struct EntityCreation
 			{
 				Ndk::EntityId entityId;
@@ -84,9 +107,12 @@ namespace bw
 				std::optional<PlayerInputData> inputs;
 				std::optional<PlayerMovementData> playerMovement;
 				std::optional<PhysicsProperties> physicsProperties;
+				std::shared_ptr<const ScriptedElement> scriptElement;
 				std::string entityClass;
-				tsl::hopscotch_map<std::string /*key*/, EntityProperty> properties;
+				EntityPropertyContainer properties; //< shares its values block with the entity ScriptComponent
 				std::vector<std::pair<LayerIndex, Ndk::EntityId>> dependentIds;
+				std::optional<std::pair<LayerIndex, Ndk::EntityId>> previousLocation; //< set if the entity was moved from another layer
+				std::shared_ptr<CreationPayload> payload; //< shared by every copy of the event
 			};
 
 			struct EntityDeath
@@ -111,6 +137,13 @@ namespace bw
 				PlayerInputData inputs;
 			};
 
+			struct EntityPropertyUpdate
+			{
+				Ndk::EntityId entityId;
+				EntityPropertyContainer properties; //< shares its values block with the entity ScriptComponent
+				std::bitset<MaxPropertyCount> updatedProperties;
+			};
+
 			struct EntityMovement
 			{
 				Ndk::EntityId entityId;
@@ -127,6 +160,7 @@ namespace bw
 			NazaraSignal(OnEntityInvalidated, NetworkSyncSystem* /*emitter*/, const EntityMovement& /*event*/);
 			NazaraSignal(OnEntitiesInputUpdate, NetworkSyncSystem* /*emitter*/, const EntityInputs* /*events*/, std::size_t /*entityCount*/);
 			NazaraSignal(OnEntitiesHealthUpdate, NetworkSyncSystem* /*emitter*/, const EntityHealth* /*events*/, std::size_t /*entityCount*/);
+			NazaraSignal(OnEntitiesPropertyUpdate, NetworkSyncSystem* /*emitter*/, const EntityPropertyUpdate* /*events*/, std::size_t /*entityCount*/);
 
 		private:
 			void BuildEvent(EntityCreation& creationEvent, Ndk::Entity* entity) const;
@@ -145,20 +179,32 @@ namespace bw
 				NazaraSlot(HealthComponent, OnHealthChange, onHealthChange);
 				NazaraSlot(InputComponent, OnInputUpdate, onInputUpdate);
 				NazaraSlot(NetworkSyncComponent, OnInvalidated, onInvalidated);
+				NazaraSlot(ScriptComponent, OnPropertyUpdate, onPropertyUpdate);
+
+				std::bitset<MaxPropertyCount> dirtyProperties;
+				std::optional<EntityMovement> lastMovement; //< physics entities only
+				Nz::UInt64 revision = 0; //< value of the system revision when the entity was last changed
 			};
 
+			inline void MarkAsChanged(Ndk::EntityId entityId, bool isPublished = true);
+			inline void MarkAsChanged(EntitySlots& slots, bool isPublished = true);
+
 			tsl::hopscotch_map<Ndk::EntityId, EntitySlots> m_entitySlots;
+			tsl::hopscotch_map<Ndk::EntityId, std::pair<LayerIndex, Ndk::EntityId>> m_layerChanges;
 
 			Ndk::EntityList m_inputUpdateEntities;
 			Ndk::EntityList m_healthUpdateEntities;
+			Ndk::EntityList m_propertyUpdateEntities;
 			Ndk::EntityList m_physicsEntities;
 			Ndk::EntityList m_staticEntities;
 			Ndk::EntityList m_invalidatedEntities;
-			mutable std::vector<EntityCreation> m_creationEvents;
 			mutable std::vector<EntityDestruction> m_destructionEvents;
 			std::vector<EntityHealth> m_healthEvents;
 			std::vector<EntityInputs> m_inputEvents;
-			mutable std::vector<EntityMovement> m_movementEvents;
+			std::vector<EntityPropertyUpdate> m_propertyEvents;
+			std::vector<EntityMovement> m_movementEvents;
+			std::optional<Nz::UInt64> m_firstUnpublishedRevision; //< some changes are only signaled on next update
+			Nz::UInt64 m_revision;
 			TerrainLayer& m_layer;
 	};
 }
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/Systems/NetworkSyncSystem.hpp>
+#include <cassert>
 
 namespace bw
 {
@@ -15,4 +16,31 @@ namespace bw
 	{
 		return m_layer;
 	}
+
+	// Every change up to this revision has been signaled
+	inline Nz::UInt64 NetworkSyncSystem::GetPublishedRevision() const
+	{
+		return (m_firstUnpublishedRevision) ? *m_firstUnpublishedRevision - 1 : m_revision;
+	}
+
+	inline Nz::UInt64 NetworkSyncSystem::GetRevision() const
+	{
+		return m_revision;
+	}
+
+	inline void NetworkSyncSystem::MarkAsChanged(Ndk::EntityId entityId, bool isPublished)
+	{
+		auto it = m_entitySlots.find(entityId);
+		assert(it != m_entitySlots.end());
+
+		MarkAsChanged(it.value(), isPublished);
+	}
+
+	inline void NetworkSyncSystem::MarkAsChanged(EntitySlots& slots, bool isPublished)
+	{
+		slots.revision = ++m_revision;
+
+		if (!isPublished && !m_firstUnpublishedRevision)
+			m_firstUnpublishedRevision = slots.revision;
+	}
 }
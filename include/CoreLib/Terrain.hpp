@@ -9,6 +9,8 @@
 
 #include <CoreLib/Map.hpp>
 #include <CoreLib/TerrainLayer.hpp>
+#include <Nazara/Core/Bitset.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
 #include <vector>
 
 namespace bw
@@ -22,20 +24,30 @@ namespace bw
 			Terrain(const Terrain&) = delete;
 			~Terrain() = default;
 
+			template<typename F> void ForEachLoadedLayer(F&& func);
+
 			inline TerrainLayer& GetLayer(LayerIndex layerIndex);
 			inline const TerrainLayer& GetLayer(LayerIndex layerIndex) const;
 			inline LayerIndex GetLayerCount() const;
 			inline const Map& GetMap() const;
 
 			void Initialize(Match& match);
+			inline bool IsLayerLoaded(LayerIndex layerIndex) const;
+
+			bool LoadEntityLayer(Nz::Int64 uniqueId);
 
 			void Update(float elapsedTime);
 
 			Terrain& operator=(const Terrain&) = delete;
 
 		private:
+			inline void EnsureLayerLoaded(LayerIndex layerIndex) const;
+			void LoadLayer(LayerIndex layerIndex) const;
+
 			Map& m_map;
-			std::vector<TerrainLayer> m_layers; //< Shouldn't resize because of raw pointer in Player
+			mutable Nz::Bitset<Nz::UInt64> m_pendingLayers;
+			mutable std::vector<TerrainLayer> m_layers; //< Shouldn't resize because of raw pointer in Player, map entities are instantiated on first access
+			mutable tsl::hopscotch_map<Nz::Int64 /*uniqueId*/, LayerIndex> m_pendingEntities; //< map entities of layers not loaded yet
 	};
 }
 
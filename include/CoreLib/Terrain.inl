@@ -7,15 +7,29 @@
 
 namespace bw
 {
+	template<typename F>
+	void Terrain::ForEachLoadedLayer(F&& func)
+	{
+		for (LayerIndex layerIndex = 0; layerIndex < m_layers.size(); ++layerIndex)
+		{
+			if (IsLayerLoaded(layerIndex))
+				func(m_layers[layerIndex]);
+		}
+	}
+
 	inline TerrainLayer& Terrain::GetLayer(LayerIndex layerIndex)
 	{
 		assert(layerIndex < m_layers.size());
+		EnsureLayerLoaded(layerIndex);
+
 		return m_layers[layerIndex];
 	}
 
 	inline const TerrainLayer& Terrain::GetLayer(LayerIndex layerIndex) const
 	{
 		assert(layerIndex < m_layers.size());
+		EnsureLayerLoaded(layerIndex);
+
 		return m_layers[layerIndex];
 	}
 
@@ -28,4 +42,15 @@ namespace bw
 	{
 		return m_map;
 	}
+
+	inline bool Terrain::IsLayerLoaded(LayerIndex layerIndex) const
+	{
+		return layerIndex >= m_pendingLayers.GetSize() || !m_pendingLayers.Test(layerIndex);
+	}
+
+	inline void Terrain::EnsureLayerLoaded(LayerIndex layerIndex) const
+	{
+		if (!IsLayerLoaded(layerIndex))
+			LoadLayer(layerIndex);
+	}
 }
@@ -9,6 +9,9 @@
 
 #include <CoreLib/Map.hpp>
 #include <CoreLib/SharedLayer.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
+#include <string>
+#include <vector>
 
 namespace bw
 {
@@ -18,15 +21,32 @@ namespace bw
 	class TerrainLayer : public SharedLayer
 	{
 		public:
-			TerrainLayer(Match& match, LayerIndex layerIndex, const Map::Layer& layerData);
+			TerrainLayer(Match& match, LayerIndex layerIndex);
 			TerrainLayer(const TerrainLayer&) = delete;
 			TerrainLayer(TerrainLayer&&) noexcept = default;
 			~TerrainLayer() = default;
 
+			Ndk::EntityHandle AcquirePooledEntity(const std::string& entityClass);
+
 			Match& GetMatch();
 
+			void LoadEntities(const Map::Layer& layerData);
+
+			bool ReleaseEntity(const Ndk::EntityHandle& entity);
+
+			void TickUpdate(float elapsedTime) override;
+
 			TerrainLayer& operator=(const TerrainLayer&) = delete;
 			TerrainLayer& operator=(TerrainLayer&&) noexcept = default;
+
+		private:
+			struct EntityPool
+			{
+				std::vector<Ndk::EntityHandle> availableEntities;
+				std::vector<Ndk::EntityHandle> releasedEntities; //< not removed from the world systems yet
+			};
+
+			tsl::hopscotch_map<std::string /*entityClass*/, EntityPool> m_entityPools;
 	};
 }
 
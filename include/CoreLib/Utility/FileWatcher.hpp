@@ -0,0 +1,45 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_FILEWATCHER_HPP
+#define BURGWAR_CORELIB_FILEWATCHER_HPP
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace bw
+{
+	// Recursively watches a folder for modified files (uses inotify on Linux, polls file timestamps elsewhere)
+	class FileWatcher
+	{
+		public:
+			FileWatcher(std::filesystem::path folder);
+			FileWatcher(const FileWatcher&) = delete;
+			FileWatcher(FileWatcher&&) noexcept;
+			~FileWatcher();
+
+			inline const std::filesystem::path& GetFolder() const;
+
+			bool IsValid() const;
+
+			// Appends paths (relative to the watched folder) of files written, created or removed since last call
+			void PollChanges(std::vector<std::filesystem::path>& changedFiles);
+
+			FileWatcher& operator=(const FileWatcher&) = delete;
+			FileWatcher& operator=(FileWatcher&&) noexcept;
+
+		private:
+			struct InternalData;
+
+			std::filesystem::path m_folder;
+			std::unique_ptr<InternalData> m_internalData;
+	};
+}
+
+#include <CoreLib/Utility/FileWatcher.inl>
+
+#endif
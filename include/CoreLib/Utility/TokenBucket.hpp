@@ -0,0 +1,35 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_CORELIB_TOKENBUCKET_HPP
+#define BURGWAR_CORELIB_TOKENBUCKET_HPP
+
+#include <Nazara/Prerequisites.hpp>
+
+namespace bw
+{
+	class TokenBucket
+	{
+		public:
+			inline TokenBucket(float rate, float capacity);
+			~TokenBucket() = default;
+
+			inline bool Consume(Nz::UInt64 now, float cost = 1.f);
+
+			inline float GetCapacity() const;
+			inline float GetRate() const;
+
+		private:
+			float m_capacity;
+			float m_rate; //< tokens per second
+			float m_tokens;
+			Nz::UInt64 m_lastRefillTime; //< ms
+	};
+}
+
+#include <CoreLib/Utility/TokenBucket.inl>
+
+#endif
@@ -0,0 +1,42 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Utility/TokenBucket.hpp>
+#include <algorithm>
+
+namespace bw
+{
+	inline TokenBucket::TokenBucket(float rate, float capacity) :
+	m_capacity(std::max(capacity, 1.f)),
+	m_rate(rate),
+	m_tokens(m_capacity),
+	m_lastRefillTime(0)
+	{
+	}
+
+	inline bool TokenBucket::Consume(Nz::UInt64 now, float cost)
+	{
+		if (now > m_lastRefillTime)
+		{
+			m_tokens = std::min(m_tokens + (now - m_lastRefillTime) * m_rate / 1000.f, m_capacity);
+			m_lastRefillTime = now;
+		}
+
+		if (m_tokens < cost)
+			return false;
+
+		m_tokens -= cost;
+		return true;
+	}
+
+	inline float TokenBucket::GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+	inline float TokenBucket::GetRate() const
+	{
+		return m_rate;
+	}
+}
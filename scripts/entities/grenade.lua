@@ -2,6 +2,7 @@ RegisterClientScript()
 RegisterClientAssets("grenade.png")
 
 ENTITY.IsNetworked = true
+ENTITY.Poolable = true
 ENTITY.PlayerControlled = false
 ENTITY.MaxHealth = 50
 
@@ -2,6 +2,7 @@ RegisterClientScript()
 RegisterClientAssets("placeholder/potato.png")
 
 ENTITY.IsNetworked = true
+ENTITY.Poolable = true
 
 ENTITY.Properties = {}
 
@@ -30,6 +30,10 @@ GM.OnPlayerLeave = utils.OverrideFunction(GM.OnPlayerLeave, function (self, play
 	self.PlayerSeeds[player:GetPlayerIndex()] = nil
 end)
 
+function GM:OnPlayerMapChange(player)
+	self:SpawnPlayer(player)
+end
+
 function GM:OnPlayerSpawn(player)
 	player:GiveWeapon("weapon_sword_emmentalibur")
 	player:GiveWeapon("weapon_patator")
@@ -87,6 +91,12 @@ function GM:OnPlayerChat(player, message)
 			end
 
 			controlledEntity:Kill()
+		elseif (commandName == "map") then
+			if (not player:IsAdmin()) then
+				return
+			end
+
+			match.ChangeMap(commandArgs)
 		elseif (commandName == "noclip") then
 			if (not player:IsAdmin()) then
 				return
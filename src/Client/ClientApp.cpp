@@ -27,6 +27,8 @@ namespace bw
 
 		FillStores();
 
+		m_networkReactors.SimulateNetworkConditions(NetworkConditions::FromConfig(m_config));
+
 		Nz::UInt8 aaLevel = m_config.GetIntegerValue<Nz::UInt8>("WindowSettings.AntialiasingLevel");
 		bool fullscreen = m_config.GetBoolValue("WindowSettings.Fullscreen");
 		bool vsync = m_config.GetBoolValue("WindowSettings.VSync");
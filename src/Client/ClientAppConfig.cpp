@@ -12,6 +12,7 @@ namespace bw
 	{
 		RegisterStringOption("Debug.ShowConnectionData");
 		RegisterBoolOption("Debug.ShowServerGhosts");
+		RegisterIntegerOption("GameSettings.LayerCacheSize", 0, 0xFFFFFFFF, 10'000); //< entities of disabled layers kept around, 0 to disable
 		RegisterStringOption("GameSettings.MapFile");
 		RegisterIntegerOption("WindowSettings.AntialiasingLevel", 0, 16);
 		RegisterBoolOption("WindowSettings.Fullscreen");
@@ -6,6 +6,7 @@
 #include <ClientLib/ClientSession.hpp>
 #include <Client/ClientApp.hpp>
 #include <Client/States/LoginState.hpp>
+#include <Client/States/Game/GameState.hpp>
 #include <Client/States/Game/ScriptDownloadState.hpp>
 
 namespace bw
@@ -13,52 +14,73 @@ namespace bw
 	AssetDownloadState::AssetDownloadState(std::shared_ptr<StateData> stateData, std::shared_ptr<ClientSession> clientSession, Packets::AuthSuccess authSuccess, Packets::MatchData matchData) :
 	StatusState(std::move(stateData)),
 	m_clientSession(std::move(clientSession)),
+	m_assetDirectory(std::make_shared<VirtualDirectory>()),
 	m_authSuccess(std::move(authSuccess)),
 	m_matchData(std::move(matchData))
+	{
+		Initialize(m_matchData.assets);
+	}
+
+	AssetDownloadState::AssetDownloadState(std::shared_ptr<StateData> stateData, std::shared_ptr<ClientSession> clientSession, Packets::AuthSuccess authSuccess, Packets::MatchData matchData, const std::vector<Packets::MatchData::Asset>& changedAssets, std::shared_ptr<VirtualDirectory> assetDirectory, std::shared_ptr<VirtualDirectory> scriptDirectory) :
+	StatusState(std::move(stateData)),
+	m_clientSession(std::move(clientSession)),
+	m_assetDirectory(std::move(assetDirectory)),
+	m_scriptDirectory(std::move(scriptDirectory)),
+	m_authSuccess(std::move(authSuccess)),
+	m_matchData(std::move(matchData))
+	{
+		// Map change: assets the client already has are kept in the directory, only new or changed ones are checked
+		Initialize(changedAssets);
+	}
+
+	void AssetDownloadState::Enter(Ndk::StateMachine& fsm)
+	{
+		StatusState::Enter(fsm);
+
+		m_httpDownloadManager->Start();
+	}
+
+	void AssetDownloadState::Initialize(const std::vector<Packets::MatchData::Asset>& assets)
 	{
 		ClientApp* app = GetStateData().app;
 
 		bwLog(app->GetLogger(), LogLevel::Info, "Downloading assets...");
 
 		auto resourceDirectory = std::make_shared<VirtualDirectory>(app->GetConfig().GetStringValue("Assets.ResourceFolder"));
-		auto targetResourceDirectory = std::make_shared<VirtualDirectory>();
 
-		m_httpDownloadManager.emplace(app->GetLogger(), ".assetCache", std::move(m_matchData.fastDownloadUrls), resourceDirectory);
+		m_httpDownloadManager.emplace(app->GetLogger(), ".assetCache", m_matchData.fastDownloadUrls, resourceDirectory);
 
 		m_httpDownloadManager->OnDownloadStarted.Connect([this](HttpDownloadManager*, const std::string& resourcePath)
 		{
 			UpdateStatus("Downloading " + resourcePath, Nz::Color::White);
 		});
 
-		m_httpDownloadManager->OnFileChecked.Connect([this, targetResourceDirectory](HttpDownloadManager* /*downloadManager*/, const std::string& resourcePath, const std::filesystem::path& realPath)
+		m_httpDownloadManager->OnFileChecked.Connect([this](HttpDownloadManager* /*downloadManager*/, const std::string& resourcePath, const std::filesystem::path& realPath)
 		{
-			targetResourceDirectory->StoreFile(resourcePath, realPath);
+			m_assetDirectory->StoreFile(resourcePath, realPath);
 		});
 
-		m_httpDownloadManager->OnFileCheckedMemory.Connect([this, targetResourceDirectory](HttpDownloadManager* /*downloadManager*/, const std::string& resourcePath, const std::vector<Nz::UInt8>& content)
+		m_httpDownloadManager->OnFileCheckedMemory.Connect([this](HttpDownloadManager* /*downloadManager*/, const std::string& resourcePath, const std::vector<Nz::UInt8>& content)
 		{
-			targetResourceDirectory->StoreFile(resourcePath, content);
+			m_assetDirectory->StoreFile(resourcePath, content);
 		});
 
-		m_httpDownloadManager->OnFinished.Connect([this, targetResourceDirectory](HttpDownloadManager* /*downloadManager*/) mutable
+		m_httpDownloadManager->OnFinished.Connect([this](HttpDownloadManager* /*downloadManager*/)
 		{
 			UpdateStatus("Assets download finished", Nz::Color::White);
 
-			m_nextState = std::make_shared<ScriptDownloadState>(GetStateDataPtr(), m_clientSession, std::move(m_authSuccess), std::move(m_matchData), std::move(targetResourceDirectory));
+			if (m_scriptDirectory)
+				m_nextState = std::make_shared<GameState>(GetStateDataPtr(), m_clientSession, m_authSuccess, m_matchData, m_assetDirectory, m_scriptDirectory);
+			else
+				m_nextState = std::make_shared<ScriptDownloadState>(GetStateDataPtr(), m_clientSession, std::move(m_authSuccess), std::move(m_matchData), m_assetDirectory);
+
 			m_nextStateDelay = 0.5f;
 		});
 
-		for (const auto& asset : m_matchData.assets)
+		for (const auto& asset : assets)
 			m_httpDownloadManager->RegisterFile(asset.path, asset.sha1Checksum, asset.size);
 	}
 
-	void AssetDownloadState::Enter(Ndk::StateMachine& fsm)
-	{
-		StatusState::Enter(fsm);
-
-		m_httpDownloadManager->Start();
-	}
-
 	bool AssetDownloadState::Update(Ndk::StateMachine& fsm, float elapsedTime)
 	{
 		if (!StatusState::Update(fsm, elapsedTime))
@@ -15,20 +15,25 @@
 namespace bw
 {
 	class ClientSession;
+	class VirtualDirectory;
 
 	class AssetDownloadState final : public StatusState
 	{
 		public:
 			AssetDownloadState(std::shared_ptr<StateData> stateData, std::shared_ptr<ClientSession> clientSession, Packets::AuthSuccess authSuccess, Packets::MatchData matchData);
+			AssetDownloadState(std::shared_ptr<StateData> stateData, std::shared_ptr<ClientSession> clientSession, Packets::AuthSuccess authSuccess, Packets::MatchData matchData, const std::vector<Packets::MatchData::Asset>& changedAssets, std::shared_ptr<VirtualDirectory> assetDirectory, std::shared_ptr<VirtualDirectory> scriptDirectory);
 			~AssetDownloadState() = default;
 
 		private:
 			void Enter(Ndk::StateMachine& fsm) override;
+			void Initialize(const std::vector<Packets::MatchData::Asset>& assets);
 			bool Update(Ndk::StateMachine& fsm, float elapsedTime) override;
 
 			std::optional<HttpDownloadManager> m_httpDownloadManager;
 			std::shared_ptr<AbstractState> m_nextState;
 			std::shared_ptr<ClientSession> m_clientSession;
+			std::shared_ptr<VirtualDirectory> m_assetDirectory;
+			std::shared_ptr<VirtualDirectory> m_scriptDirectory; //< set when changing map, scripts are kept
 			Packets::AuthSuccess m_authSuccess;
 			Packets::MatchData m_matchData;
 			float m_nextStateDelay;
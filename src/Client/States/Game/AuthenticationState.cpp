@@ -49,9 +49,11 @@ namespace bw
 	{
 		StatusState::Enter(fsm);
 
-		ConfigFile& playerConfig = GetStateData().app->GetPlayerSettings();
+		ClientApp& app = *GetStateData().app;
+		ConfigFile& playerConfig = app.GetPlayerSettings();
 
 		Packets::Auth authPacket;
+		authPacket.layerCacheSize = app.GetConfig().GetIntegerValue<Nz::UInt32>("GameSettings.LayerCacheSize");
 		authPacket.players.emplace_back().nickname = playerConfig.GetStringValue("Player.Name");
 
 		m_clientSession->SendPacket(std::move(authPacket));
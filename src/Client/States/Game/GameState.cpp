@@ -3,22 +3,31 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Client/States/Game/GameState.hpp>
+#include <CoreLib/Utility/VirtualDirectory.hpp>
 #include <ClientLib/LocalMatch.hpp>
 #include <Client/ClientApp.hpp>
 #include <Client/States/BackgroundState.hpp>
 #include <Client/States/LoginState.hpp>
+#include <Client/States/Game/AssetDownloadState.hpp>
+#include <algorithm>
+#include <cassert>
 
 namespace bw
 {
 	GameState::GameState(std::shared_ptr<StateData> stateDataPtr, std::shared_ptr<ClientSession> clientSession, const Packets::AuthSuccess& authSuccess, const Packets::MatchData& matchData, std::shared_ptr<VirtualDirectory> assetDirectory, std::shared_ptr<VirtualDirectory> scriptDirectory) :
 	AbstractState(std::move(stateDataPtr)),
-	m_clientSession(std::move(clientSession))
+	m_clientSession(std::move(clientSession)),
+	m_assetDirectory(std::move(assetDirectory)),
+	m_scriptDirectory(std::move(scriptDirectory)),
+	m_authSuccess(authSuccess),
+	m_matchData(matchData),
+	m_isScriptDownloadFinished(false)
 	{
 		StateData& stateData = GetStateData();
 
 		m_match = std::make_shared<LocalMatch>(*stateData.app, stateData.window, stateData.window, &stateData.canvas.value(), *m_clientSession, authSuccess, matchData);
-		m_match->LoadAssets(std::move(assetDirectory));
-		m_match->LoadScripts(std::move(scriptDirectory));
+		m_match->LoadAssets(m_assetDirectory);
+		m_match->LoadScripts(m_scriptDirectory);
 
 		if (stateData.app->GetConfig().GetBoolValue("Debug.ShowServerGhosts"))
 			m_match->InitDebugGhosts();
@@ -39,14 +48,154 @@ namespace bw
 			});
 		}
 
+		m_onClientScriptListSlot.Connect(m_clientSession->OnClientScriptList, [this](ClientSession* /*session*/, const Packets::ClientScriptList& scriptList)
+		{
+			HandleClientScriptList(scriptList);
+		});
+
+		m_onMapChangeSlot.Connect(m_clientSession->OnMapChange, [this](ClientSession* /*session*/, const Packets::MapChange& mapChange)
+		{
+			HandleMapChange(mapChange);
+		});
+
 		m_clientSession->SendPacket(Packets::Ready{});
 	}
 
+	void GameState::HandleClientScriptList(const Packets::ClientScriptList& scriptList)
+	{
+		bwLog(GetStateData().app->GetLogger(), LogLevel::Info, "Server changed {0} client script(s)", scriptList.scripts.size());
+
+		for (const auto& script : scriptList.scripts)
+		{
+			// Keep match data up to date in case the match gets rebuilt
+			auto it = std::find_if(m_matchData.scripts.begin(), m_matchData.scripts.end(), [&](const Packets::MatchData::Script& matchScript) { return matchScript.path == script.path; });
+			if (it != m_matchData.scripts.end())
+				it->sha1Checksum = script.sha1Checksum;
+			else
+			{
+				auto& matchScript = m_matchData.scripts.emplace_back();
+				matchScript.path = script.path;
+				matchScript.sha1Checksum = script.sha1Checksum;
+			}
+
+			auto pendingIt = std::find_if(m_pendingScripts.begin(), m_pendingScripts.end(), [&](const Packets::ClientScriptList::Script& pendingScript) { return pendingScript.path == script.path; });
+			if (pendingIt != m_pendingScripts.end())
+				pendingIt->sha1Checksum = script.sha1Checksum;
+			else
+				m_pendingScripts.push_back(script);
+		}
+
+		// Download manager matches responses with its requests in order, only one can run at a time
+		if (!m_scriptDownloadManager)
+			StartScriptDownload();
+	}
+
+	void GameState::HandleMapChange(const Packets::MapChange& mapChange)
+	{
+		bwLog(GetStateData().app->GetLogger(), LogLevel::Info, "Server changed map ({0} new or changed asset(s))", mapChange.assets.size());
+
+		// Scripts are kept, match data only gets the new layers and assets
+		m_matchData.currentTick = mapChange.stateTick;
+		m_matchData.fastDownloadUrls = mapChange.fastDownloadUrls;
+
+		m_matchData.layers.clear();
+		for (const auto& mapLayer : mapChange.layers)
+		{
+			auto& packetLayer = m_matchData.layers.emplace_back();
+			packetLayer.backgroundColor = mapLayer.backgroundColor;
+		}
+
+		std::vector<Packets::MatchData::Asset> changedAssets;
+		for (const auto& mapAsset : mapChange.assets)
+		{
+			auto& asset = changedAssets.emplace_back();
+			asset.path = mapAsset.path;
+			asset.sha1Checksum = mapAsset.sha1Checksum;
+			asset.size = mapAsset.size;
+
+			auto it = std::find_if(m_matchData.assets.begin(), m_matchData.assets.end(), [&](const Packets::MatchData::Asset& matchAsset) { return matchAsset.path == asset.path; });
+			if (it != m_matchData.assets.end())
+				*it = asset;
+			else
+				m_matchData.assets.push_back(asset);
+		}
+
+		// Match is rebuilt by Update, outside of network handling
+		m_changedAssets = std::move(changedAssets);
+	}
+
+	void GameState::StartScriptDownload()
+	{
+		assert(!m_scriptDownloadManager);
+
+		m_downloadedScripts.clear();
+		m_isScriptDownloadFinished = false;
+
+		m_scriptDownloadManager.emplace(".scriptCache", m_clientSession);
+
+		m_scriptDownloadManager->OnFileChecked.Connect([this](ClientScriptDownloadManager* /*downloadManager*/, const std::string& filePath, const std::vector<Nz::UInt8>& fileContent)
+		{
+			m_scriptDirectory->StoreFile(filePath, fileContent);
+		});
+
+		m_scriptDownloadManager->OnDownloadRequest.Connect([this](ClientScriptDownloadManager* /*downloadManager*/, const Packets::DownloadClientScriptRequest& request)
+		{
+			m_clientSession->SendPacket(request);
+		});
+
+		m_scriptDownloadManager->OnFinished.Connect([this](ClientScriptDownloadManager* /*downloadManager*/)
+		{
+			// Manager cannot be destroyed from its own signal, Update takes care of it
+			m_isScriptDownloadFinished = true;
+		});
+
+		for (const auto& script : m_pendingScripts)
+		{
+			m_scriptDownloadManager->RegisterFile(script.path, script.sha1Checksum);
+			m_downloadedScripts.push_back(script.path);
+		}
+		m_pendingScripts.clear();
+
+		m_scriptDownloadManager->Start();
+	}
+
 	bool GameState::Update(Ndk::StateMachine& fsm, float elapsedTime)
 	{
 		if (!AbstractState::Update(fsm, elapsedTime))
 			return false;
 
+		if (m_scriptDownloadManager)
+		{
+			m_scriptDownloadManager->Update();
+
+			if (m_isScriptDownloadFinished)
+			{
+				m_scriptDownloadManager.reset();
+
+				// Next match loads every script anyway
+				if (!m_changedAssets)
+					m_match->ReloadScripts(m_scriptDirectory, m_downloadedScripts);
+
+				if (!m_pendingScripts.empty())
+					StartScriptDownload();
+			}
+		}
+
+		// Wait for scripts to be up to date before rebuilding the match
+		if (m_changedAssets && !m_scriptDownloadManager)
+		{
+			// Previous match has to be destroyed before the next one is created
+			m_match.reset();
+
+			if (m_changedAssets->empty())
+				m_nextState = std::make_shared<GameState>(GetStateDataPtr(), m_clientSession, m_authSuccess, m_matchData, m_assetDirectory, m_scriptDirectory);
+			else
+				m_nextState = std::make_shared<AssetDownloadState>(GetStateDataPtr(), m_clientSession, m_authSuccess, m_matchData, *m_changedAssets, m_assetDirectory, m_scriptDirectory);
+
+			fsm.ChangeState(m_nextState);
+			return true;
+		}
+
 		if (!m_match->Update(elapsedTime))
 		{
 			fsm.ResetState(std::make_shared<BackgroundState>(GetStateDataPtr()));
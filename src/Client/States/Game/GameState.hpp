@@ -9,9 +9,13 @@
 
 #include <CoreLib/Protocol/Packets.hpp>
 #include <Client/States/AbstractState.hpp>
+#include <ClientLib/ClientScriptDownloadManager.hpp>
 #include <ClientLib/ClientSession.hpp>
 #include <Nazara/Audio/Music.hpp>
 #include <Nazara/Core/Signal.hpp>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace bw
 {
@@ -27,13 +31,28 @@ namespace bw
 			inline const std::shared_ptr<LocalMatch>& GetMatch();
 
 		private:
+			void HandleClientScriptList(const Packets::ClientScriptList& scriptList);
+			void HandleMapChange(const Packets::MapChange& mapChange);
+			void StartScriptDownload();
 			bool Update(Ndk::StateMachine& fsm, float elapsedTime) override;
 
+			std::optional<std::vector<Packets::MatchData::Asset>> m_changedAssets; //< set when the server changed map
+			std::optional<ClientScriptDownloadManager> m_scriptDownloadManager;
 			std::shared_ptr<AbstractState> m_nextState;
 			std::shared_ptr<ClientSession> m_clientSession;
 			std::shared_ptr<LocalMatch> m_match;
+			std::shared_ptr<VirtualDirectory> m_assetDirectory;
+			std::shared_ptr<VirtualDirectory> m_scriptDirectory;
+			std::vector<Packets::ClientScriptList::Script> m_pendingScripts; //< changed while another download was running
+			std::vector<std::string> m_downloadedScripts;
 			Nz::Music m_music;
+			Packets::AuthSuccess m_authSuccess;
+			Packets::MatchData m_matchData;
 			typename Nz::Signal<long long>::ConnectionGuard m_musicVolumeUpdateSlot;
+			bool m_isScriptDownloadFinished;
+
+			NazaraSlot(ClientSession, OnClientScriptList, m_onClientScriptListSlot);
+			NazaraSlot(ClientSession, OnMapChange, m_onMapChangeSlot);
 	};
 }
 
@@ -62,6 +62,8 @@ namespace bw
 		if (!StatusState::Update(fsm, elapsedTime))
 			return false;
 
+		m_downloadManager->Update();
+
 		if (m_nextState)
 		{
 			if ((m_nextStateDelay -= elapsedTime) < 0.f)
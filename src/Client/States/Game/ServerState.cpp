@@ -22,9 +22,16 @@ namespace bw
 		m_match.emplace(app, "local", "gamemodes/test", std::move(map), 64, 1.f / tickRate);
 
 		MatchSessions& sessions = m_match->GetSessions();
+		NetworkConditions simulatedConditions = NetworkConditions::FromConfig(config);
+
 		m_localSessionManager = sessions.CreateSessionManager<LocalSessionManager>();
+		m_localSessionManager->SimulateNetworkConditions(simulatedConditions);
+
 		if (listenPort != 0)
+		{
 			m_networkSessionManager = sessions.CreateSessionManager<NetworkSessionManager>(listenPort, 64);
+			m_networkSessionManager->SimulateNetworkConditions(simulatedConditions);
+		}
 		else
 			m_networkSessionManager = nullptr;
 
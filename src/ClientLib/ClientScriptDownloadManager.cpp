@@ -3,12 +3,54 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <ClientLib/ClientScriptDownloadManager.hpp>
+#include <Nazara/Core/AbstractHash.hpp>
 #include <Nazara/Core/File.hpp>
+#include <nlohmann/json.hpp>
+#include <cassert>
+#include <cstring>
+#include <fstream>
 
 namespace bw
 {
+	namespace
+	{
+		const char* CacheIndexFilename = "index.json";
+
+		bool ReadFileContent(const std::filesystem::path& filePath, std::vector<Nz::UInt8>& content)
+		{
+			Nz::File file(filePath.generic_u8string());
+			if (!file.Open(Nz::OpenMode_ReadOnly))
+				return false;
+
+			content.resize(file.GetSize());
+			return file.Read(content.data(), content.size()) == content.size();
+		}
+	}
+
+	ClientScriptDownloadManager::ClientScriptDownloadManager(std::filesystem::path clientFileCache, std::shared_ptr<ClientSession> clientSession) :
+	m_cancelValidation(false),
+	m_isValidationDone(false),
+	m_clientFileCache(std::move(clientFileCache)),
+	m_clientSession(std::move(clientSession)),
+	m_nextRequestIndex(0),
+	m_nextResponseIndex(0),
+	m_isStarted(false)
+	{
+	}
+
+	ClientScriptDownloadManager::~ClientScriptDownloadManager()
+	{
+		if (m_validationThread.IsJoinable())
+		{
+			m_cancelValidation.store(true, std::memory_order_relaxed);
+			m_validationThread.Join();
+		}
+	}
+
 	void ClientScriptDownloadManager::RegisterFile(const std::string& filePath, const std::array<Nz::UInt8, 20>& checksum)
 	{
+		assert(!m_isStarted);
+
 		Nz::ByteArray nzchecksum;
 		nzchecksum.Assign(checksum.begin(), checksum.end());
 
@@ -17,45 +59,56 @@ namespace bw
 		std::filesystem::path clientFilePath = m_clientFileCache / filePath;
 		clientFilePath.concat("." + hexChecksum);
 
-		bool shouldDownload = false;
-		if (std::filesystem::is_regular_file(clientFilePath))
+		RegisteredFile& registeredFile = m_files.emplace_back();
+		registeredFile.checksum = checksum;
+		registeredFile.downloadPath = filePath;
+		registeredFile.outputPath = std::move(clientFilePath);
+	}
+
+	void ClientScriptDownloadManager::Start()
+	{
+		m_isStarted = true;
+
+		m_onDownloadResponseSlot.Connect(m_clientSession->OnDownloadClientScriptResponse, [this](ClientSession*, const Packets::DownloadClientScriptResponse& packet)
 		{
-			// Check file against checksum (in case the user changed it)
-			Nz::ByteArray fileChecksum;
-			std::vector<Nz::UInt8> content;
+			HandlePacket(packet);
+		});
+
+		LoadCacheIndex();
+
+		// Cached files are read (and hashed if they changed since we wrote them) off the main thread
+		m_validationThread = Nz::Thread(&ClientScriptDownloadManager::ValidateCache, this);
+		m_validationThread.SetName("ScriptCacheValidation");
+	}
 
-			Nz::File file(clientFilePath.generic_u8string());
-			if (file.Open(Nz::OpenMode_ReadOnly))
+	void ClientScriptDownloadManager::Update()
+	{
+		if (!m_isStarted || !m_validationThread.IsJoinable() || !m_isValidationDone.load(std::memory_order_acquire))
+			return;
+
+		m_validationThread.Join();
+
+		for (std::size_t i = 0; i < m_files.size(); ++i)
+		{
+			RegisteredFile& file = m_files[i];
+			if (file.isValid)
 			{
-				content.resize(file.GetSize());
-				if (file.Read(content.data(), content.size()) == content.size())
-				{
-					auto hash = Nz::AbstractHash::Get(Nz::HashType_SHA1);
-					hash->Begin();
-					hash->Append(content.data(), content.size());
-					fileChecksum = hash->End();
-				}
+				OnFileChecked(this, file.downloadPath, file.content);
+				file.content.clear();
+				file.content.shrink_to_fit();
 			}
-
-			if (fileChecksum.size() != checksum.size() || std::memcmp(fileChecksum.GetConstBuffer(), checksum.data(), fileChecksum.GetSize() != 0))
-				shouldDownload = true;
 			else
-				OnFileChecked(this, filePath, content);
+				m_downloadList.push_back(i);
 		}
-		else
-			shouldDownload = true;
 
-		if (shouldDownload)
-		{
-			PendingFile& pendingFile = m_downloadList.emplace_back();
-			pendingFile.downloadPath = filePath;
-			pendingFile.outputPath = std::move(clientFilePath);
-		}
+		RequestFiles();
 	}
 
 	void ClientScriptDownloadManager::HandlePacket(const Packets::DownloadClientScriptResponse& packet)
 	{
-		PendingFile& pendingFileData = m_downloadList[m_currentFileIndex];
+		// Requests are sent and answered in order on a reliable channel
+		assert(m_nextResponseIndex < m_nextRequestIndex);
+		RegisteredFile& pendingFileData = m_files[m_downloadList[m_nextResponseIndex]];
 
 		std::filesystem::path clientFolderPath = pendingFileData.outputPath.parent_path();
 		std::string filePath = pendingFileData.outputPath.generic_u8string();
@@ -73,32 +126,141 @@ namespace bw
 		outputFile.Write(packet.fileContent.data(), packet.fileContent.size());
 		outputFile.Close();
 
+		UpdateCacheIndex(pendingFileData.outputPath);
+
 		OnFileChecked(this, pendingFileData.downloadPath, packet.fileContent);
 
-		m_currentFileIndex++;
-		RequestNextFile();
+		m_nextResponseIndex++;
+		RequestFiles();
 	}
 
-	void ClientScriptDownloadManager::Start()
+	void ClientScriptDownloadManager::LoadCacheIndex()
 	{
-		m_onDownloadResponseSlot.Connect(m_clientSession->OnDownloadClientScriptResponse, [this](ClientSession*, const Packets::DownloadClientScriptResponse& packet)
-		{
-			HandlePacket(packet);
-		});
+		m_cacheIndex.clear();
 
-		RequestNextFile();
+		std::ifstream indexFile(m_clientFileCache / CacheIndexFilename);
+		if (!indexFile)
+			return;
+
+		try
+		{
+			nlohmann::json indexDoc = nlohmann::json::parse(indexFile);
+			for (auto&& [cachedPath, entry] : indexDoc.items())
+			{
+				CacheEntry& cacheEntry = m_cacheIndex[cachedPath];
+				cacheEntry.lastWriteTime = entry.at("lastWriteTime");
+				cacheEntry.size = entry.at("size");
+			}
+		}
+		catch (const std::exception&)
+		{
+			// Corrupted index, every cached file will be checked against its checksum
+			m_cacheIndex.clear();
+		}
 	}
 
-	void ClientScriptDownloadManager::RequestNextFile()
+	void ClientScriptDownloadManager::RequestFiles()
 	{
-		if (m_currentFileIndex >= m_downloadList.size())
+		if (m_nextResponseIndex >= m_downloadList.size())
+		{
+			SaveCacheIndex();
 			OnFinished(this);
-		else
+			return;
+		}
+
+		// Keep multiple requests in flight to avoid paying a round-trip per file
+		while (m_nextRequestIndex < m_downloadList.size() && m_nextRequestIndex - m_nextResponseIndex < MaxPendingRequests)
 		{
 			Packets::DownloadClientScriptRequest requestPacket;
-			requestPacket.path = m_downloadList[m_currentFileIndex].downloadPath;
+			requestPacket.path = m_files[m_downloadList[m_nextRequestIndex]].downloadPath;
 
 			OnDownloadRequest(this, requestPacket);
+
+			m_nextRequestIndex++;
 		}
 	}
+
+	void ClientScriptDownloadManager::SaveCacheIndex()
+	{
+		nlohmann::json indexDoc = nlohmann::json::object();
+		for (auto&& [cachedPath, cacheEntry] : m_cacheIndex)
+		{
+			indexDoc[cachedPath] = nlohmann::json{
+				{ "lastWriteTime", cacheEntry.lastWriteTime },
+				{ "size", cacheEntry.size }
+			};
+		}
+
+		std::error_code ec;
+		std::filesystem::create_directories(m_clientFileCache, ec);
+
+		std::ofstream indexFile(m_clientFileCache / CacheIndexFilename, std::ios::trunc);
+		indexFile << indexDoc;
+	}
+
+	void ClientScriptDownloadManager::UpdateCacheIndex(const std::filesystem::path& cachedFilePath)
+	{
+		std::error_code ec;
+		std::uintmax_t fileSize = std::filesystem::file_size(cachedFilePath, ec);
+		if (ec)
+			return;
+
+		std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(cachedFilePath, ec);
+		if (ec)
+			return;
+
+		CacheEntry& cacheEntry = m_cacheIndex[std::filesystem::relative(cachedFilePath, m_clientFileCache).generic_u8string()];
+		cacheEntry.lastWriteTime = static_cast<Nz::Int64>(lastWriteTime.time_since_epoch().count());
+		cacheEntry.size = static_cast<Nz::UInt64>(fileSize);
+	}
+
+	void ClientScriptDownloadManager::ValidateCache()
+	{
+		// Runs on the validation thread, main thread doesn't touch files or the cache index until m_isValidationDone is set
+		for (RegisteredFile& file : m_files)
+		{
+			if (m_cancelValidation.load(std::memory_order_relaxed))
+				break;
+
+			std::error_code ec;
+			std::uintmax_t fileSize = std::filesystem::file_size(file.outputPath, ec);
+			if (ec)
+				continue;
+
+			std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(file.outputPath, ec);
+			if (ec)
+				continue;
+
+			if (!ReadFileContent(file.outputPath, file.content))
+				continue;
+
+			// Files which did not change since we wrote (or checked) them don't need to be hashed again
+			std::string cachedPath = std::filesystem::relative(file.outputPath, m_clientFileCache).generic_u8string();
+			if (auto it = m_cacheIndex.find(cachedPath); it != m_cacheIndex.end())
+			{
+				const CacheEntry& cacheEntry = it->second;
+				if (cacheEntry.size == fileSize && cacheEntry.lastWriteTime == static_cast<Nz::Int64>(lastWriteTime.time_since_epoch().count()))
+				{
+					file.isValid = true;
+					continue;
+				}
+			}
+
+			// Check file against checksum (in case the user changed it)
+			auto hash = Nz::AbstractHash::Get(Nz::HashType_SHA1);
+			hash->Begin();
+			hash->Append(file.content.data(), file.content.size());
+			Nz::ByteArray fileChecksum = hash->End();
+
+			if (fileChecksum.GetSize() == file.checksum.size() && std::memcmp(fileChecksum.GetConstBuffer(), file.checksum.data(), file.checksum.size()) == 0)
+			{
+				file.isValid = true;
+				UpdateCacheIndex(file.outputPath);
+			}
+			else
+				file.content.clear();
+		}
+
+		m_isValidationDone.store(true, std::memory_order_release);
+	}
 }
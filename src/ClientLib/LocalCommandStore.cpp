@@ -33,9 +33,12 @@ namespace bw
 		IncomingCommand(EntitiesAnimation);
 		IncomingCommand(EntitiesDeath);
 		IncomingCommand(EntitiesInputs);
+		IncomingCommand(EntitiesLayerChange);
+		IncomingCommand(EntitiesPropertyUpdate);
 		IncomingCommand(EntityWeapon);
 		IncomingCommand(HealthUpdate);
 		IncomingCommand(InputTimingCorrection);
+		IncomingCommand(MapChange);
 		IncomingCommand(MatchData);
 		IncomingCommand(MatchState);
 		IncomingCommand(NetworkStrings);
@@ -6,16 +6,45 @@
 #include <ClientLib/ClientSession.hpp>
 #include <ClientLib/LocalMatch.hpp>
 #include <ClientLib/Components/LayerEntityComponent.hpp>
+#include <ClientLib/Components/VisualInterpolationComponent.hpp>
 #include <ClientLib/Systems/FrameCallbackSystem.hpp>
 #include <ClientLib/Systems/PostFrameCallbackSystem.hpp>
 #include <ClientLib/Systems/VisualInterpolationSystem.hpp>
 #include <ClientLib/Scripting/ClientEntityStore.hpp>
 #include <ClientLib/Scripting/ClientWeaponStore.hpp>
+#include <CoreLib/Components/ScriptComponent.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <NDK/Systems/LifetimeSystem.hpp>
+#include <algorithm>
+#include <functional>
 
 namespace bw
 {
+	namespace
+	{
+		EntityProperty TranslatePropertyValue(const Packets::Helper::Properties::PropertyValue& propertyValue, bool isArray)
+		{
+			return std::visit([&](auto&& value) -> EntityProperty
+			{
+				using T = std::decay_t<decltype(value)>;
+				using StoredType = typename T::value_type;
+
+				if (isArray)
+				{
+					EntityPropertyArray<StoredType> elements(value.size());
+					for (std::size_t i = 0; i < value.size(); ++i)
+						elements[i] = value[i];
+
+					return elements;
+				}
+				else
+					return value.front();
+
+			}, propertyValue);
+		}
+	}
+
 	LocalLayer::LocalLayer(LocalMatch& match, LayerIndex layerIndex, const Nz::Color& backgroundColor) :
 	SharedLayer(match, layerIndex),
 	m_backgroundColor(backgroundColor),
@@ -38,6 +67,7 @@ namespace bw
 	SharedLayer(std::move(layer)),
 	m_clientEntities(std::move(layer.m_clientEntities)),
 	m_serverEntities(std::move(layer.m_serverEntities)),
+	m_pendingEntities(std::move(layer.m_pendingEntities)),
 	m_backgroundColor(layer.m_backgroundColor),
 	m_isEnabled(layer.m_isEnabled),
 	m_isPredictionEnabled(layer.m_isPredictionEnabled)
@@ -58,26 +88,41 @@ namespace bw
 		}
 	}
 
-	void LocalLayer::Enable(bool enable)
+	void LocalLayer::Disable(bool keepServerEntities)
 	{
-		if (m_isEnabled == enable)
-			return;
-
-		m_isEnabled = enable;
-
-		if (enable)
-		{
-			OnEnabled(this);
-		}
-		else
+		if (m_isEnabled)
 		{
+			m_isEnabled = false;
+
 			OnDisabled(this);
 			m_clientEntities.clear();
-			m_serverEntities.clear();
+		}
+		else if (m_serverEntities.empty() && m_pendingEntities.empty())
+			return;
 
-			// Since we are disabled, refresh won't be called until we are enabled, refresh the world now to kill entities
-			GetWorld().Refresh();
+		// Server entities may be kept dormant (no update, no visual) until the layer is enabled again, sparing their recreation
+		// Entities which weren't instantiated yet are kept as well, the server considers we have them
+		if (!keepServerEntities)
+		{
+			m_pendingEntities.clear();
+			m_serverEntities.clear();
 		}
+
+		// Since we are disabled, refresh won't be called until we are enabled, refresh the world now to kill entities
+		GetWorld().Refresh();
+	}
+
+	void LocalLayer::Enable(bool enable)
+	{
+		if (!enable)
+			return Disable();
+
+		if (m_isEnabled)
+			return;
+
+		m_isEnabled = true;
+
+		OnEnabled(this);
 	}
 
 	LocalMatch& LocalLayer::GetLocalMatch()
@@ -85,6 +130,38 @@ namespace bw
 		return static_cast<LocalMatch&>(SharedLayer::GetMatch());
 	}
 
+	void LocalLayer::InstantiatePendingEntities(const Nz::Vector2f& focusPosition, Nz::UInt64 deadline)
+	{
+		assert(m_isEnabled);
+
+		if (m_pendingEntities.empty())
+			return;
+
+		// Closest entities to what the player is looking at are instantiated first
+		m_pendingEntityOrder.clear();
+		for (auto it = m_pendingEntities.begin(); it != m_pendingEntities.end(); ++it)
+			m_pendingEntityOrder.emplace_back((it->second.position - focusPosition).GetSquaredLength(), it->first);
+
+		// Only the entities fitting in the budget are ordered, a min-heap avoids sorting every pending entity each frame
+		auto closestFirst = std::greater<std::pair<float, Nz::UInt32>>();
+		std::make_heap(m_pendingEntityOrder.begin(), m_pendingEntityOrder.end(), closestFirst);
+
+		// At least one entity is instantiated per call so creation keeps progressing even when frames are over budget
+		auto heapEnd = m_pendingEntityOrder.end();
+		while (heapEnd != m_pendingEntityOrder.begin())
+		{
+			std::pop_heap(m_pendingEntityOrder.begin(), heapEnd, closestFirst);
+			--heapEnd;
+
+			InstantiatePendingEntity(heapEnd->second); //< may already have been instantiated as a parent
+
+			if (Nz::GetElapsedMicroseconds() >= deadline)
+				break;
+		}
+
+		m_pendingEntityOrder.clear();
+	}
+
 	void LocalLayer::FrameUpdate(float elapsedTime)
 	{
 		Ndk::World& world = GetWorld();
@@ -243,23 +320,7 @@ namespace bw
 		{
 			const std::string& propertyName = networkStringStore.GetString(property.name);
 
-			std::visit([&](auto&& value)
-			{
-				using T = std::decay_t<decltype(value)>;
-				using StoredType = typename T::value_type;
-
-				if (property.isArray)
-				{
-					EntityPropertyArray<StoredType> elements(value.size());
-					for (std::size_t i = 0; i < value.size(); ++i)
-						elements[i] = value[i];
-
-					properties.emplace(propertyName, std::move(elements));
-				}
-				else
-					properties.emplace(propertyName, value.front());
-
-			}, property.value);
+			properties.emplace(propertyName, TranslatePropertyValue(property.value, property.isArray));
 		}
 
 		const LocalLayerEntity* parent = nullptr;
@@ -366,17 +427,13 @@ namespace bw
 		m_serverEntities.erase(it);
 	}
 
-	void LocalLayer::HandlePacket(const Packets::CreateEntities::Entity* entities, std::size_t entityCount)
+	void LocalLayer::HandlePacket(Packets::CreateEntities::Entity* entities, std::size_t entityCount)
 	{
 		assert(m_isEnabled);
 
+		// Entities are instantiated over the next frames by InstantiatePendingEntities, or as soon as a packet needs them
 		for (std::size_t i = 0; i < entityCount; ++i)
-		{
-			Nz::UInt32 entityId = entities[i].id;
-			auto& entityData = entities[i].data;
-
-			CreateEntity(entityId, entityData);
-		}
+			m_pendingEntities.insert_or_assign(entities[i].id, std::move(entities[i].data));
 	}
 
 	void LocalLayer::HandlePacket(const Packets::DeleteEntities::Entity* entities, std::size_t entityCount)
@@ -387,6 +444,9 @@ namespace bw
 		{
 			Nz::UInt32 entityId = entities[i].id;
 
+			if (m_pendingEntities.erase(entityId) > 0)
+				continue;
+
 			auto it = m_serverEntities.find(entityId);
 			if (it == m_serverEntities.end())
 				continue;
@@ -397,17 +457,12 @@ namespace bw
 		}
 	}
 
-	void LocalLayer::HandlePacket(const Packets::EnableLayer::Entity* entities, std::size_t entityCount)
+	void LocalLayer::HandlePacket(Packets::EnableLayer::Entity* entities, std::size_t entityCount)
 	{
 		assert(m_isEnabled);
 
 		for (std::size_t i = 0; i < entityCount; ++i)
-		{
-			Nz::UInt32 entityId = entities[i].id;
-			auto& entityData = entities[i].data;
-
-			CreateEntity(entityId, entityData);
-		}
+			m_pendingEntities.insert_or_assign(entities[i].id, std::move(entities[i].data));
 	}
 
 	void LocalLayer::HandlePacket(const Packets::EntitiesAnimation::Entity* entities, std::size_t entityCount)
@@ -419,6 +474,8 @@ namespace bw
 			Nz::UInt32 entityId = entities[i].entityId;
 			Nz::UInt8 animationId = entities[i].animId;
 
+			InstantiatePendingEntity(entityId);
+
 			auto it = m_serverEntities.find(entityId);
 			if (it == m_serverEntities.end())
 				continue;
@@ -436,6 +493,10 @@ namespace bw
 		{
 			Nz::UInt32 entityId = entities[i].id;
 
+			// Entity died before it was instantiated, no need to do it now
+			if (m_pendingEntities.erase(entityId) > 0)
+				continue;
+
 			auto it = m_serverEntities.find(entityId);
 			if (it == m_serverEntities.end())
 				continue;
@@ -461,6 +522,8 @@ namespace bw
 			Nz::UInt32 entityId = entities[i].id;
 			const auto& inputs = entities[i].inputs;
 
+			InstantiatePendingEntity(entityId);
+
 			auto it = m_serverEntities.find(entityId);
 			if (it == m_serverEntities.end())
 				continue;
@@ -470,6 +533,72 @@ namespace bw
 		}
 	}
 
+	void LocalLayer::HandlePacket(const Packets::EntitiesLayerChange::Entity* entities, std::size_t entityCount, LocalLayer& newLayer)
+	{
+		assert(m_isEnabled);
+		assert(newLayer.IsEnabled());
+
+		for (std::size_t i = 0; i < entityCount; ++i)
+		{
+			Nz::UInt32 entityId = entities[i].id;
+
+			InstantiatePendingEntity(entityId);
+
+			auto it = m_serverEntities.find(entityId);
+			if (it == m_serverEntities.end())
+				continue;
+
+			OnEntityDelete(this, it.value().layerEntity);
+
+			// Entity data has to be erased before the entity is moved, as its destruction slot would fire otherwise
+			LocalLayerEntity layerEntity = std::move(it.value().layerEntity);
+			m_serverEntities.erase(it);
+
+			layerEntity.MoveToLayer(newLayer, entities[i].newEntityId);
+			newLayer.RegisterEntity(std::move(layerEntity));
+		}
+	}
+
+	void LocalLayer::HandlePacket(const Packets::EntitiesPropertyUpdate::Entity* entities, std::size_t entityCount)
+	{
+		assert(m_isEnabled);
+
+		for (std::size_t i = 0; i < entityCount; ++i)
+		{
+			auto& entityData = entities[i];
+
+			// Properties are indexed by the element, which is only known once the entity is instantiated
+			InstantiatePendingEntity(entityData.id);
+
+			auto it = m_serverEntities.find(entityData.id);
+			if (it == m_serverEntities.end())
+				continue;
+
+			LocalLayerEntity& localEntity = it.value().layerEntity;
+
+			const Ndk::EntityHandle& entity = localEntity.GetEntity();
+			if (!entity->HasComponent<ScriptComponent>())
+			{
+				bwLog(GetMatch().GetLogger(), LogLevel::Error, "Received property update for entity {} which is not scripted", localEntity.GetUniqueId());
+				continue;
+			}
+
+			auto& entityScript = entity->GetComponent<ScriptComponent>();
+			std::size_t propertyCount = entityScript.GetElement()->properties.size();
+
+			for (const auto& property : entityData.properties)
+			{
+				if (property.index >= propertyCount)
+				{
+					bwLog(GetMatch().GetLogger(), LogLevel::Error, "Received out-of-range property index {} for entity {}", property.index, localEntity.GetUniqueId());
+					continue;
+				}
+
+				entityScript.SetProperty(property.index, TranslatePropertyValue(property.value, property.isArray));
+			}
+		}
+	}
+
 	void LocalLayer::HandlePacket(const Packets::HealthUpdate::Entity* entities, std::size_t entityCount)
 	{
 		assert(m_isEnabled);
@@ -479,6 +608,15 @@ namespace bw
 			Nz::UInt32 entityId = entities[i].id;
 			Nz::UInt16 currentHealth = entities[i].currentHealth;
 
+			if (auto pendingIt = m_pendingEntities.find(entityId); pendingIt != m_pendingEntities.end())
+			{
+				auto& pendingHealth = pendingIt.value().health;
+				if (pendingHealth)
+					pendingHealth->currentHealth = currentHealth;
+
+				continue;
+			}
+
 			auto it = m_serverEntities.find(entityId);
 			if (it == m_serverEntities.end())
 				continue;
@@ -495,10 +633,21 @@ namespace bw
 	{
 		assert(m_isEnabled);
 
+		double snapshotTime = GetWorld().GetSystem<VisualInterpolationSystem>().RegisterSnapshot();
+
 		for (std::size_t i = 0; i < entityCount; ++i)
 		{
 			auto& entityData = entities[i];
 
+			// Moving entities keep their latest state until they get instantiated
+			if (auto pendingIt = m_pendingEntities.find(entityData.id); pendingIt != m_pendingEntities.end())
+			{
+				auto& pendingData = pendingIt.value();
+				pendingData.position = entityData.position;
+				pendingData.rotation = entityData.rotation;
+				continue;
+			}
+
 			auto it = m_serverEntities.find(entityData.id);
 			if (it == m_serverEntities.end())
 				continue;
@@ -510,6 +659,14 @@ namespace bw
 				{
 					auto& physData = entityData.physicsProperties.value();
 					localEntity.UpdateState(entityData.position, entityData.rotation, physData.linearVelocity, physData.angularVelocity);
+
+					const Ndk::EntityHandle& entity = localEntity.GetEntity();
+					if (entity->HasComponent<VisualInterpolationComponent>())
+					{
+						auto& entityLerp = entity->GetComponent<VisualInterpolationComponent>();
+						if (entityLerp.IsSnapshotInterpolationEnabled())
+							entityLerp.PushSnapshot(snapshotTime, entityData.position, entityData.rotation, physData.linearVelocity, physData.angularVelocity);
+					}
 				}
 				else
 				{
@@ -529,4 +686,36 @@ namespace bw
 				localEntity.UpdatePlayerMovement(entityData.playerMovement->isFacingRight);
 		}
 	}
+
+	bool LocalLayer::InstantiatePendingEntity(Nz::UInt32 serverId)
+	{
+		auto it = m_pendingEntities.find(serverId);
+		if (it == m_pendingEntities.end())
+			return false;
+
+		Packets::Helper::EntityData entityData = std::move(it.value());
+		m_pendingEntities.erase(it);
+
+		// Parents have to exist before their children
+		if (entityData.parentId)
+			InstantiatePendingEntity(entityData.parentId.value());
+
+		CreateEntity(serverId, entityData);
+		return true;
+	}
+
+	void LocalLayer::RemoveDormantEntity(Nz::UInt32 serverId)
+	{
+		assert(!m_isEnabled);
+
+		if (m_pendingEntities.erase(serverId) > 0)
+			return;
+
+		auto it = m_serverEntities.find(serverId);
+		if (it == m_serverEntities.end())
+			return;
+
+		OnEntityDelete(this, it.value().layerEntity);
+		m_serverEntities.erase(it);
+	}
 }
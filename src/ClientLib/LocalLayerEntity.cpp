@@ -21,10 +21,10 @@ namespace bw
 	m_entity(entity),
 	m_uniqueId(uniqueId),
 	m_serverEntityId(serverEntityId),
-	m_layer(layer)
+	m_layer(&layer)
 	{
 		assert(m_entity);
-		m_layer.GetLocalMatch().RegisterEntity(m_uniqueId, CreateHandle());
+		m_layer->GetLocalMatch().RegisterEntity(m_uniqueId, CreateHandle());
 	}
 
 	LocalLayerEntity::LocalLayerEntity(LocalLayerEntity&& entity) noexcept :
@@ -47,10 +47,10 @@ namespace bw
 	LocalLayerEntity::~LocalLayerEntity()
 	{
 		if (m_ghostEntity)
-			m_layer.OnEntityDelete(&m_layer, *m_ghostEntity);
+			m_layer->OnEntityDelete(m_layer, *m_ghostEntity);
 
 		if (m_uniqueId != NoEntity)
-			m_layer.GetLocalMatch().UnregisterEntity(m_uniqueId);
+			m_layer->GetLocalMatch().UnregisterEntity(m_uniqueId);
 	}
 
 	void LocalLayerEntity::AttachRenderable(Nz::InstancedRenderableRef renderable, const Nz::Matrix4f& offsetMatrix, int renderOrder)
@@ -93,7 +93,7 @@ namespace bw
 			const Ndk::EntityHandle& ghostEntity = m_entity->GetWorld()->CreateEntity();
 			ghostEntity->AddComponent<Ndk::NodeComponent>();
 
-			m_ghostEntity = std::make_unique<LocalLayerEntity>(m_layer, ghostEntity, ClientsideId, m_layer.GetLocalMatch().AllocateClientUniqueId());
+			m_ghostEntity = std::make_unique<LocalLayerEntity>(*m_layer, ghostEntity, ClientsideId, m_layer->GetLocalMatch().AllocateClientUniqueId());
 
 			for (auto& renderable : m_attachedRenderables)
 			{
@@ -114,7 +114,7 @@ namespace bw
 				}
 			}
 
-			m_layer.OnEntityCreated(&m_layer, *m_ghostEntity);
+			m_layer->OnEntityCreated(m_layer, *m_ghostEntity);
 		}
 
 		return m_ghostEntity.get();
@@ -122,7 +122,7 @@ namespace bw
 
 	LayerIndex LocalLayerEntity::GetLayerIndex() const
 	{
-		return m_layer.GetLayerIndex();
+		return m_layer->GetLayerIndex();
 	}
 
 	Nz::Vector2f LocalLayerEntity::GetPosition() const
@@ -201,6 +201,23 @@ namespace bw
 		return m_entity->HasComponent<Ndk::PhysicsComponent2D>(); //< TODO: Cache this?
 	}
 
+	void LocalLayerEntity::MoveToLayer(LocalLayer& layer, Nz::UInt32 serverEntityId)
+	{
+		// Ghost lives in the previous layer world, it will be recreated on demand
+		if (m_ghostEntity)
+		{
+			m_layer->OnEntityDelete(m_layer, *m_ghostEntity);
+			m_ghostEntity.reset();
+		}
+
+		// Components are moved to an entity of the new world, the emptied one is killed by the owner
+		Ndk::Entity* newEntity = layer.MigrateEntity(m_entity);
+		m_entity = newEntity;
+
+		m_layer = &layer;
+		m_serverEntityId = serverEntityId;
+	}
+
 	void LocalLayerEntity::SyncVisuals()
 	{
 		auto& entityNode = m_entity->GetComponent<Ndk::NodeComponent>();
@@ -216,7 +233,7 @@ namespace bw
 	void LocalLayerEntity::UpdateAnimation(Nz::UInt8 animationId)
 	{
 		auto& animComponent = m_entity->GetComponent<AnimationComponent>();
-		animComponent.Play(animationId, m_layer.GetMatch().GetCurrentTime());
+		animComponent.Play(animationId, m_layer->GetMatch().GetCurrentTime());
 	}
 
 	void LocalLayerEntity::UpdatePlayerMovement(bool isFacingRight)
@@ -22,6 +22,7 @@
 #include <ClientLib/Scoreboard.hpp>
 #include <ClientLib/VisualEntity.hpp>
 #include <ClientLib/Components/VisibleLayerComponent.hpp>
+#include <ClientLib/Components/VisualInterpolationComponent.hpp>
 #include <ClientLib/Scripting/ClientEditorScriptingLibrary.hpp>
 #include <ClientLib/Scripting/ClientElementLibrary.hpp>
 #include <ClientLib/Scripting/ClientEntityLibrary.hpp>
@@ -30,6 +31,8 @@
 #include <ClientLib/Scripting/ClientWeaponLibrary.hpp>
 #include <ClientLib/Components/LocalMatchComponent.hpp>
 #include <ClientLib/Systems/SoundSystem.hpp>
+#include <Nazara/Core/Bitset.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <Nazara/Graphics/ColorBackground.hpp>
 #include <Nazara/Graphics/TileMap.hpp>
 #include <Nazara/Graphics/TextSprite.hpp>
@@ -40,6 +43,7 @@
 #include <Nazara/Utility/SimpleTextDrawer.hpp>
 #include <NDK/Components.hpp>
 #include <NDK/Systems.hpp>
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 
@@ -54,6 +58,7 @@ namespace bw
 	m_freeClientId(-1),
 	m_renderTarget(renderTarget),
 	m_window(window),
+	m_entityInstantiationBudget(burgApp.GetConfig().GetIntegerValue<Nz::UInt64>("GameSettings.EntityInstantiationBudget")),
 	m_activeLayerIndex(0xFFFF),
 	m_chatBox(GetLogger(), renderTarget, canvas),
 	m_application(burgApp),
@@ -198,6 +203,11 @@ namespace bw
 		return m_session.GetNetworkStringStore();
 	}
 
+	const std::shared_ptr<ScriptingContext>& LocalMatch::GetScriptingContext() const
+	{
+		return m_scriptingContext;
+	}
+
 	ClientWeaponStore& LocalMatch::GetWeaponStore()
 	{
 		return *m_weaponStore;
@@ -264,6 +274,9 @@ namespace bw
 			std::shared_ptr<ClientScriptingLibrary> scriptingLibrary = std::make_shared<ClientScriptingLibrary>(*this);
 
 			m_scriptingContext = std::make_shared<ScriptingContext>(GetLogger(), scriptDir);
+			m_scriptingContext->EnableBytecodeCache(m_application.GetConfig().GetStringValue("Assets.ScriptCacheFolder"));
+			m_scriptingContext->EnableManualGarbageCollection();
+			m_scriptingContext->GetAllocator().SetMemoryLimit(m_application.GetConfig().GetIntegerValue<std::size_t>("GameSettings.ScriptMemoryLimit") * 1024 * 1024);
 			m_scriptingContext->LoadLibrary(scriptingLibrary);
 			m_scriptingContext->LoadLibrary(std::make_shared<ClientEditorScriptingLibrary>(GetLogger(), *m_assetStore));
 
@@ -462,6 +475,59 @@ namespace bw
 		m_entitiesByUniqueId.emplace(uniqueId, std::move(entity));
 	}
 
+	void LocalMatch::ReloadScripts(const std::shared_ptr<VirtualDirectory>& scriptDir, const std::vector<std::string>& changedScripts)
+	{
+		std::vector<std::filesystem::path> elementPaths;
+		for (const std::string& scriptPath : changedScripts)
+		{
+			// Elements only depend on their own file/folder, anything else (autorun libs, gamemode) may affect every element
+			std::filesystem::path path = scriptPath;
+			auto it = path.begin();
+			std::filesystem::path rootFolder = *it++;
+			if ((rootFolder == "entities" || rootFolder == "weapons") && it != path.end())
+			{
+				std::filesystem::path elementPath = rootFolder / *it;
+				if (std::find(elementPaths.begin(), elementPaths.end(), elementPath) == elementPaths.end())
+					elementPaths.emplace_back(std::move(elementPath));
+			}
+			else
+			{
+				bwLog(GetLogger(), LogLevel::Info, "Shared scripts changed, reloading all scripts");
+				LoadScripts(scriptDir);
+				return;
+			}
+		}
+
+		for (const std::filesystem::path& elementPath : elementPaths)
+		{
+			VirtualDirectory::Entry entry;
+			if (!scriptDir->GetEntry(elementPath.generic_u8string(), &entry))
+				continue;
+
+			bool isDirectory = std::holds_alternative<VirtualDirectory::VirtualDirectoryEntry>(entry);
+
+			auto ReloadElement = [&](auto& store)
+			{
+				// Server refuses property layout changes as well, indices of property updates stay valid
+				if (!store.LoadElement(isDirectory, elementPath))
+					return;
+
+				ForEachEntity([&](const Ndk::EntityHandle& entity)
+				{
+					if (entity->HasComponent<ScriptComponent>())
+						store.UpdateEntityElement(entity);
+				});
+			};
+
+			bwLog(GetLogger(), LogLevel::Info, "Hot-reloading {0}", elementPath.generic_u8string());
+
+			if (*elementPath.begin() == "entities")
+				ReloadElement(*m_entityStore);
+			else
+				ReloadElement(*m_weaponStore);
+		}
+	}
+
 	const Ndk::EntityHandle& LocalMatch::RetrieveEntityByUniqueId(Nz::Int64 uniqueId) const
 	{
 		auto it = m_entitiesByUniqueId.find(uniqueId);
@@ -496,6 +562,8 @@ namespace bw
 
 		SharedMatch::Update(elapsedTime);
 
+		InstantiatePendingEntities();
+
 		if (m_debug)
 		{
 			Nz::NetPacket debugPacket;
@@ -700,6 +768,16 @@ namespace bw
 			PushTickPacket(inputs.stateTick, inputs);
 		});
 
+		m_session.OnEntitiesLayerChange.Connect([this](ClientSession* /*session*/, const Packets::EntitiesLayerChange& layerChange)
+		{
+			PushTickPacket(layerChange.stateTick, layerChange);
+		});
+
+		m_session.OnEntitiesPropertyUpdate.Connect([this](ClientSession* /*session*/, const Packets::EntitiesPropertyUpdate& propertyUpdate)
+		{
+			PushTickPacket(propertyUpdate.stateTick, propertyUpdate);
+		});
+
 		m_session.OnEntityWeapon.Connect([this](ClientSession* /*session*/, const Packets::EntityWeapon& weapon)
 		{
 			PushTickPacket(weapon.stateTick, weapon);
@@ -974,6 +1052,7 @@ namespace bw
 	{
 		assert(packet.layerIndex < m_layers.size());
 		auto& layerPtr = m_layers[packet.layerIndex];
+		layerPtr->InstantiatePendingEntity(packet.entityId);
 
 		auto layerEntityOpt = layerPtr->GetEntity(packet.entityId);
 		if (!layerEntityOpt)
@@ -986,12 +1065,20 @@ namespace bw
 			auto& controlledEntity = m_localPlayers[packet.localIndex].controlledEntity;
 			controlledEntity->GetEntity()->RemoveComponent<Ndk::ListenerComponent>();
 
+			// No longer predicted, render it from server snapshots again
+			if (controlledEntity->GetEntity()->HasComponent<VisualInterpolationComponent>())
+				controlledEntity->GetEntity()->GetComponent<VisualInterpolationComponent>().EnableSnapshotInterpolation(true);
+
 			m_layers[controlledEntity->GetLayerIndex()]->EnablePrediction(false);
 		}
 
 		m_localPlayers[packet.localIndex].controlledEntity = layerEntity.CreateHandle();
 		m_localPlayers[packet.localIndex].controlledEntity->GetEntity()->AddComponent<Ndk::ListenerComponent>();
 
+		// Predicted entities are rendered from their simulated state
+		if (layerEntity.GetEntity()->HasComponent<VisualInterpolationComponent>())
+			layerEntity.GetEntity()->GetComponent<VisualInterpolationComponent>().EnableSnapshotInterpolation(false);
+
 		// Ensure prediction is enabled on all player-controlled layers
 		for (auto& playerData : m_localPlayers)
 		{
@@ -1029,20 +1116,42 @@ namespace bw
 
 	void LocalMatch::HandleTickPacket(Packets::DisableLayer&& packet)
 	{
-		assert(m_layers[packet.layerIndex]->IsEnabled());
+		auto& layer = m_layers[packet.layerIndex];
+		if (!layer->IsEnabled())
+		{
+			// Server evicted this layer from our cache
+			assert(!packet.keepEntities);
+			bwLog(GetLogger(), LogLevel::Debug, "Layer {} dormant entities released", packet.layerIndex);
+
+			layer->Disable();
+			return;
+		}
+
 		bwLog(GetLogger(), LogLevel::Debug, "Layer {} is now disabled", packet.layerIndex);
 
 		//TODO
-		m_layers[packet.layerIndex]->Disable();
+		layer->Disable(packet.keepEntities);
 	}
 
 	void LocalMatch::HandleTickPacket(Packets::EnableLayer&& packet)
 	{
 		assert(!m_layers[packet.layerIndex]->IsEnabled());
-		bwLog(GetLogger(), LogLevel::Debug, "Layer {} is now enabled", packet.layerIndex);
+		bwLog(GetLogger(), LogLevel::Debug, "Layer {} is now enabled ({} entities received)", packet.layerIndex, packet.layerEntities.size());
 
 		//TODO
 		auto& layer = m_layers[packet.layerIndex];
+		if (packet.isDelta)
+		{
+			// We kept this layer entities while it was disabled, only drop the ones which changed since
+			for (Nz::UInt32 entityId : packet.removedEntities)
+				layer->RemoveDormantEntity(entityId);
+
+			for (const auto& entity : packet.layerEntities)
+				layer->RemoveDormantEntity(entity.id);
+		}
+		else
+			layer->Disable(); //< Releases dormant entities, if any
+
 		layer->Enable();
 		layer->HandlePacket(packet.layerEntities.data(), packet.layerEntities.size());
 	}
@@ -1083,10 +1192,62 @@ namespace bw
 		}
 	}
 
+	void LocalMatch::HandleTickPacket(Packets::EntitiesLayerChange&& packet)
+	{
+		std::size_t offset = 0;
+		for (auto&& layerData : packet.layers)
+		{
+			assert(layerData.layerIndex < m_layers.size());
+			assert(layerData.newLayerIndex < m_layers.size());
+			auto& layer = m_layers[layerData.layerIndex];
+			layer->HandlePacket(&packet.entities[offset], layerData.entityCount, *m_layers[layerData.newLayerIndex]);
+			offset += layerData.entityCount;
+		}
+
+		// Parents may have been moved by this packet too, restore hierarchies once every entity is in its new layer
+		offset = 0;
+		for (auto&& layerData : packet.layers)
+		{
+			auto& newLayer = m_layers[layerData.newLayerIndex];
+			for (std::size_t i = 0; i < layerData.entityCount; ++i)
+			{
+				const auto& entityData = packet.entities[offset + i];
+
+				auto entityOpt = newLayer->GetEntity(entityData.newEntityId);
+				if (!entityOpt)
+					continue;
+
+				LocalLayerEntity* parent = nullptr;
+				if (entityData.newParentId)
+				{
+					newLayer->InstantiatePendingEntity(entityData.newParentId.value());
+					if (auto parentOpt = newLayer->GetEntity(entityData.newParentId.value()))
+						parent = &parentOpt->get();
+				}
+
+				entityOpt->get().UpdateParent(parent);
+			}
+			offset += layerData.entityCount;
+		}
+	}
+
+	void LocalMatch::HandleTickPacket(Packets::EntitiesPropertyUpdate&& packet)
+	{
+		std::size_t offset = 0;
+		for (auto&& layerData : packet.layers)
+		{
+			assert(layerData.layerIndex < m_layers.size());
+			auto& layer = m_layers[layerData.layerIndex];
+			layer->HandlePacket(&packet.entities[offset], layerData.entityCount);
+			offset += layerData.entityCount;
+		}
+	}
+
 	void LocalMatch::HandleTickPacket(Packets::EntityWeapon&& packet)
 	{
 		assert(packet.layerIndex < m_layers.size());
 		auto& layer = m_layers[packet.layerIndex];
+		layer->InstantiatePendingEntity(packet.entityId);
 
 		auto entityOpt = layer->GetEntity(packet.entityId);
 		if (!entityOpt)
@@ -1096,6 +1257,8 @@ namespace bw
 
 		if (packet.weaponEntityId != Packets::EntityWeapon::NoWeapon)
 		{
+			layer->InstantiatePendingEntity(packet.weaponEntityId);
+
 			auto newWeaponOpt = layer->GetEntity(packet.weaponEntityId);
 			if (!newWeaponOpt)
 				return;
@@ -1125,6 +1288,15 @@ namespace bw
 		if (Nz::Keyboard::IsKeyPressed(Nz::Keyboard::A))
 			return;
 
+		// Remember our current (predicted) controlled entities state, to restore it if the server agrees with it
+		std::vector<std::optional<PhysicsState>> currentStates(m_localPlayers.size());
+		for (std::size_t i = 0; i < m_localPlayers.size(); ++i)
+		{
+			auto& controllerData = m_localPlayers[i];
+			if (controllerData.controlledEntity)
+				currentStates[i] = RetrievePhysicsState(controllerData.controlledEntity->GetEntity());
+		}
+
 		// Apply physics state to all layers
 		std::size_t offset = 0;
 		for (auto&& layerData : packet.layers)
@@ -1135,6 +1307,37 @@ namespace bw
 			offset += layerData.entityCount;
 		}
 
+		// Compare server state with what we predicted for this tick
+		auto stateInput = std::find_if(m_predictedInputs.begin(), m_predictedInputs.end(), [stateTick = packet.stateTick](const PredictedInput& input)
+		{
+			return input.serverTick == stateTick;
+		});
+
+		bool mispredicted = false;
+		for (std::size_t i = 0; i < m_localPlayers.size(); ++i)
+		{
+			auto& controllerData = m_localPlayers[i];
+			if (!controllerData.controlledEntity || !currentStates[i])
+				continue;
+
+			if (stateInput == m_predictedInputs.end() || i >= stateInput->inputs.size() || !stateInput->inputs[i].predictedState)
+			{
+				mispredicted = true;
+				break;
+			}
+
+			std::optional<PhysicsState> serverState = RetrievePhysicsState(controllerData.controlledEntity->GetEntity());
+			assert(serverState);
+
+			const PhysicsState& predictedState = *stateInput->inputs[i].predictedState;
+			if (predictedState.position.SquaredDistance(serverState->position) > PredictionPositionErrorThreshold * PredictionPositionErrorThreshold ||
+			    predictedState.linearVelocity.SquaredDistance(serverState->linearVelocity) > PredictionVelocityErrorThreshold * PredictionVelocityErrorThreshold)
+			{
+				mispredicted = true;
+				break;
+			}
+		}
+
 		// Remove treated inputs
 		auto firstClientInput = std::find_if(m_predictedInputs.begin(), m_predictedInputs.end(), [stateTick = packet.stateTick](const PredictedInput& input)
 		{
@@ -1142,6 +1345,30 @@ namespace bw
 		});
 		m_predictedInputs.erase(m_predictedInputs.begin(), firstClientInput);
 
+		if (!mispredicted)
+		{
+			// Prediction was right, keep our controlled entities where they are and other entities at their snapshot state
+			for (std::size_t i = 0; i < m_localPlayers.size(); ++i)
+			{
+				auto& controllerData = m_localPlayers[i];
+				if (!controllerData.controlledEntity || !currentStates[i])
+					continue;
+
+				const PhysicsState& currentState = *currentStates[i];
+				controllerData.controlledEntity->UpdateState(currentState.position, currentState.rotation, currentState.linearVelocity, currentState.angularVelocity);
+			}
+
+			return;
+		}
+
+		// Only layers with locally controlled entities need to be simulated again
+		Nz::Bitset<Nz::UInt64> predictedLayers(m_layers.size(), false);
+		for (auto& controllerData : m_localPlayers)
+		{
+			if (controllerData.controlledEntity)
+				predictedLayers.Set(controllerData.controlledEntity->GetLayerIndex());
+		}
+
 		// Reconciliate server and clients
 		for (const PredictedInput& input : m_predictedInputs)
 		{
@@ -1179,8 +1406,9 @@ namespace bw
 				}
 			}
 
-			for (auto& layer : m_layers)
+			for (std::size_t layerIndex = predictedLayers.FindFirst(); layerIndex != predictedLayers.npos; layerIndex = predictedLayers.FindNext(layerIndex))
 			{
+				auto& layer = m_layers[layerIndex];
 				if (layer->IsEnabled() && layer->IsPredictionEnabled())
 					layer->TickUpdate(GetTickDuration());
 			}
@@ -1212,6 +1440,8 @@ namespace bw
 
 		for (auto weaponEntityIndex : packet.weaponEntities)
 		{
+			layer->InstantiatePendingEntity(weaponEntityIndex);
+
 			auto entityOpt = layer->GetEntity(weaponEntityIndex);
 			if (!entityOpt)
 			{
@@ -1281,6 +1511,34 @@ namespace bw
 		m_scoreboard->Center();
 	}
 
+	void LocalMatch::InstantiatePendingEntities()
+	{
+		// Entities received from the server are instantiated over several frames, entering a crowded layer doesn't stall the client
+		// Packets referencing an entity still waiting instantiate it right away, see LocalLayer
+		Nz::UInt64 deadline = Nz::GetElapsedMicroseconds() + m_entityInstantiationBudget;
+
+		Nz::Vector2f focusPosition = Nz::Vector2f::Zero();
+		if (m_camera)
+		{
+			const Nz::Recti& viewport = m_camera->GetViewport();
+			focusPosition = m_camera->Unproject(Nz::Vector2f(viewport.x + viewport.width * 0.5f, viewport.y + viewport.height * 0.5f));
+		}
+
+		// Layer the player is in is served first
+		if (m_activeLayerIndex < m_layers.size())
+		{
+			auto& activeLayer = m_layers[m_activeLayerIndex];
+			if (activeLayer->IsEnabled() && activeLayer->HasPendingEntities())
+				activeLayer->InstantiatePendingEntities(focusPosition, deadline);
+		}
+
+		for (auto& layer : m_layers)
+		{
+			if (layer->IsEnabled() && layer->HasPendingEntities())
+				layer->InstantiatePendingEntities(focusPosition, deadline);
+		}
+	}
+
 	void LocalMatch::OnTick(bool lastTick)
 	{
 		Nz::UInt16 estimatedServerTick = GetNetworkTick(EstimateServerTick());
@@ -1368,6 +1626,8 @@ namespace bw
 						entityInputs.UpdateInputs(playerData.input);
 						playerData.previousInput = entityInputs.GetPreviousInputs();
 					}
+
+					playerData.predictedState = RetrievePhysicsState(entity);
 				}
 
 				for (auto&& weaponEntity : controllerData.weapons)
@@ -1436,4 +1696,20 @@ namespace bw
 		else
 			return false;
 	}
+
+	auto LocalMatch::RetrievePhysicsState(const Ndk::EntityHandle& entity) -> std::optional<PhysicsState>
+	{
+		if (!entity->HasComponent<Ndk::PhysicsComponent2D>())
+			return std::nullopt;
+
+		auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent2D>();
+
+		PhysicsState state;
+		state.angularVelocity = entityPhys.GetAngularVelocity();
+		state.linearVelocity = entityPhys.GetVelocity();
+		state.position = entityPhys.GetPosition();
+		state.rotation = entityPhys.GetRotation();
+
+		return state;
+	}
 }
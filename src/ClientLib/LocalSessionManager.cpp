@@ -7,6 +7,7 @@
 #include <CoreLib/Match.hpp>
 #include <CoreLib/MatchSessions.hpp>
 #include <CoreLib/LogSystem/Logger.hpp>
+#include <Nazara/Core/Clock.hpp>
 
 namespace bw
 {
@@ -32,16 +33,43 @@ namespace bw
 		peer->serverBridge = std::make_shared<LocalSessionBridge>(*this, peerId, true);
 		peer->session = GetOwner()->CreateSession(peer->serverBridge);
 
+		if (m_simulatedConditions)
+		{
+			peer->clientSimulator.emplace(*m_simulatedConditions);
+			peer->serverSimulator.emplace(*m_simulatedConditions);
+		}
+
 		return peer->clientBridge;
 	}
 
 	void LocalSessionManager::Poll()
 	{
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+
 		for (auto& peerOpt : m_peers)
 		{
 			if (peerOpt)
 			{
 				Peer& peer = peerOpt.value();
+
+				// Packets held back by network simulation are released once their delivery time is reached
+				auto ReleasePackets = [&](std::optional<NetworkConditionSimulator>& simulator, std::vector<Nz::NetPacket>& packets)
+				{
+					if (!simulator)
+						return;
+
+					// Everything has to be delivered before disconnecting
+					simulator->Poll((peer.disconnectionRequested) ? std::numeric_limits<Nz::UInt64>::max() : now, [&](Nz::UInt8 /*channelId*/, Nz::ENetPacketFlags /*flags*/, Nz::NetPacket&& packet)
+					{
+						packets.emplace_back(std::move(packet));
+					});
+
+					if (!m_simulatedConditions && !simulator->HasPendingPackets())
+						simulator.reset();
+				};
+
+				ReleasePackets(peer.clientSimulator, peer.clientPackets);
+				ReleasePackets(peer.serverSimulator, peer.serverPackets);
 				for (auto&& packet : peer.clientPackets)
 					peer.clientBridge->HandleIncomingPacket(packet);
 
@@ -65,6 +93,28 @@ namespace bw
 		}
 	}
 
+	void LocalSessionManager::SimulateNetworkConditions(const NetworkConditions& conditions)
+	{
+		if (!conditions.IsPerfect())
+			m_simulatedConditions = conditions;
+		else
+			m_simulatedConditions.reset(); //< Existing simulators are kept until their pending packets are delivered
+
+		for (auto& peerOpt : m_peers)
+		{
+			if (!peerOpt)
+				continue;
+
+			for (std::optional<NetworkConditionSimulator>* simulator : { &peerOpt->clientSimulator, &peerOpt->serverSimulator })
+			{
+				if (*simulator)
+					(*simulator)->UpdateConditions(conditions);
+				else if (m_simulatedConditions)
+					simulator->emplace(*m_simulatedConditions);
+			}
+		}
+	}
+
 	void LocalSessionManager::DisconnectPeer(std::size_t peerId)
 	{
 		assert(peerId < m_peers.size() && m_peers[peerId]);
@@ -72,7 +122,7 @@ namespace bw
 		peer.disconnectionRequested = true;
 	}
 
-	void LocalSessionManager::SendPacket(std::size_t peerId, Nz::NetPacket&& packet, bool isServer)
+	void LocalSessionManager::SendPacket(std::size_t peerId, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet, bool isServer)
 	{
 		assert(peerId < m_peers.size() && m_peers[peerId]);
 		Peer& peer = m_peers[peerId].value();
@@ -80,7 +130,10 @@ namespace bw
 		// Reset cursor position
 		packet.GetStream()->SetCursorPos(Nz::NetPacket::HeaderSize);
 
-		if (isServer)
+		std::optional<NetworkConditionSimulator>& simulator = (isServer) ? peer.clientSimulator : peer.serverSimulator;
+		if (simulator)
+			simulator->Push(Nz::GetElapsedMicroseconds(), channelId, flags, std::move(packet));
+		else if (isServer)
 			peer.clientPackets.emplace_back(std::move(packet));
 		else
 			peer.serverPackets.emplace_back(std::move(packet));
@@ -46,6 +46,14 @@ namespace bw
 		return ConnectWithReactor(GetReactor(reactorId).get());
 	}
 
+	void NetworkReactorManager::SimulateNetworkConditions(const NetworkConditions& conditions)
+	{
+		m_simulatedConditions = conditions;
+
+		for (const auto& reactorPtr : m_reactors)
+			reactorPtr->SimulateNetworkConditions(conditions);
+	}
+
 	void NetworkReactorManager::Update()
 	{
 		for (const auto& reactorPtr : m_reactors)
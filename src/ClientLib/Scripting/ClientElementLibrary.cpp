@@ -180,28 +180,27 @@ namespace bw
 			Ndk::EntityHandle entity = AbstractElementLibrary::AssertScriptEntity(table);
 
 			auto& entityScript = entity->GetComponent<ScriptComponent>();
+			const auto& entityElement = entityScript.GetElement();
 
-			auto propertyVal = entityScript.GetProperty(propertyName);
-			if (propertyVal.has_value())
-			{
-				sol::state_view lua(s);
-				const EntityProperty& property = propertyVal.value();
+			auto propertyIt = entityElement->properties.find(propertyName);
+			if (propertyIt == entityElement->properties.end())
+				return sol::nil;
 
-				LocalMatch* match;
-				if (entity->HasComponent<LocalMatchComponent>())
-					match = &entity->GetComponent<LocalMatchComponent>().GetLocalMatch();
-				else
-					match = nullptr;
+			const auto& propertyInfo = propertyIt->second;
 
-				const auto& entityElement = entityScript.GetElement();
+			const EntityProperty* property = entityScript.GetProperty(propertyInfo.index);
+			if (!property)
+				return sol::nil;
 
-				auto propertyIt = entityElement->properties.find(propertyName);
-				assert(propertyIt != entityElement->properties.end());
+			sol::state_view lua(s);
 
-				return TranslateEntityPropertyToLua(match, lua, property, propertyIt->second.type);
-			}
+			LocalMatch* match;
+			if (entity->HasComponent<LocalMatchComponent>())
+				match = &entity->GetComponent<LocalMatchComponent>().GetLocalMatch();
 			else
-				return sol::nil;
+				match = nullptr;
+
+			return TranslateEntityPropertyToLua(match, lua, *property, propertyInfo.type);
 		};
 
 		elementTable["PlaySound"] = [this](const sol::table& entityTable, const std::string& soundPath, bool isAttachedToEntity, bool isLooping, bool isSpatialized)
@@ -42,6 +42,8 @@ namespace bw
 
 			assert(element->frameFunction);
 
+			LuaAllocator::OwnerScope allocationOwner(scriptComponent.GetContext()->GetAllocator(), element->fullName);
+
 			auto result = element->frameFunction(scriptComponent.GetTable());
 			if (!result.valid())
 			{
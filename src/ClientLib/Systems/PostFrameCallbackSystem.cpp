@@ -42,6 +42,8 @@ namespace bw
 
 			assert(element->postFrameFunction);
 
+			LuaAllocator::OwnerScope allocationOwner(scriptComponent.GetContext()->GetAllocator(), element->fullName);
+
 			auto result = element->postFrameFunction(scriptComponent.GetTable());
 			if (!result.valid())
 			{
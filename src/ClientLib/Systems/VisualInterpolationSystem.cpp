@@ -8,15 +8,43 @@
 #include <Nazara/Math/Algorithm.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <NDK/Components/PhysicsComponent2D.hpp>
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 
 namespace bw
 {
-	VisualInterpolationSystem::VisualInterpolationSystem()
+	VisualInterpolationSystem::VisualInterpolationSystem() :
+	m_currentTime(0.0),
+	m_interpolationDelay(MinInterpolationDelay),
+	m_snapshotInterval(0.f),
+	m_snapshotJitter(0.f)
 	{
 		Requires<VisualInterpolationComponent, Ndk::PhysicsComponent2D, Ndk::NodeComponent>();
 	}
 
+	double VisualInterpolationSystem::RegisterSnapshot()
+	{
+		if (m_lastSnapshotTime)
+		{
+			// Estimate snapshot interval and jitter the same way RTP does (exponential moving averages)
+			float interval = float(m_currentTime - m_lastSnapshotTime.value());
+			if (m_snapshotInterval > 0.f)
+			{
+				m_snapshotInterval += (interval - m_snapshotInterval) / 16.f;
+				m_snapshotJitter += (std::abs(interval - m_snapshotInterval) - m_snapshotJitter) / 16.f;
+			}
+			else
+				m_snapshotInterval = interval;
+
+			m_interpolationDelay = Nz::Clamp(m_snapshotInterval + 2.f * m_snapshotJitter, MinInterpolationDelay, MaxInterpolationDelay);
+		}
+
+		m_lastSnapshotTime = m_currentTime;
+
+		return m_currentTime;
+	}
+
 	void VisualInterpolationSystem::OnEntityAdded(Ndk::Entity* entity)
 	{
 		auto& entityNode = entity->GetComponent<Ndk::NodeComponent>();
@@ -27,23 +55,39 @@ namespace bw
 
 	void VisualInterpolationSystem::OnUpdate(float elapsedTime)
 	{
+		m_currentTime += elapsedTime;
+
 		float C = 10.f;
 		float factor = 1.f - std::exp(-elapsedTime * C);
 
+		double renderTime = m_currentTime - m_interpolationDelay;
+
 		for (const Ndk::EntityHandle& entity : GetEntities())
 		{
 			auto& entityLerp = entity->GetComponent<VisualInterpolationComponent>();
 			auto& entityNode = entity->GetComponent<Ndk::NodeComponent>();
-			auto& entityPhysics = entity->GetComponent<Ndk::PhysicsComponent2D>();
 
-			// x = x + (target-x) * (1-Exp(-deltaTime*C))
-			Nz::RadianAnglef sourceRot = entityLerp.GetLastRotation();
-			Nz::RadianAnglef targetRot = entityPhysics.GetRotation();
-			Nz::Vector2f sourcePos = entityLerp.GetLastPosition();
-			Nz::Vector2f targetPos = entityPhysics.GetPosition();
+			Nz::RadianAnglef rotation;
+			Nz::Vector2f position;
 
-			Nz::RadianAnglef rotation = sourceRot + (targetRot - sourceRot) * factor;
-			Nz::Vector2f position = sourcePos + (targetPos - sourcePos) * factor;
+			if (entityLerp.IsSnapshotInterpolationEnabled() && entityLerp.GetSnapshotCount() > 0)
+			{
+				// Remote entity, render it in the past using server states
+				InterpolateSnapshots(entityLerp, renderTime, position, rotation);
+			}
+			else
+			{
+				auto& entityPhysics = entity->GetComponent<Ndk::PhysicsComponent2D>();
+
+				// x = x + (target-x) * (1-Exp(-deltaTime*C))
+				Nz::RadianAnglef sourceRot = entityLerp.GetLastRotation();
+				Nz::RadianAnglef targetRot = entityPhysics.GetRotation();
+				Nz::Vector2f sourcePos = entityLerp.GetLastPosition();
+				Nz::Vector2f targetPos = entityPhysics.GetPosition();
+
+				rotation = sourceRot + (targetRot - sourceRot) * factor;
+				position = sourcePos + (targetPos - sourcePos) * factor;
+			}
 
 			entityNode.SetPosition(position);
 			entityNode.SetRotation(rotation);
@@ -52,5 +96,43 @@ namespace bw
 		}
 	}
 
+	void VisualInterpolationSystem::InterpolateSnapshots(const VisualInterpolationComponent& entityLerp, double renderTime, Nz::Vector2f& position, Nz::RadianAnglef& rotation)
+	{
+		std::size_t snapshotCount = entityLerp.GetSnapshotCount();
+		assert(snapshotCount > 0);
+
+		const auto& oldestSnapshot = entityLerp.GetSnapshot(0);
+		if (renderTime <= oldestSnapshot.time)
+		{
+			position = oldestSnapshot.position;
+			rotation = oldestSnapshot.rotation;
+			return;
+		}
+
+		for (std::size_t i = 1; i < snapshotCount; ++i)
+		{
+			const auto& toSnapshot = entityLerp.GetSnapshot(i);
+			if (renderTime > toSnapshot.time)
+				continue;
+
+			const auto& fromSnapshot = entityLerp.GetSnapshot(i - 1);
+
+			// Only differences are narrowed to float, absolute times would lose precision
+			float interval = float(toSnapshot.time - fromSnapshot.time);
+			float interpolation = (interval > 0.f) ? float(renderTime - fromSnapshot.time) / interval : 1.f;
+
+			position = Nz::Vector2f::Lerp(fromSnapshot.position, toSnapshot.position, interpolation);
+			rotation = fromSnapshot.rotation + (toSnapshot.rotation - fromSnapshot.rotation) * interpolation;
+			return;
+		}
+
+		// Snapshots are late, extrapolate from the latest one for a limited time
+		const auto& latestSnapshot = entityLerp.GetSnapshot(snapshotCount - 1);
+		float extrapolation = std::min(float(renderTime - latestSnapshot.time), MaxExtrapolation);
+
+		position = latestSnapshot.position + latestSnapshot.linearVelocity * extrapolation;
+		rotation = latestSnapshot.rotation + latestSnapshot.angularVelocity * extrapolation;
+	}
+
 	Ndk::SystemIndex VisualInterpolationSystem::systemIndex;
 }
@@ -3,8 +3,17 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/Components/MatchComponent.hpp>
+#include <CoreLib/Match.hpp>
+#include <CoreLib/TerrainLayer.hpp>
 
 namespace bw
 {
+	void MatchComponent::Kill()
+	{
+		TerrainLayer& layer = m_match.GetLayer(m_layerIndex);
+		if (!layer.ReleaseEntity(m_entity))
+			m_entity->Kill();
+	}
+
 	Ndk::ComponentIndex MatchComponent::componentIndex;
 }
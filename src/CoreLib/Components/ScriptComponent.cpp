@@ -3,10 +3,11 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/Components/ScriptComponent.hpp>
+#include <cassert>
 
 namespace bw
 {
-	ScriptComponent::ScriptComponent(const Logger& logger, std::shared_ptr<const ScriptedElement> element, std::shared_ptr<ScriptingContext> context, sol::table entityTable, EntityProperties properties) :
+	ScriptComponent::ScriptComponent(const Logger& logger, std::shared_ptr<const ScriptedElement> element, std::shared_ptr<ScriptingContext> context, sol::table entityTable, EntityPropertyContainer properties) :
 	m_element(std::move(element)),
 	m_context(std::move(context)),
 	m_entityTable(std::move(entityTable)),
@@ -17,6 +18,67 @@ namespace bw
 
 	ScriptComponent::~ScriptComponent() = default;
 
+	bool ScriptComponent::Release()
+	{
+		// Cloned entities share their table, only detach it if it still belongs to this entity
+		sol::object entityObject = m_entityTable["_Entity"];
+		if (!entityObject.is<Ndk::EntityHandle>() || entityObject.as<Ndk::EntityHandle>().GetObject() != m_entity)
+			return false;
+
+		if (m_element->resetFunction)
+		{
+			auto result = m_element->resetFunction(m_entityTable);
+			if (!result.valid())
+			{
+				sol::error err = result;
+				bwLog(m_logger, LogLevel::Error, "OnReset callback failed: {}", err.what());
+				return false;
+			}
+		}
+
+		m_entityTable["_Entity"] = Ndk::EntityHandle::InvalidHandle;
+		return true;
+	}
+
+	void ScriptComponent::Recycle(std::shared_ptr<const ScriptedElement> element, sol::table entityTable, EntityPropertyContainer properties)
+	{
+		m_element = std::move(element);
+		m_entityTable = std::move(entityTable);
+		m_properties = std::move(properties);
+
+		UpdateEntity(m_entity);
+	}
+
+	void ScriptComponent::SetProperty(std::size_t propertyIndex, EntityProperty value)
+	{
+		m_properties.SetProperty(propertyIndex, std::move(value));
+
+		OnPropertyUpdate(this, propertyIndex);
+	}
+
+	void ScriptComponent::UpdateElement(std::shared_ptr<const ScriptedElement> element)
+	{
+		// Property indices may have changed, remap values set on this entity
+		EntityPropertyContainer properties(element->defaultProperties);
+		for (auto&& [propertyName, propertyInfo] : m_element->properties)
+		{
+			if (!m_properties.IsOverridden(propertyInfo.index))
+				continue;
+
+			auto it = element->properties.find(propertyName);
+			if (it == element->properties.end())
+				continue;
+
+			const EntityProperty* value = m_properties.GetProperty(propertyInfo.index);
+			assert(value);
+
+			properties.SetProperty(it->second.index, *value);
+		}
+
+		m_element = std::move(element);
+		m_properties = std::move(properties);
+	}
+
 	void ScriptComponent::UpdateEntity(const Ndk::EntityHandle& entity)
 	{
 		m_entityTable["_Entity"] = entity;
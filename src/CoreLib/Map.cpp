@@ -5,12 +5,16 @@
 #include <CoreLib/Map.hpp>
 #include <CoreLib/Protocol/CompressedInteger.hpp>
 #include <CoreLib/Utils.hpp>
+#include <Nazara/Core/AbstractHash.hpp>
 #include <Nazara/Core/Bitset.hpp>
 #include <Nazara/Core/ByteStream.hpp>
 #include <Nazara/Core/ErrorFlags.hpp>
 #include <Nazara/Core/File.hpp>
+#include <Nazara/Core/MemoryView.hpp>
 #include <Nazara/Math/Rect.hpp>
 #include <nlohmann/json.hpp>
+#include <Thirdparty/tsl/hopscotch_set.h>
+#include <cstring>
 #include <stdexcept>
 
 namespace Nz
@@ -99,10 +103,70 @@ namespace Nz
 
 namespace bw
 {
+	namespace
+	{
+		// Binary map v1 layout (little-endian), offsets are relative to the beginning of the file:
+		// - header (HeaderSize bytes)
+		// - string table: stringCount * { UInt32 offset, UInt32 size } followed by string characters
+		// - layer table: layerCount * LayerRecordSize
+		// - entity table: entityCount * EntityRecordSize, entities of a layer are contiguous
+		// - property data: variable-size, referenced by entity records
+		// - asset table: assetCount * AssetRecordSize
+		// Every string (entity types, names, property keys and values) is stored once and referenced by its index
+		constexpr std::size_t ChecksumOffset = 12;
+		constexpr std::size_t ChecksumSize = 4;
+		constexpr std::size_t HeaderSize = 72;
+		constexpr std::size_t AssetRecordSize = 32;
+		constexpr std::size_t EntityRecordSize = 36;
+		constexpr std::size_t EntityUniqueIdOffset = 20;
+		constexpr std::size_t LayerRecordSize = 24;
+		constexpr std::size_t StringRecordSize = 8;
+
+		Nz::ByteArray ComputeChecksum(const Nz::UInt8* fileContent, std::size_t fileSize)
+		{
+			assert(fileSize >= HeaderSize);
+
+			auto hash = Nz::AbstractHash::Get(Nz::HashType_CRC32);
+			hash->Begin();
+			hash->Append(fileContent + ChecksumOffset + ChecksumSize, fileSize - ChecksumOffset - ChecksumSize);
+
+			Nz::ByteArray checksum = hash->End();
+			assert(checksum.GetSize() == ChecksumSize);
+
+			return checksum;
+		}
+	}
+
+	struct Map::BinaryData
+	{
+		struct LayerEntry
+		{
+			Nz::UInt32 entityCount;
+			Nz::UInt32 firstEntity;
+		};
+
+		const std::string& GetString(Nz::UInt32 stringIndex) const
+		{
+			if (stringIndex >= strings.size())
+				throw std::runtime_error("Corrupted map file (invalid string index)");
+
+			return strings[stringIndex];
+		}
+
+		std::vector<LayerEntry> layers;
+		std::vector<Nz::UInt8> content;
+		std::vector<std::string> strings;
+		tsl::hopscotch_map<Nz::UInt32 /*entity record*/, Nz::Int64> reassignedIds;
+		Nz::UInt32 entityTableOffset;
+		Nz::UInt32 propertyDataOffset;
+	};
+
 	nlohmann::json Map::AsJson() const
 	{
 		assert(IsValid());
 
+		LoadAllLayers();
+
 		nlohmann::json mapInfo;
 		mapInfo["name"] = m_mapInfo.name;
 		mapInfo["author"] = m_mapInfo.author;
@@ -183,56 +247,71 @@ namespace bw
 
 	bool Map::Compile(const std::filesystem::path& outputPath)
 	{
-		Nz::File infoFile(outputPath.generic_u8string(), Nz::OpenMode_WriteOnly | Nz::OpenMode_Truncate);
-		if (!infoFile.IsOpen())
-			return false;
+		assert(IsValid());
 
-		constexpr Nz::UInt16 FileVersion = 0;
+		LoadAllLayers();
 
-		Nz::ByteStream stream(&infoFile);
-		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+		constexpr Nz::UInt16 FileVersion = 1;
 
-		stream.Write("Burgrmap", 8);
-		stream << FileVersion;
+		std::vector<std::string> strings;
+		tsl::hopscotch_map<std::string, Nz::UInt32> stringIndices;
 
-		// Map header
-		stream << m_mapInfo.name << m_mapInfo.author << m_mapInfo.description;
+		auto RegisterString = [&](const std::string& str) -> Nz::UInt32
+		{
+			if (auto it = stringIndices.find(str); it != stringIndices.end())
+				return it->second;
 
-		// Map layers
-		Nz::UInt16 layerCount = Nz::UInt16(m_layers.size());
-		stream << layerCount;
+			Nz::UInt32 stringIndex = Nz::UInt32(strings.size());
+			strings.push_back(str);
+			stringIndices.emplace(str, stringIndex);
 
+			return stringIndex;
+		};
+
+		Nz::UInt32 nameIndex = RegisterString(m_mapInfo.name);
+		Nz::UInt32 authorIndex = RegisterString(m_mapInfo.author);
+		Nz::UInt32 descriptionIndex = RegisterString(m_mapInfo.description);
+
+		Nz::ByteArray layerTable;
+		Nz::ByteStream layerStream(&layerTable, Nz::OpenMode_WriteOnly);
+		layerStream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		Nz::ByteArray entityTable;
+		Nz::ByteStream entityStream(&entityTable, Nz::OpenMode_WriteOnly);
+		entityStream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		Nz::ByteArray propertyData;
+		Nz::ByteStream propertyStream(&propertyData, Nz::OpenMode_WriteOnly);
+		propertyStream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		Nz::UInt32 entityCount = 0;
 		for (const Layer& layer : m_layers)
 		{
-			stream << layer.name;
-			stream << layer.backgroundColor;
-
-			Nz::UInt16 entityCount = Nz::UInt16(layer.entities.size());
-			stream << entityCount;
+			layerStream << RegisterString(layer.name);
+			layerStream << layer.backgroundColor;
+			layerStream << layer.positionAlignment.x << layer.positionAlignment.y;
+			layerStream << Nz::UInt32(layer.entities.size());
+			layerStream << entityCount;
 
 			for (const Entity& entity : layer.entities)
 			{
-				stream << entity.entityType;
-				stream << entity.name;
-				stream << entity.position.x << entity.position.y;
-				stream << entity.rotation.ToDegrees();
-
-				CompressedSigned<Nz::Int64> compressedUniqueId;
-				stream << compressedUniqueId;
-
-				Nz::UInt8 propertyCount = Nz::UInt8(entity.properties.size());
-				stream << propertyCount;
+				entityStream << RegisterString(entity.entityType);
+				entityStream << RegisterString(entity.name);
+				entityStream << entity.position.x << entity.position.y;
+				entityStream << entity.rotation.ToDegrees();
+				entityStream << entity.uniqueId;
+				entityStream << Nz::UInt32(propertyStream.GetStream()->GetCursorPos());
+				entityStream << Nz::UInt16(entity.properties.size());
+				entityStream << Nz::UInt16(0); //< padding
 
 				for (const auto& [key, value] : entity.properties)
 				{
-					stream << key;
+					propertyStream << RegisterString(key);
 
 					auto [internalType, isArray] = ExtractPropertyType(value);
 
-					Nz::UInt8 propertyType = Nz::UInt8(internalType);
-					stream << propertyType;
-
-					stream << Nz::UInt8((isArray) ? 1 : 0);
+					propertyStream << Nz::UInt8(internalType);
+					propertyStream << Nz::UInt8((isArray) ? 1 : 0);
 
 					std::visit([&](auto&& propertyValue)
 					{
@@ -244,17 +323,16 @@ namespace bw
 							using T = std::decay_t<decltype(value)>;
 
 							if constexpr (std::is_same_v<T, bool>)
-							{
-								Nz::UInt8 boolValue = (value) ? 1 : 0;
-								stream << boolValue;
-							}
+								propertyStream << Nz::UInt8((value) ? 1 : 0);
+							else if constexpr (std::is_same_v<T, std::string>)
+								propertyStream << RegisterString(value);
 							else
-								stream << value;
+								propertyStream << value;
 						};
 
 						if constexpr (IsArray)
 						{
-							stream << Nz::UInt32(propertyValue.size());
+							propertyStream << Nz::UInt32(propertyValue.size());
 							for (const auto& element : propertyValue)
 								Serialize(element);
 						}
@@ -263,34 +341,129 @@ namespace bw
 
 					}, value);
 				}
+
+				entityCount++;
 			}
 		}
 
-		Nz::UInt32 empty = 0;
-		stream << empty;
+		Nz::ByteArray assetTable;
+		Nz::ByteStream assetStream(&assetTable, Nz::OpenMode_WriteOnly);
+		assetStream.SetDataEndianness(Nz::Endianness_LittleEndian);
 
-		// Scripts (TODO)
-		/*std::vector<std::string> scripts;
+		for (const Asset& asset : m_assets)
+		{
+			assetStream << RegisterString(asset.filepath);
+			assetStream << asset.size;
+			assetStream.Write(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+		}
 
-		for (const auto& scriptPath : std::filesystem::recursive_directory_iterator(m_mapPath / "scripts"))
-			scripts.emplace_back(scriptPath.path().generic_u8string());
+		std::size_t stringDataSize = 0;
+		for (const std::string& str : strings)
+			stringDataSize += str.size();
 
-		Nz::UInt32 scriptCount = Nz::UInt32(scripts.size());*/
+		Nz::UInt32 stringTableOffset = Nz::UInt32(HeaderSize);
+		Nz::UInt32 layerTableOffset = Nz::UInt32(stringTableOffset + strings.size() * StringRecordSize + stringDataSize);
+		Nz::UInt32 entityTableOffset = Nz::UInt32(layerTableOffset + layerTable.GetSize());
+		Nz::UInt32 propertyDataOffset = Nz::UInt32(entityTableOffset + entityTable.GetSize());
+		Nz::UInt32 assetTableOffset = Nz::UInt32(propertyDataOffset + propertyData.GetSize());
 
-		// Assets
-		Nz::UInt32 assetCount = Nz::UInt32(m_assets.size());
-		stream << assetCount;
+		Nz::ByteArray fileContent;
+		fileContent.Reserve(assetTableOffset + assetTable.GetSize());
 
-		for (const Asset& asset : m_assets)
+		Nz::ByteStream stream(&fileContent, Nz::OpenMode_WriteOnly);
+		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		// Map header
+		stream.Write("Burgrmap", 8);
+		stream << FileVersion;
+		stream << Nz::UInt16(0); //< flags
+		stream << Nz::UInt32(0); //< checksum, filled once the whole file is written
+		stream << m_freeUniqueId;
+		stream << nameIndex << authorIndex << descriptionIndex;
+		stream << Nz::UInt32(strings.size()) << stringTableOffset;
+		stream << Nz::UInt32(m_layers.size()) << layerTableOffset;
+		stream << entityCount << entityTableOffset;
+		stream << propertyDataOffset;
+		stream << Nz::UInt32(m_assets.size()) << assetTableOffset;
+
+		assert(fileContent.GetSize() == HeaderSize);
+
+		// String table
+		Nz::UInt32 stringOffset = 0;
+		for (const std::string& str : strings)
 		{
-			stream << asset.filepath;
-			stream << asset.size;
-			stream.Write(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+			stream << stringOffset << Nz::UInt32(str.size());
+			stringOffset += Nz::UInt32(str.size());
 		}
 
+		for (const std::string& str : strings)
+			stream.Write(str.data(), str.size());
+
+		stream.Write(layerTable.GetConstBuffer(), layerTable.GetSize());
+		stream.Write(entityTable.GetConstBuffer(), entityTable.GetSize());
+		stream.Write(propertyData.GetConstBuffer(), propertyData.GetSize());
+		stream.Write(assetTable.GetConstBuffer(), assetTable.GetSize());
+
+		Nz::ByteArray checksum = ComputeChecksum(fileContent.GetConstBuffer(), fileContent.GetSize());
+		std::memcpy(fileContent.GetBuffer() + ChecksumOffset, checksum.GetConstBuffer(), ChecksumSize);
+
+		Nz::File mapFile(outputPath.generic_u8string(), Nz::OpenMode_WriteOnly | Nz::OpenMode_Truncate);
+		if (!mapFile.IsOpen())
+			return false;
+
+		if (mapFile.Write(fileContent.GetConstBuffer(), fileContent.GetSize()) != fileContent.GetSize())
+			return false;
+
 		return true;
 	}
 
+	std::vector<Nz::Int64> Map::GetLayerUniqueIds(std::size_t layerIndex) const
+	{
+		assert(layerIndex < m_layers.size());
+
+		std::vector<Nz::Int64> uniqueIds;
+
+		if (layerIndex >= m_pendingLayers.GetSize() || !m_pendingLayers.Test(layerIndex))
+		{
+			const Layer& layer = m_layers[layerIndex];
+
+			uniqueIds.reserve(layer.entities.size());
+			for (const Entity& entity : layer.entities)
+				uniqueIds.push_back(entity.uniqueId);
+
+			return uniqueIds;
+		}
+
+		// Read unique ids straight from entity records, bounds have been checked on load
+		const BinaryData& binaryData = *m_binaryData;
+		const auto& layerEntry = binaryData.layers[layerIndex];
+
+		Nz::MemoryView memoryView(binaryData.content.data(), binaryData.content.size());
+
+		Nz::ByteStream stream(&memoryView);
+		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		uniqueIds.reserve(layerEntry.entityCount);
+		for (Nz::UInt32 i = 0; i < layerEntry.entityCount; ++i)
+		{
+			Nz::UInt32 recordIndex = layerEntry.firstEntity + i;
+			if (auto it = binaryData.reassignedIds.find(recordIndex); it != binaryData.reassignedIds.end())
+			{
+				uniqueIds.push_back(it->second);
+				continue;
+			}
+
+			memoryView.SetCursorPos(binaryData.entityTableOffset + Nz::UInt64(recordIndex) * EntityRecordSize + EntityUniqueIdOffset);
+
+			Nz::Int64 uniqueId;
+			stream >> uniqueId;
+
+			uniqueIds.push_back(uniqueId);
+		}
+
+		return uniqueIds;
+	}
+
 	bool Map::Save(const std::filesystem::path& mapFolderPath) const
 	{
 		assert(IsValid());
@@ -307,6 +480,15 @@ namespace bw
 		return true;
 	}
 
+	void Map::LoadAllLayers() const
+	{
+		if (!m_binaryData)
+			return;
+
+		for (std::size_t layerIndex = m_pendingLayers.FindFirst(); layerIndex != m_pendingLayers.npos; layerIndex = m_pendingLayers.FindNext(layerIndex))
+			LoadLayer(layerIndex);
+	}
+
 	void Map::LoadFromBinaryInternal(const std::filesystem::path& mapFile)
 	{
 		Nz::File infoFile(mapFile.generic_u8string(), Nz::OpenMode_ReadOnly);
@@ -328,9 +510,35 @@ namespace bw
 		Nz::UInt16 fileVersion;
 		stream >> fileVersion;
 
-		if (fileVersion != 0)
-			throw std::runtime_error("Unhandled file version");
+		m_binaryData.reset();
+		m_pendingLayers.Clear();
+
+		switch (fileVersion)
+		{
+			case 0:
+				LoadFromBinaryV0(stream);
+				break;
+
+			case 1:
+			{
+				std::vector<Nz::UInt8> content(infoFile.GetSize());
+				infoFile.SetCursorPos(0);
+				if (infoFile.Read(content.data(), content.size()) != content.size())
+					throw std::runtime_error("Failed to read map file");
+
+				LoadFromBinaryV1(std::move(content));
+				break;
+			}
+
+			default:
+				throw std::runtime_error("Unhandled file version");
+		}
 
+		m_isValid = true;
+	}
+
+	void Map::LoadFromBinaryV0(Nz::ByteStream& stream)
+	{
 		// Map header
 		stream >> m_mapInfo.name >> m_mapInfo.author >> m_mapInfo.description;
 
@@ -443,7 +651,148 @@ namespace bw
 		}
 
 		Sanitize();
-		m_isValid = true;
+	}
+
+	void Map::LoadFromBinaryV1(std::vector<Nz::UInt8> content)
+	{
+		if (content.size() < HeaderSize)
+			throw std::runtime_error("Corrupted map file (truncated header)");
+
+		Nz::ByteArray checksum = ComputeChecksum(content.data(), content.size());
+		if (std::memcmp(checksum.GetConstBuffer(), &content[ChecksumOffset], ChecksumSize) != 0)
+			throw std::runtime_error("Corrupted map file (checksum mismatch)");
+
+		auto binaryData = std::make_shared<BinaryData>();
+		binaryData->content = std::move(content);
+
+		const std::vector<Nz::UInt8>& fileContent = binaryData->content;
+		auto CheckRange = [&](Nz::UInt64 offset, Nz::UInt64 size)
+		{
+			if (offset > fileContent.size() || size > fileContent.size() - offset)
+				throw std::runtime_error("Corrupted map file (out of bounds data)");
+		};
+
+		Nz::MemoryView memoryView(fileContent.data(), fileContent.size());
+
+		Nz::ByteStream stream(&memoryView);
+		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		memoryView.SetCursorPos(ChecksumOffset + ChecksumSize);
+
+		Nz::UInt32 nameIndex, authorIndex, descriptionIndex;
+		Nz::UInt32 stringCount, stringTableOffset;
+		Nz::UInt32 layerCount, layerTableOffset;
+		Nz::UInt32 entityCount;
+		Nz::UInt32 assetCount, assetTableOffset;
+
+		Nz::Int64 storedFreeUniqueId; //< not trusted, recomputed from entity ids
+		stream >> storedFreeUniqueId;
+		stream >> nameIndex >> authorIndex >> descriptionIndex;
+		stream >> stringCount >> stringTableOffset;
+		stream >> layerCount >> layerTableOffset;
+		stream >> entityCount >> binaryData->entityTableOffset;
+		stream >> binaryData->propertyDataOffset;
+		stream >> assetCount >> assetTableOffset;
+
+		CheckRange(stringTableOffset, Nz::UInt64(stringCount) * StringRecordSize);
+		CheckRange(layerTableOffset, Nz::UInt64(layerCount) * LayerRecordSize);
+		CheckRange(binaryData->entityTableOffset, Nz::UInt64(entityCount) * EntityRecordSize);
+		CheckRange(binaryData->propertyDataOffset, 0);
+		CheckRange(assetTableOffset, Nz::UInt64(assetCount) * AssetRecordSize);
+
+		// String table
+		Nz::UInt64 stringDataOffset = stringTableOffset + Nz::UInt64(stringCount) * StringRecordSize;
+
+		binaryData->strings.reserve(stringCount);
+		memoryView.SetCursorPos(stringTableOffset);
+		for (Nz::UInt32 i = 0; i < stringCount; ++i)
+		{
+			Nz::UInt32 stringOffset, stringSize;
+			stream >> stringOffset >> stringSize;
+
+			CheckRange(stringDataOffset + stringOffset, stringSize);
+			binaryData->strings.emplace_back(reinterpret_cast<const char*>(&fileContent[stringDataOffset + stringOffset]), stringSize);
+		}
+
+		m_mapInfo.name = binaryData->GetString(nameIndex);
+		m_mapInfo.author = binaryData->GetString(authorIndex);
+		m_mapInfo.description = binaryData->GetString(descriptionIndex);
+
+		// Layers headers, entities are decoded on demand
+		m_layers.clear();
+		m_layers.resize(layerCount);
+
+		binaryData->layers.resize(layerCount);
+
+		// Layers own disjoint ranges of entity records, stored in layer order
+		Nz::UInt64 nextEntity = 0;
+
+		memoryView.SetCursorPos(layerTableOffset);
+		for (Nz::UInt32 i = 0; i < layerCount; ++i)
+		{
+			Layer& layer = m_layers[i];
+			auto& layerEntry = binaryData->layers[i];
+
+			Nz::UInt32 layerNameIndex;
+			stream >> layerNameIndex;
+			layer.name = binaryData->GetString(layerNameIndex);
+
+			stream >> layer.backgroundColor;
+			stream >> layer.positionAlignment.x >> layer.positionAlignment.y;
+			stream >> layerEntry.entityCount >> layerEntry.firstEntity;
+
+			if (layerEntry.firstEntity < nextEntity || Nz::UInt64(layerEntry.firstEntity) + layerEntry.entityCount > entityCount)
+				throw std::runtime_error("Corrupted map file (invalid layer entity range)");
+
+			nextEntity = Nz::UInt64(layerEntry.firstEntity) + layerEntry.entityCount;
+		}
+
+		// Same sanitation as other formats, entity records have a fixed size so unique ids can be checked without decoding layers
+		Nz::Int64 biggestId = 0;
+		tsl::hopscotch_set<Nz::Int64> knownIds;
+		std::vector<Nz::UInt32> invalidRecords;
+		for (const auto& layerEntry : binaryData->layers)
+		{
+			for (Nz::UInt32 i = 0; i < layerEntry.entityCount; ++i)
+			{
+				Nz::UInt32 recordIndex = layerEntry.firstEntity + i;
+				memoryView.SetCursorPos(binaryData->entityTableOffset + Nz::UInt64(recordIndex) * EntityRecordSize + EntityUniqueIdOffset);
+
+				Nz::Int64 uniqueId;
+				stream >> uniqueId;
+
+				if (uniqueId <= 0 || !knownIds.insert(uniqueId).second)
+					invalidRecords.push_back(recordIndex);
+				else
+					biggestId = std::max(biggestId, uniqueId);
+			}
+		}
+
+		for (Nz::UInt32 recordIndex : invalidRecords)
+			binaryData->reassignedIds[recordIndex] = ++biggestId;
+
+		m_freeUniqueId = ++biggestId;
+
+		// Assets
+		m_assets.clear();
+		m_assets.resize(assetCount);
+
+		memoryView.SetCursorPos(assetTableOffset);
+		for (Asset& asset : m_assets)
+		{
+			Nz::UInt32 filepathIndex;
+			stream >> filepathIndex;
+			asset.filepath = binaryData->GetString(filepathIndex);
+
+			stream >> asset.size;
+			stream.Read(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+		}
+
+		if (layerCount > 0)
+		{
+			m_binaryData = std::move(binaryData);
+			m_pendingLayers.Resize(layerCount, true);
+		}
 	}
 
 	void Map::LoadFromTextInternal(const std::filesystem::path& mapFolder)
@@ -540,6 +889,145 @@ namespace bw
 		m_isValid = true;
 	}
 
+	void Map::LoadLayer(std::size_t layerIndex) const
+	{
+		assert(m_binaryData);
+		assert(m_pendingLayers.Test(layerIndex));
+
+		Nz::ErrorFlags errFlags(Nz::ErrorFlag_ThrowException);
+
+		const BinaryData& binaryData = *m_binaryData;
+		const auto& layerEntry = binaryData.layers[layerIndex];
+
+		Nz::MemoryView memoryView(binaryData.content.data(), binaryData.content.size());
+
+		Nz::ByteStream stream(&memoryView);
+		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		Layer& layer = m_layers[layerIndex];
+		layer.entities.clear();
+		layer.entities.resize(layerEntry.entityCount);
+
+		for (std::size_t i = 0; i < layerEntry.entityCount; ++i)
+		{
+			Entity& entity = layer.entities[i];
+
+			Nz::UInt32 recordIndex = static_cast<Nz::UInt32>(layerEntry.firstEntity + i);
+			memoryView.SetCursorPos(binaryData.entityTableOffset + Nz::UInt64(recordIndex) * EntityRecordSize);
+
+			Nz::UInt32 entityTypeIndex, nameIndex;
+			stream >> entityTypeIndex >> nameIndex;
+
+			entity.entityType = binaryData.GetString(entityTypeIndex);
+			entity.name = binaryData.GetString(nameIndex);
+
+			stream >> entity.position.x >> entity.position.y;
+
+			float degRot;
+			stream >> degRot;
+			entity.rotation = Nz::DegreeAnglef::FromDegrees(degRot);
+
+			stream >> entity.uniqueId;
+			if (auto it = binaryData.reassignedIds.find(recordIndex); it != binaryData.reassignedIds.end())
+				entity.uniqueId = it->second;
+
+			Nz::UInt32 propertyOffset;
+			Nz::UInt16 propertyCount;
+			stream >> propertyOffset >> propertyCount;
+
+			memoryView.SetCursorPos(Nz::UInt64(binaryData.propertyDataOffset) + propertyOffset);
+
+			for (std::size_t j = 0; j < propertyCount; ++j)
+			{
+				Nz::UInt32 keyIndex;
+				stream >> keyIndex;
+
+				const std::string& propertyName = binaryData.GetString(keyIndex);
+
+				Nz::UInt8 propertyTypeInt;
+				stream >> propertyTypeInt;
+
+				PropertyInternalType propertyType = static_cast<PropertyInternalType>(propertyTypeInt);
+
+				Nz::UInt8 isArrayInt;
+				stream >> isArrayInt;
+
+				bool isArray = (isArrayInt != 0);
+
+				auto UnserializeValue = [&](auto& value)
+				{
+					using T = std::decay_t<decltype(value)>;
+
+					if constexpr (std::is_same_v<T, bool>)
+					{
+						Nz::UInt8 boolValue;
+						stream >> boolValue;
+						value = (boolValue != 0);
+					}
+					else if constexpr (std::is_same_v<T, std::string>)
+					{
+						Nz::UInt32 stringIndex;
+						stream >> stringIndex;
+						value = binaryData.GetString(stringIndex);
+					}
+					else
+						stream >> value;
+				};
+
+				// Waiting for template lambda in C++20
+				auto Unserialize = [&](auto dummyType)
+				{
+					using T = std::decay_t<decltype(dummyType)>;
+
+					if (isArray)
+					{
+						Nz::UInt32 size;
+						stream >> size;
+
+						EntityPropertyArray<T> elements(size);
+						for (std::size_t k = 0; k < size; ++k)
+						{
+							T value;
+							UnserializeValue(value);
+
+							elements[k] = std::move(value);
+						}
+
+						entity.properties.emplace(propertyName, std::move(elements));
+					}
+					else
+					{
+						T value;
+						UnserializeValue(value);
+
+						entity.properties.emplace(propertyName, std::move(value));
+					}
+				};
+
+				switch (propertyType)
+				{
+					case PropertyInternalType::Bool: Unserialize(bool()); break;
+					case PropertyInternalType::Float: Unserialize(float()); break;
+					case PropertyInternalType::Float2: Unserialize(Nz::Vector2f()); break;
+					case PropertyInternalType::Float3: Unserialize(Nz::Vector3f()); break;
+					case PropertyInternalType::Float4: Unserialize(Nz::Vector4f()); break;
+					case PropertyInternalType::Integer: Unserialize(Nz::Int64()); break;
+					case PropertyInternalType::Integer2: Unserialize(Nz::Vector2i64()); break;
+					case PropertyInternalType::Integer3: Unserialize(Nz::Vector3i64()); break;
+					case PropertyInternalType::Integer4: Unserialize(Nz::Vector4i64()); break;
+					case PropertyInternalType::String: Unserialize(std::string()); break;
+					default: throw std::runtime_error("Corrupted map file (unknown property type)");
+				}
+			}
+		}
+
+		m_pendingLayers.Reset(layerIndex);
+
+		// Every layer has been decoded, binary content is no longer needed
+		if (m_pendingLayers.TestNone())
+			m_binaryData.reset();
+	}
+
 	void Map::Sanitize()
 	{
 		// Ensures every entity gets an unique id
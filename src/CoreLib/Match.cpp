@@ -8,8 +8,11 @@
 #include <CoreLib/ConfigFile.hpp>
 #include <CoreLib/MatchClientSession.hpp>
 #include <CoreLib/Player.hpp>
+#include <CoreLib/StatusQueryResponder.hpp>
 #include <CoreLib/Terrain.hpp>
 #include <CoreLib/Components/MatchComponent.hpp>
+#include <CoreLib/Components/NetworkSyncComponent.hpp>
+#include <CoreLib/Components/WeaponComponent.hpp>
 #include <CoreLib/Protocol/CompressedInteger.hpp>
 #include <CoreLib/Protocol/Packets.hpp>
 #include <CoreLib/Scripting/ServerElementLibrary.hpp>
@@ -20,6 +23,8 @@
 #include <CoreLib/Systems/NetworkSyncSystem.hpp>
 #include <CoreLib/Utils.hpp>
 #include <Nazara/Core/File.hpp>
+#include <Nazara/Core/TaskScheduler.hpp>
+#include <NDK/Components/NodeComponent.hpp>
 #include <NDK/Components/PhysicsComponent2D.hpp>
 #include <cassert>
 #include <fstream>
@@ -32,13 +37,28 @@ namespace bw
 	m_maxPlayerCount(maxPlayerCount),
 	m_sessions(*this),
 	m_nextUniqueId(map.GetFreeUniqueId()),
+	m_flushedNetworkStringCount(0),
+	m_mapRevision(0),
+	m_serializedNetworkStringCount(0),
 	m_lastPingUpdate(0),
+	m_lastScriptChange(0),
 	m_app(app),
-	m_map(std::move(map))
+	m_map(std::move(map)),
+	m_pendingFullScriptReload(false)
 	{
 		ReloadAssets();
 		ReloadScripts();
 
+		if (m_app.GetConfig().GetBoolValue("Assets.HotReloadScripts"))
+		{
+			m_scriptWatcher.emplace(m_app.GetConfig().GetStringValue("Assets.ScriptFolder"));
+			if (!m_scriptWatcher->IsValid())
+			{
+				bwLog(GetLogger(), LogLevel::Warning, "Failed to watch script folder, hot reload is disabled");
+				m_scriptWatcher.reset();
+			}
+		}
+
 		m_terrain = std::make_unique<Terrain>(m_map);
 		m_terrain->Initialize(*this);
 
@@ -65,6 +85,44 @@ namespace bw
 		m_scriptingLibrary.reset();
 	}
 
+	void Match::BuildStatus(ServerStatus& status) const
+	{
+		status.gamemode = m_gamemodePath.filename().generic_u8string();
+		status.map = m_map.GetMapInfo().name;
+		status.maxPlayerCount = static_cast<Nz::UInt16>(m_maxPlayerCount);
+		status.name = GetName();
+		status.tickRate = 1.f / GetTickDuration();
+
+		status.players.clear();
+		for (const auto& playerPtr : m_players)
+		{
+			if (!playerPtr || !playerPtr->IsReady())
+				continue;
+
+			auto& playerData = status.players.emplace_back();
+			playerData.name = playerPtr->GetName();
+			playerData.ping = static_cast<Nz::UInt16>(playerPtr->GetSession().GetPing());
+		}
+	}
+
+	void Match::ChangeMap(std::filesystem::path mapFile)
+	{
+		if (m_nextMap)
+		{
+			bwLog(GetLogger(), LogLevel::Warning, "A map is already being loaded, ignoring change to {0}", mapFile.generic_u8string());
+			return;
+		}
+
+		bwLog(GetLogger(), LogLevel::Info, "Loading map {0}...", mapFile.generic_u8string());
+
+		// Map is read and checked on a worker thread while the match keeps running, Update applies it once ready
+		// Layer entities are decoded later, when each layer is first used
+		m_nextMap = std::async(std::launch::async, [mapFile = std::move(mapFile)]()
+		{
+			return Map::LoadFromBinary(mapFile);
+		});
+	}
+
 	Player* Match::CreatePlayer(MatchClientSession& session, Nz::UInt8 localIndex, std::string name)
 	{
 		if (m_players.size() >= m_maxPlayerCount)
@@ -87,8 +145,22 @@ namespace bw
 		return player;
 	}
 
+	void Match::FlushNetworkStrings()
+	{
+		Nz::UInt32 stringCount = m_networkStringStore.GetStringCount();
+		if (m_flushedNetworkStringCount == stringCount)
+			return;
+
+		// Send all strings registered since last flush to all players, if any, as a single range
+		Nz::UInt32 firstStringId = m_flushedNetworkStringCount;
+		m_flushedNetworkStringCount = stringCount;
+
+		BroadcastPacket(m_networkStringStore.BuildPacket(firstStringId), false);
+	}
+
 	void Match::ForEachEntity(std::function<void(const Ndk::EntityHandle& entity)> func)
 	{
+		// Layers which weren't used yet get loaded, use Terrain::ForEachLoadedLayer for internal bookkeeping
 		for (LayerIndex i = 0; i < m_terrain->GetLayerCount(); ++i)
 		{
 			auto& layer = m_terrain->GetLayer(i);
@@ -139,6 +211,54 @@ namespace bw
 		return m_networkStringStore;
 	}
 
+	const std::shared_ptr<ScriptingContext>& Match::GetScriptingContext() const
+	{
+		return m_scriptingContext;
+	}
+
+	const std::shared_ptr<const Nz::ByteArray>& Match::GetSerializedMatchData()
+	{
+		if (!m_serializedMatchData)
+		{
+			// Assets may have been registered by scripts since match data was built
+			m_matchData.assets.clear();
+			m_matchData.fastDownloadUrls.clear();
+			BuildClientAssetListPacket(m_matchData);
+
+			Nz::NetPacket packet;
+			PacketSerializer serializer(packet, true);
+			Packets::Serialize(serializer, m_matchData);
+			packet.FlushBits();
+
+			// Current tick (serialized first) is different for every session and is written by it, only cache what follows
+			constexpr std::size_t tickSize = sizeof(Nz::UInt16);
+			assert(packet.GetDataSize() >= tickSize);
+
+			m_serializedMatchData = std::make_shared<Nz::ByteArray>(packet.GetConstData() + Nz::NetPacket::HeaderSize + tickSize, packet.GetDataSize() - tickSize);
+		}
+
+		return m_serializedMatchData;
+	}
+
+	const std::shared_ptr<const Nz::ByteArray>& Match::GetSerializedNetworkStrings()
+	{
+		Nz::UInt32 stringCount = m_networkStringStore.GetStringCount();
+		if (!m_serializedNetworkStrings || m_serializedNetworkStringCount != stringCount)
+		{
+			Packets::NetworkStrings stringsPacket = m_networkStringStore.BuildPacket();
+
+			Nz::NetPacket packet;
+			PacketSerializer serializer(packet, true);
+			Packets::Serialize(serializer, stringsPacket);
+			packet.FlushBits();
+
+			m_serializedNetworkStrings = std::make_shared<Nz::ByteArray>(packet.GetConstData() + Nz::NetPacket::HeaderSize, packet.GetDataSize());
+			m_serializedNetworkStringCount = stringCount;
+		}
+
+		return m_serializedNetworkStrings;
+	}
+
 	ServerWeaponStore& Match::GetWeaponStore()
 	{
 		return *m_weaponStore;
@@ -161,6 +281,18 @@ namespace bw
 		}
 	}
 
+	void Match::MoveEntityToLayer(const Ndk::EntityHandle& entity, LayerIndex layerIndex, EntityMigrationCallback callback)
+	{
+		assert(entity && entity->HasComponent<MatchComponent>());
+		assert(layerIndex < m_terrain->GetLayerCount());
+
+		// Components can't be moved while their world is updating (from a physics callback for example), do it after the terrain update
+		auto& layerChange = m_pendingLayerChanges.emplace_back();
+		layerChange.callback = std::move(callback);
+		layerChange.entity = entity;
+		layerChange.layerIndex = layerIndex;
+	}
+
 	void Match::RegisterAsset(const std::filesystem::path& assetPath)
 	{
 		std::string relativePath = assetPath.generic_u8string();
@@ -202,6 +334,8 @@ namespace bw
 			asset.size = assetSize;
 
 			m_assets.emplace(std::move(assetPath), std::move(asset));
+
+			m_serializedMatchData.reset();
 		}
 	}
 
@@ -251,13 +385,8 @@ namespace bw
 
 	void Match::RegisterNetworkString(std::string string)
 	{
-		if (m_networkStringStore.GetStringIndex(string) == m_networkStringStore.InvalidIndex)
-		{
-			Nz::UInt32 newStringId = m_networkStringStore.RegisterString(std::move(string));
-
-			// Send the new string to all players, if any
-			BroadcastPacket(m_networkStringStore.BuildPacket(newStringId), false);
-		}
+		// New strings are sent to players in one packet by the next FlushNetworkStrings call
+		m_networkStringStore.RegisterString(std::move(string));
 	}
 
 	void Match::ReloadAssets()
@@ -300,6 +429,9 @@ namespace bw
 				m_scriptingLibrary = std::make_shared<ServerScriptingLibrary>(*this, *m_assetStore);
 
 			m_scriptingContext = std::make_shared<ScriptingContext>(GetLogger(), scriptDir);
+			m_scriptingContext->EnableBytecodeCache(m_app.GetConfig().GetStringValue("Assets.ScriptCacheFolder"));
+			m_scriptingContext->EnableManualGarbageCollection();
+			m_scriptingContext->GetAllocator().SetMemoryLimit(m_app.GetConfig().GetIntegerValue<std::size_t>("GameSettings.ScriptMemoryLimit") * 1024 * 1024);
 			m_scriptingContext->LoadLibrary(m_scriptingLibrary);
 		}
 		else
@@ -371,14 +503,18 @@ namespace bw
 
 		if (m_terrain)
 		{
-			ForEachEntity([this](const Ndk::EntityHandle& entity)
+			// Layers loaded later instantiate their entities from the reloaded elements
+			m_terrain->ForEachLoadedLayer([this](TerrainLayer& layer)
 			{
-				if (entity->HasComponent<ScriptComponent>())
+				layer.ForEachEntity([this](const Ndk::EntityHandle& entity)
 				{
-					// Warning: ugly (FIXME)
-					m_entityStore->UpdateEntityElement(entity);
-					m_weaponStore->UpdateEntityElement(entity);
-				}
+					if (entity->HasComponent<ScriptComponent>())
+					{
+						// Warning: ugly (FIXME)
+						m_entityStore->UpdateEntityElement(entity);
+						m_weaponStore->UpdateEntityElement(entity);
+					}
+				});
 			});
 		}
 
@@ -386,26 +522,28 @@ namespace bw
 		{
 			if (entity.isNetworked)
 			{
-				m_networkStringStore.RegisterString(entity.fullName);
+				RegisterNetworkString(entity.fullName);
 
 				for (auto&& [propertyName, propertyData] : entity.properties)
 				{
 					if (propertyData.shared)
-						m_networkStringStore.RegisterString(propertyName);
+						RegisterNetworkString(propertyName);
 				}
 			}
 		});
 
 		m_weaponStore->ForEachElement([&](const ScriptedWeapon& weapon)
 		{
-			m_networkStringStore.RegisterString(weapon.fullName);
+			RegisterNetworkString(weapon.fullName);
 
 			for (auto&& [propertyName, propertyData] : weapon.properties)
 			{
 				if (propertyData.shared)
-					m_networkStringStore.RegisterString(propertyName);
+					RegisterNetworkString(propertyName);
 			}
 		});
+
+		FlushNetworkStrings();
 	}
 
 	void Match::RemovePlayer(Player* player, DisconnectionReason disconnectionReason)
@@ -459,6 +597,18 @@ namespace bw
 	}
 
 	const Ndk::EntityHandle& Match::RetrieveEntityByUniqueId(Nz::Int64 uniqueId) const
+	{
+		if (const Ndk::EntityHandle& entity = RetrieveLoadedEntityByUniqueId(uniqueId))
+			return entity;
+
+		// Map entity from a layer which hasn't been used yet
+		if (!m_terrain || !m_terrain->LoadEntityLayer(uniqueId))
+			return Ndk::EntityHandle::InvalidHandle;
+
+		return RetrieveLoadedEntityByUniqueId(uniqueId);
+	}
+
+	const Ndk::EntityHandle& Match::RetrieveLoadedEntityByUniqueId(Nz::Int64 uniqueId) const
 	{
 		auto it = m_entitiesByUniqueId.find(uniqueId);
 		if (it == m_entitiesByUniqueId.end())
@@ -475,8 +625,32 @@ namespace bw
 		return entity->GetComponent<MatchComponent>().GetUniqueId();
 	}
 
+	void Match::UnregisterEntity(Nz::Int64 uniqueId)
+	{
+		m_entitiesByUniqueId.erase(uniqueId);
+	}
+
 	void Match::Update(float elapsedTime)
 	{
+		if (m_nextMap && m_nextMap->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			std::optional<Map> nextMap;
+			try
+			{
+				nextMap.emplace(m_nextMap->get());
+			}
+			catch (const std::exception& e)
+			{
+				bwLog(GetLogger(), LogLevel::Error, "Failed to load map: {0}", e.what());
+			}
+
+			m_nextMap.reset();
+
+			// Between two ticks, nothing references entities of the previous map
+			if (nextMap)
+				ApplyMapChange(std::move(*nextMap));
+		}
+
 		m_sessions.Poll();
 		m_scriptingContext->Update();
 
@@ -489,6 +663,9 @@ namespace bw
 			m_lastPingUpdate = appTime;
 		}
 
+		if (m_scriptWatcher)
+			UpdateScriptWatcher(appTime);
+
 
 		if (m_debug && appTime - m_debug->lastBroadcastTime > 1000 / 60)
 		{
@@ -502,9 +679,8 @@ namespace bw
 			Nz::UInt32 entityCount = 0;
 			debugPacket << entityCount;
 
-			for (LayerIndex i = 0; i < m_terrain->GetLayerCount(); ++i)
+			m_terrain->ForEachLoadedLayer([&](TerrainLayer& layer)
 			{
-				auto& layer = m_terrain->GetLayer(i);
 				layer.ForEachEntity([&](const Ndk::EntityHandle& entity)
 				{
 					if (!entity->HasComponent<Ndk::NodeComponent>() || !entity->HasComponent<NetworkSyncComponent>())
@@ -514,7 +690,7 @@ namespace bw
 
 					entityCount++;
 
-					CompressedUnsigned<Nz::UInt16> layerId(i);
+					CompressedUnsigned<Nz::UInt16> layerId(layer.GetLayerIndex());
 					CompressedUnsigned<Nz::UInt32> entityId(entity->GetId());
 					debugPacket << layerId;
 					debugPacket << entityId;
@@ -543,7 +719,7 @@ namespace bw
 
 					debugPacket << entityPosition << entityRotation;
 				});
-			}
+			});
 
 			debugPacket.GetStream()->SetCursorPos(offset);
 			debugPacket << entityCount;
@@ -559,6 +735,117 @@ namespace bw
 		}
 	}
 
+	void Match::ApplyMapChange(Map map)
+	{
+		m_pendingLayerChanges.clear();
+
+		ForEachPlayer([](Player* player)
+		{
+			player->OnMapChange();
+		});
+
+		tsl::hopscotch_map<std::string, Nz::ByteArray> previousChecksums;
+		for (const auto& pair : m_assets)
+			previousChecksums.emplace(pair.first, pair.second.checksum);
+
+		// Assets registered by scripts stay, those of the previous map are replaced by the new map ones
+		for (const auto& asset : m_map.GetAssets())
+			m_assets.erase(asset.filepath);
+
+		// Layers of the previous map are gone, visibility starts over
+		m_sessions.ForEachSession([&](MatchClientSession* session)
+		{
+			session->ResetVisibility();
+		});
+
+		m_terrain.reset();
+		m_entitiesByUniqueId.clear();
+
+		m_map = std::move(map);
+		m_nextUniqueId = m_map.GetFreeUniqueId();
+		m_mapRevision++;
+
+		ReloadAssets();
+
+		m_terrain = std::make_unique<Terrain>(m_map);
+		m_terrain->Initialize(*this);
+
+		BuildMatchData();
+
+		// Sessions and scripts are kept, clients only need the new layers and assets they don't have yet
+		Packets::MapChange mapChange;
+		BuildMapChangePacket(mapChange);
+
+		auto it = std::remove_if(mapChange.assets.begin(), mapChange.assets.end(), [&](const Packets::MapChange::Asset& asset)
+		{
+			auto checksumIt = previousChecksums.find(asset.path);
+			if (checksumIt == previousChecksums.end())
+				return false;
+
+			const Nz::ByteArray& previousChecksum = checksumIt->second;
+			return previousChecksum.GetSize() == asset.sha1Checksum.size() && std::memcmp(previousChecksum.GetConstBuffer(), asset.sha1Checksum.data(), asset.sha1Checksum.size()) == 0;
+		});
+		mapChange.assets.erase(it, mapChange.assets.end());
+
+		bwLog(GetLogger(), LogLevel::Info, "Map changed ({0} new or changed asset(s))", mapChange.assets.size());
+
+		m_sessions.ForEachSession([&](MatchClientSession* session)
+		{
+			session->NotifyMapChange(mapChange);
+		});
+
+		m_gamemode->ExecuteCallback("OnMapChange");
+
+		ForEachPlayer([&](Player* player)
+		{
+			if (player->IsReady())
+				m_gamemode->ExecuteCallback("OnPlayerMapChange", player->CreateHandle());
+		});
+	}
+
+	void Match::BroadcastClientScriptChanges(const tsl::hopscotch_map<std::string, Nz::ByteArray>& previousChecksums)
+	{
+		Packets::ClientScriptList scriptListPacket;
+		for (const auto& pair : m_clientScripts)
+		{
+			if (auto it = previousChecksums.find(pair.first); it != previousChecksums.end() && it->second == pair.second.checksum)
+				continue;
+
+			auto& scriptData = scriptListPacket.scripts.emplace_back();
+			scriptData.path = pair.first;
+
+			const Nz::ByteArray& checksum = pair.second.checksum;
+			assert(scriptData.sha1Checksum.size() == checksum.size());
+			std::memcpy(scriptData.sha1Checksum.data(), checksum.GetConstBuffer(), checksum.GetSize());
+		}
+
+		// Keep match data up to date for joining players
+		m_matchData.scripts.clear();
+		BuildClientScriptListPacket(m_matchData);
+		m_serializedMatchData.reset();
+
+		if (scriptListPacket.scripts.empty())
+			return;
+
+		bwLog(GetLogger(), LogLevel::Info, "{0} client script(s) changed", scriptListPacket.scripts.size());
+
+		BroadcastPacket(scriptListPacket);
+	}
+
+	void Match::BuildMapChangePacket(Packets::MapChange& mapChange) const
+	{
+		mapChange.stateTick = GetNetworkTick();
+
+		mapChange.layers.reserve(m_matchData.layers.size());
+		for (const auto& matchLayer : m_matchData.layers)
+		{
+			auto& packetLayer = mapChange.layers.emplace_back();
+			packetLayer.backgroundColor = matchLayer.backgroundColor;
+		}
+
+		BuildClientAssetListPacket(mapChange);
+	}
+
 	void Match::BuildMatchData()
 	{
 		// Send match data
@@ -571,7 +858,7 @@ namespace bw
 		m_matchData.layers.reserve(mapData.GetLayerCount());
 		for (std::size_t i = 0; i < mapData.GetLayerCount(); ++i)
 		{
-			const auto& mapLayer = mapData.GetLayer(i);
+			const auto& mapLayer = mapData.GetLayerHeader(i);
 
 			auto& packetLayer = m_matchData.layers.emplace_back();
 			packetLayer.backgroundColor = mapLayer.backgroundColor;
@@ -583,6 +870,8 @@ namespace bw
 
 		m_matchData.scripts.clear();
 		BuildClientScriptListPacket(m_matchData);
+
+		m_serializedMatchData.reset();
 	}
 
 	void Match::OnPlayerReady(Player* newPlayer)
@@ -631,15 +920,263 @@ namespace bw
 
 		m_terrain->Update(elapsedTime);
 
+		if (!m_pendingLayerChanges.empty())
+			ProcessLayerChanges();
+
 		if (lastTick)
 		{
+			// Simulation is over for this frame, world state is read-only until sessions are updated
+			m_terrain->ForEachLoadedLayer([](TerrainLayer& layer)
+			{
+				layer.GetWorld().GetSystem<NetworkSyncSystem>().UpdateMovementSnapshot();
+			});
+
+			// Strings registered during this tick have to reach players before the packets using them
+			FlushNetworkStrings();
+
+			m_packetBuildingSessions.clear();
+			m_sessions.ForEachSession([&](MatchClientSession* session)
+			{
+				m_packetBuildingSessions.push_back(session);
+			});
+
+			// Sessions build and serialize their packets concurrently, they're sent in one batch afterwards
+			if (m_packetBuildingSessions.size() >= ParallelPacketBuildingThreshold)
+			{
+				for (MatchClientSession* session : m_packetBuildingSessions)
+					Nz::TaskScheduler::AddTask([session] { session->BuildPackets(); });
+
+				Nz::TaskScheduler::Run();
+				Nz::TaskScheduler::WaitForTasks();
+			}
+			else
+			{
+				for (MatchClientSession* session : m_packetBuildingSessions)
+					session->BuildPackets();
+			}
+
 			m_sessions.ForEachSession([&](MatchClientSession* session)
 			{
 				session->Update(elapsedTime);
 			});
 		}
 	}
-	
+
+	void Match::ProcessLayerChanges()
+	{
+		std::vector<PendingLayerChange> layerChanges = std::move(m_pendingLayerChanges);
+		m_pendingLayerChanges.clear();
+
+		std::vector<Ndk::EntityHandle> hierarchy;
+		tsl::hopscotch_map<Ndk::EntityId, Ndk::EntityHandle> newEntities;
+
+		for (PendingLayerChange& layerChange : layerChanges)
+		{
+			Ndk::EntityHandle rootEntity = layerChange.entity;
+			if (!rootEntity)
+				continue; //< entity has been killed in the meantime
+
+			LayerIndex previousLayerIndex = rootEntity->GetComponent<MatchComponent>().GetLayerIndex();
+			if (previousLayerIndex == layerChange.layerIndex)
+				continue;
+
+			TerrainLayer& previousLayer = m_terrain->GetLayer(previousLayerIndex);
+			Ndk::World& previousWorld = previousLayer.GetWorld();
+
+			TerrainLayer& newLayer = m_terrain->GetLayer(layerChange.layerIndex);
+			NetworkSyncSystem& newSyncSystem = newLayer.GetWorld().GetSystem<NetworkSyncSystem>();
+
+			// Children (weapons, attachments, ...) follow their parent, parents are moved before their children
+			hierarchy.clear();
+			hierarchy.push_back(rootEntity);
+			for (std::size_t i = 0; i < hierarchy.size(); ++i)
+			{
+				Ndk::EntityHandle entity = hierarchy[i];
+				if (!entity->HasComponent<Ndk::NodeComponent>())
+					continue;
+
+				for (Nz::Node* childNode : entity->GetComponent<Ndk::NodeComponent>().GetChilds())
+				{
+					if (Ndk::NodeComponent* childComponent = dynamic_cast<Ndk::NodeComponent*>(childNode))
+						hierarchy.push_back(childComponent->GetEntity());
+				}
+			}
+
+			// Root entity parent stays in its layer
+			if (rootEntity->HasComponent<Ndk::NodeComponent>())
+				rootEntity->GetComponent<Ndk::NodeComponent>().SetParent(static_cast<Nz::Node*>(nullptr), true);
+
+			if (rootEntity->HasComponent<NetworkSyncComponent>())
+				rootEntity->GetComponent<NetworkSyncComponent>().UpdateParent(Ndk::EntityHandle::InvalidHandle);
+
+			newEntities.clear();
+			for (const Ndk::EntityHandle& entity : hierarchy)
+			{
+				const Ndk::EntityHandle& newEntity = newLayer.MigrateEntity(entity);
+				newEntities.emplace(entity->GetId(), newEntity);
+
+				if (newEntity->HasComponent<MatchComponent>())
+				{
+					// Unique id is kept, it only refers to another entity from now on
+					auto& matchComponent = newEntity->GetComponent<MatchComponent>();
+					matchComponent.UpdateLayerIndex(layerChange.layerIndex);
+
+					Nz::Int64 uniqueId = matchComponent.GetUniqueId();
+					m_entitiesByUniqueId.erase(uniqueId);
+					RegisterEntity(uniqueId, newEntity);
+				}
+
+				if (newEntity->HasComponent<NetworkSyncComponent>())
+					newSyncSystem.NotifyLayerChange(newEntity->GetId(), previousLayerIndex, entity->GetId());
+			}
+
+			auto RemapEntity = [&](const Ndk::EntityHandle& entity) -> Ndk::EntityHandle
+			{
+				if (!entity || entity->GetWorld() != &previousWorld)
+					return entity;
+
+				auto it = newEntities.find(entity->GetId());
+				return (it != newEntities.end()) ? it->second : entity;
+			};
+
+			for (auto&& [entityId, newEntity] : newEntities)
+			{
+				if (newEntity->HasComponent<NetworkSyncComponent>())
+				{
+					auto& networkSync = newEntity->GetComponent<NetworkSyncComponent>();
+					networkSync.UpdateParent(RemapEntity(networkSync.GetParent()));
+				}
+
+				if (newEntity->HasComponent<WeaponComponent>())
+				{
+					auto& weapon = newEntity->GetComponent<WeaponComponent>();
+					weapon.UpdateOwner(RemapEntity(weapon.GetOwner()));
+				}
+			}
+
+			for (const Ndk::EntityHandle& entity : hierarchy)
+			{
+				if (layerChange.callback)
+					layerChange.callback(entity, newEntities[entity->GetId()], previousLayerIndex);
+
+				entity->Kill();
+			}
+
+			// Apply the change right away so network events are emitted before packets are built
+			previousWorld.Refresh();
+			newLayer.GetWorld().Refresh();
+		}
+	}
+
+	void Match::ReloadScriptElement(const std::filesystem::path& elementPath)
+	{
+		const std::string& scriptFolder = m_app.GetConfig().GetStringValue("Assets.ScriptFolder");
+
+		std::filesystem::path scriptPath = std::filesystem::path(scriptFolder) / elementPath;
+		bool isDirectory = std::filesystem::is_directory(scriptPath);
+		if (!isDirectory && !std::filesystem::is_regular_file(scriptPath))
+		{
+			// Live entities may still use the element, keep it until next full reload
+			bwLog(GetLogger(), LogLevel::Warning, "{0} was removed, ignoring", elementPath.generic_u8string());
+			return;
+		}
+
+		bwLog(GetLogger(), LogLevel::Info, "Hot-reloading {0}", elementPath.generic_u8string());
+
+		tsl::hopscotch_map<std::string, Nz::ByteArray> previousChecksums;
+		RetrieveClientScriptChecksums(previousChecksums);
+
+		std::string elementPrefix = elementPath.generic_u8string();
+		auto ExtractElementClientScripts = [&]
+		{
+			tsl::hopscotch_map<std::string, ClientScript> elementClientScripts;
+			for (auto it = m_clientScripts.begin(); it != m_clientScripts.end();)
+			{
+				const std::string& clientScriptPath = it->first;
+				if (clientScriptPath.compare(0, elementPrefix.size(), elementPrefix) == 0 && (clientScriptPath.size() == elementPrefix.size() || clientScriptPath[elementPrefix.size()] == '/'))
+				{
+					elementClientScripts.emplace(clientScriptPath, std::move(it.value()));
+					it = m_clientScripts.erase(it);
+				}
+				else
+					++it;
+			}
+
+			return elementClientScripts;
+		};
+
+		// Forget element client scripts so they get registered (and hashed) again
+		tsl::hopscotch_map<std::string, ClientScript> previousClientScripts = ExtractElementClientScripts();
+
+		auto ReloadElement = [&](auto& store)
+		{
+			if (!store.LoadElement(isDirectory, elementPath))
+			{
+				// Element was kept, clients (and joining players) have to keep the matching files too
+				ExtractElementClientScripts();
+				for (auto&& [clientScriptPath, clientScript] : previousClientScripts)
+					m_clientScripts.emplace(clientScriptPath, clientScript);
+
+				return;
+			}
+
+			// Only entities of the reloaded element get re-pointed, other elements are unchanged
+			m_terrain->ForEachLoadedLayer([&](TerrainLayer& layer)
+			{
+				layer.ForEachEntity([&](const Ndk::EntityHandle& entity)
+				{
+					if (entity->HasComponent<ScriptComponent>())
+						store.UpdateEntityElement(entity);
+				});
+			});
+		};
+
+		std::filesystem::path elementFolder = *elementPath.begin();
+		if (elementFolder == "entities")
+		{
+			ReloadElement(*m_entityStore);
+
+			m_entityStore->ForEachElement([&](const ScriptedEntity& entity)
+			{
+				if (entity.isNetworked)
+				{
+					RegisterNetworkString(entity.fullName);
+
+					for (auto&& [propertyName, propertyData] : entity.properties)
+					{
+						if (propertyData.shared)
+							RegisterNetworkString(propertyName);
+					}
+				}
+			});
+		}
+		else
+		{
+			assert(elementFolder == "weapons");
+			ReloadElement(*m_weaponStore);
+
+			m_weaponStore->ForEachElement([&](const ScriptedWeapon& weapon)
+			{
+				RegisterNetworkString(weapon.fullName);
+
+				for (auto&& [propertyName, propertyData] : weapon.properties)
+				{
+					if (propertyData.shared)
+						RegisterNetworkString(propertyName);
+				}
+			});
+		}
+
+		BroadcastClientScriptChanges(previousChecksums);
+	}
+
+	void Match::RetrieveClientScriptChecksums(tsl::hopscotch_map<std::string, Nz::ByteArray>& checksums) const
+	{
+		checksums.clear();
+		for (const auto& pair : m_clientScripts)
+			checksums.emplace(pair.first, pair.second.checksum);
+	}
+
 	void Match::SendPingUpdate()
 	{
 		Packets::PlayerPingUpdate pingUpdate;
@@ -656,4 +1193,68 @@ namespace bw
 
 		BroadcastPacket(pingUpdate);
 	}
+
+	void Match::SendPlayerList(MatchClientSession& session)
+	{
+		ForEachPlayer([&](Player* player)
+		{
+			if (!player->IsReady())
+				return;
+
+			Packets::PlayerJoined joinedPacket;
+			joinedPacket.playerIndex = static_cast<Nz::UInt16>(player->GetPlayerIndex());
+			joinedPacket.playerName = player->GetName();
+
+			session.SendPacket(joinedPacket);
+		});
+	}
+
+	void Match::UpdateScriptWatcher(Nz::UInt64 appTime)
+	{
+		m_changedScripts.clear();
+		m_scriptWatcher->PollChanges(m_changedScripts);
+
+		for (const std::filesystem::path& scriptPath : m_changedScripts)
+		{
+			m_lastScriptChange = appTime;
+
+			// Elements only depend on their own file/folder, anything else (autorun libs, gamemode) may affect every element
+			auto it = scriptPath.begin();
+			std::filesystem::path rootFolder = *it++;
+			if ((rootFolder == "entities" || rootFolder == "weapons") && it != scriptPath.end())
+			{
+				std::filesystem::path elementPath = rootFolder / *it;
+				if (std::find(m_pendingElementReloads.begin(), m_pendingElementReloads.end(), elementPath) == m_pendingElementReloads.end())
+					m_pendingElementReloads.emplace_back(std::move(elementPath));
+			}
+			else
+				m_pendingFullScriptReload = true;
+		}
+
+		// Editors may write a file in multiple steps, wait for changes to settle
+		if (appTime - m_lastScriptChange < ScriptReloadDelay)
+			return;
+
+		if (m_pendingFullScriptReload)
+		{
+			bwLog(GetLogger(), LogLevel::Info, "Shared scripts changed, reloading all scripts");
+
+			tsl::hopscotch_map<std::string, Nz::ByteArray> previousChecksums;
+			RetrieveClientScriptChecksums(previousChecksums);
+
+			ReloadScripts();
+			BroadcastClientScriptChanges(previousChecksums);
+
+			m_pendingElementReloads.clear();
+			m_pendingFullScriptReload = false;
+		}
+		else if (!m_pendingElementReloads.empty())
+		{
+			// Reload one element per update to spread the cost over multiple frames
+			std::filesystem::path elementPath = std::move(m_pendingElementReloads.front());
+			m_pendingElementReloads.erase(m_pendingElementReloads.begin());
+
+			ReloadScriptElement(elementPath);
+		}
+	}
 }
@@ -3,6 +3,8 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/MatchClientSession.hpp>
+#include <CoreLib/BurgApp.hpp>
+#include <CoreLib/ConfigFile.hpp>
 #include <CoreLib/Match.hpp>
 #include <CoreLib/MatchClientVisibility.hpp>
 #include <CoreLib/NetworkReactor.hpp>
@@ -22,8 +24,16 @@ namespace bw
 	m_sessionId(sessionId),
 	m_bridge(std::move(bridge)),
 	m_ping(0),
-	m_peerInfoUpdateCounter(0.f)
+	m_mapRevision(0),
+	m_peerInfoUpdateCounter(0.f),
+	m_isKicked(false),
+	m_isLoadingMap(false)
 	{
+		// Dropped packets are forgiven at a rate of one per second, a client exceeding its budgets once in a while won't get kicked
+		Nz::UInt32 kickThreshold = match.GetApp().GetConfig().GetIntegerValue<Nz::UInt32>("Network.PacketBudgets.KickThreshold");
+		if (kickThreshold > 0)
+			m_packetDropBudget.emplace(1.f, float(kickThreshold));
+
 		m_visibility = std::make_unique<MatchClientVisibility>(match, *this);
 		m_bridge->OnIncomingPacket.Connect([this](Nz::NetPacket& packet)
 		{
@@ -39,6 +49,16 @@ namespace bw
 		});
 	}
 
+	void MatchClientSession::BuildPackets()
+	{
+		// Entities are held back until the client has finished loading the map
+		if (m_isLoadingMap)
+			return;
+
+		// May run on a worker thread, packets are only serialized here and sent by Update
+		m_visibility->BuildPackets();
+	}
+
 	void MatchClientSession::Disconnect()
 	{
 		m_bridge->Disconnect();
@@ -46,12 +66,42 @@ namespace bw
 
 	void MatchClientSession::HandleIncomingPacket(Nz::NetPacket& packet)
 	{
-		m_commandStore.UnserializePacket(*this, packet);
+		if (m_isKicked)
+			return;
+
+		m_commandStore.UnserializePacket(*this, packet, [this](Nz::UInt8 opcode, const PlayerCommandStore::IncomingCommand& command)
+		{
+			return ConsumePacketBudget(opcode, command);
+		});
+	}
+
+	void MatchClientSession::NotifyMapChange(const Packets::MapChange& mapChange)
+	{
+		// Clients still loading a map will be sent the new one when they're ready
+		if (m_players.empty() || m_isLoadingMap)
+			return;
+
+		// Previous map packets have to reach the client before it switches
+		FlushPackets();
+		SendPacket(mapChange);
+
+		m_mapRevision = m_match.GetMapRevision();
+		m_isLoadingMap = true;
+	}
+
+	void MatchClientSession::ResetVisibility()
+	{
+		std::size_t layerCacheSize = m_visibility->GetLayerCacheSize();
+		m_visibility = std::make_unique<MatchClientVisibility>(m_match, *this);
+		m_visibility->SetLayerCacheSize(layerCacheSize);
 	}
 
 	void MatchClientSession::Update(float elapsedTime)
 	{
-		m_visibility->Update();
+		FlushPackets();
+
+		if (!m_isLoadingMap)
+			m_visibility->Update();
 
 		m_peerInfoUpdateCounter += elapsedTime;
 		if (m_peerInfoUpdateCounter >= 1.f)
@@ -68,6 +118,51 @@ namespace bw
 		}
 	}
 
+	bool MatchClientSession::ConsumePacketBudget(Nz::UInt8 opcode, const PlayerCommandStore::IncomingCommand& command)
+	{
+		m_incomingPacketStatistics.receivedPackets++;
+
+		if (command.budgetRate <= 0.f)
+			return true;
+
+		if (opcode >= m_packetBudgets.size())
+			m_packetBudgets.resize(opcode + 1);
+
+		auto& packetBudget = m_packetBudgets[opcode];
+		if (!packetBudget)
+			packetBudget.emplace(command.budgetRate, command.budgetBurst);
+
+		Nz::UInt64 now = m_match.GetApp().GetAppTime();
+		if (packetBudget->Consume(now))
+			return true;
+
+		m_incomingPacketStatistics.droppedPackets++;
+
+		auto& droppedPacketsByOpcode = m_incomingPacketStatistics.droppedPacketsByOpcode;
+		if (opcode >= droppedPacketsByOpcode.size())
+			droppedPacketsByOpcode.resize(opcode + 1, 0);
+
+		droppedPacketsByOpcode[opcode]++;
+
+		if (m_packetDropBudget && !m_packetDropBudget->Consume(now))
+		{
+			bwLog(m_match.GetLogger(), LogLevel::Warning, "Session #{0} kicked for flooding ({1} packet(s) dropped, last one was {2})", m_sessionId, m_incomingPacketStatistics.droppedPackets, command.name);
+
+			m_isKicked = true;
+			Disconnect();
+		}
+
+		return false;
+	}
+
+	void MatchClientSession::FlushPackets()
+	{
+		for (QueuedPacket& queuedPacket : m_queuedPackets)
+			m_bridge->SendPacket(queuedPacket.channelId, queuedPacket.flags, std::move(queuedPacket.data));
+
+		m_queuedPackets.clear();
+	}
+
 	void MatchClientSession::HandleIncomingPacket(const Packets::Auth& packet)
 	{
 		std::size_t playerCount = packet.players.size();
@@ -105,11 +200,16 @@ namespace bw
 		}
 
 		m_players = std::move(players);
+		m_visibility->SetLayerCacheSize(packet.layerCacheSize);
+
+		m_mapRevision = m_match.GetMapRevision();
+		m_isLoadingMap = true;
 
 		SendPacket(authSuccessPacket);
-		SendPacket(m_match.GetNetworkStringStore().BuildPacket());
 
-		SendPacket(m_match.GetMatchData());
+		// Network strings and match data are the same for every joining player, they are serialized once by the match
+		SendSerializedPacket<Packets::NetworkStrings>(*m_match.GetSerializedNetworkStrings());
+		SendSerializedPacket<Packets::MatchData>(*m_match.GetSerializedMatchData(), m_match.GetNetworkTick());
 	}
 
 	void MatchClientSession::HandleIncomingPacket(const Packets::DownloadClientScriptRequest& packet)
@@ -227,10 +327,33 @@ namespace bw
 
 	void MatchClientSession::HandleIncomingPacket(const Packets::Ready& /*packet*/)
 	{
+		if (!m_isLoadingMap)
+			return;
+
+		// Players stay ready through map changes, only the client had to rebuild its match
+		bool isMapReload = !m_players.empty() && m_players.front()->IsReady();
+
 		ForEachPlayer([this](Player* player)
 		{
 			m_match.OnPlayerReady(player);
 		});
+
+		if (m_mapRevision != m_match.GetMapRevision())
+		{
+			// Map changed while the client was loading, send it the whole asset list as it may have missed several changes
+			Packets::MapChange mapChange;
+			m_match.BuildMapChangePacket(mapChange);
+
+			SendPacket(mapChange);
+
+			m_mapRevision = m_match.GetMapRevision();
+			return;
+		}
+
+		if (isMapReload)
+			m_match.SendPlayerList(*this);
+
+		m_isLoadingMap = false;
 	}
 
 	void MatchClientSession::HandleIncomingPacket(const Packets::ScriptPacket& packet)
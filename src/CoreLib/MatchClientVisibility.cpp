@@ -8,7 +8,9 @@
 #include <CoreLib/Protocol/Packets.hpp>
 #include <CoreLib/MatchClientSession.hpp>
 #include <CoreLib/Terrain.hpp>
+#include <algorithm>
 #include <cassert>
+#include <functional>
 #include <queue>
 
 namespace bw
@@ -105,11 +107,35 @@ namespace bw
 				}
 			});
 
+			layer.onEntitiesPropertyUpdate.Connect(syncSystem.OnEntitiesPropertyUpdate, [this, layerIndex](NetworkSyncSystem*, const NetworkSyncSystem::EntityPropertyUpdate* events, std::size_t entityCount)
+			{
+				assert(m_layers.find(layerIndex) != m_layers.end());
+				Layer& layer = *m_layers[layerIndex];
+
+				for (std::size_t i = 0; i < entityCount; ++i)
+				{
+					if (!layer.visibleEntities.UnboundedTest(events[i].entityId))
+						continue;
+
+					// Merge with a previous update which has not been sent yet
+					if (auto it = layer.propertyUpdateEvents.find(events[i].entityId); it != layer.propertyUpdateEvents.end())
+					{
+						auto& pendingEvent = it.value();
+						pendingEvent.properties = events[i].properties;
+						pendingEvent.updatedProperties |= events[i].updatedProperties;
+					}
+					else
+						layer.propertyUpdateEvents.emplace(events[i].entityId, events[i]);
+
+					m_pendingEvents.Set(VisibilityEventType::PropertyUpdate);
+				}
+			});
+
 			m_newlyVisibleLayers.UnboundedSet(layerIndex);
 		}
 	}
 
-	void MatchClientVisibility::Update()
+	void MatchClientVisibility::BuildPackets()
 	{
 		Nz::UInt16 networkTick = m_match.GetNetworkTick();
 
@@ -123,12 +149,19 @@ namespace bw
 
 				LayerIndex layerIndex = LayerIndex(i);
 
-				// The client will destroy automatically all entities that belong to this layer
+				// The client will destroy automatically all entities that belong to this layer, unless it keeps them until the layer is enabled again
 				Packets::DisableLayer disableLayer;
+				disableLayer.keepEntities = false;
 				disableLayer.layerIndex = layerIndex;
 				disableLayer.stateTick = networkTick;
-				
-				m_session.SendPacket(disableLayer);
+
+				if (auto cacheIt = m_hiddenLayerCaches.find(layerIndex); cacheIt != m_hiddenLayerCaches.end())
+				{
+					disableLayer.keepEntities = StoreLayerCache(layerIndex, std::move(cacheIt.value()), networkTick);
+					m_hiddenLayerCaches.erase(cacheIt);
+				}
+
+				m_session.QueuePacket(disableLayer);
 
 				m_clientVisibleLayers.UnboundedReset(layerIndex);
 			}
@@ -144,7 +177,7 @@ namespace bw
 				layerPacket.layerIndex = layerUpdate.layerIndex;
 				layerPacket.localIndex = layerUpdate.localPlayerIndex;
 
-				m_session.SendPacket(layerPacket);
+				m_session.QueuePacket(layerPacket);
 			}
 
 			m_pendingLayerUpdates.clear();
@@ -171,24 +204,93 @@ namespace bw
 
 				if (m_clientVisibleLayers.UnboundedTest(i))
 				{
+					// Layer was hidden and shown again before the client knew about it
+					m_hiddenLayerCaches.erase(layerIndex);
+
 					for (const Ndk::EntityHandle& entity : syncSystem.GetEntities())
 						layer.visibleEntities.UnboundedSet(entity->GetId());
 
 					continue;
 				}
 
-				syncSystem.CreateEntities([&](const NetworkSyncSystem::EntityCreation* entitiesCreation, std::size_t entityCount)
+				Packets::EnableLayer enableLayerPacket;
+				enableLayerPacket.isDelta = false;
+				enableLayerPacket.layerIndex = layerIndex;
+				enableLayerPacket.stateTick = networkTick;
+
+				if (auto cacheIt = m_cachedLayers.find(layerIndex); cacheIt != m_cachedLayers.end())
 				{
-					for (std::size_t i = 0; i < entityCount; ++i)
+					// Client kept this layer entities, only send what changed since it was disabled
+					CachedLayer& cachedLayer = cacheIt.value();
+					enableLayerPacket.isDelta = true;
+
+					syncSystem.CreateEntities([&](const NetworkSyncSystem::EntityCreation* entitiesCreation, std::size_t entityCount)
 					{
-						if (!layer.visibleEntities.UnboundedTest(entitiesCreation[i].entityId))
-							pendingCreationMap[entitiesCreation[i].entityId] = entitiesCreation[i];
+						m_tempBitset.Clear(); //< entities to send
+
+						for (std::size_t i = 0; i < entityCount; ++i)
+						{
+							Ndk::EntityId entityId = entitiesCreation[i].entityId;
+							if (layer.visibleEntities.UnboundedTest(entityId))
+								continue; //< Already being created
+
+							if (!cachedLayer.entities.UnboundedTest(entityId) || syncSystem.HasEntityChangedSince(entityId, cachedLayer.revision))
+								m_tempBitset.UnboundedSet(entityId);
+						}
+
+						// Client will recreate changed entities, which means their children have to be sent as well
+						bool hasChanged;
+						do
+						{
+							hasChanged = false;
+							for (std::size_t i = 0; i < entityCount; ++i)
+							{
+								const auto& creationEvent = entitiesCreation[i];
+								if (creationEvent.parent && m_tempBitset.UnboundedTest(creationEvent.parent.value()) && !m_tempBitset.UnboundedTest(creationEvent.entityId) && !layer.visibleEntities.UnboundedTest(creationEvent.entityId))
+								{
+									m_tempBitset.UnboundedSet(creationEvent.entityId);
+									hasChanged = true;
+								}
+							}
+						}
+						while (hasChanged);
+
+						for (std::size_t i = 0; i < entityCount; ++i)
+						{
+							Ndk::EntityId entityId = entitiesCreation[i].entityId;
+							if (m_tempBitset.UnboundedTest(entityId))
+								pendingCreationMap[entityId] = entitiesCreation[i];
+							else if (!layer.visibleEntities.UnboundedTest(entityId))
+							{
+								// Client still has an up-to-date version of this entity
+								assert(cachedLayer.entities.UnboundedTest(entityId));
+								layer.visibleEntities.UnboundedSet(entityId);
+								cachedLayer.entities.UnboundedReset(entityId);
+							}
+						}
+					});
+
+					// Remaining cached entities no longer exist or are about to be replaced
+					for (std::size_t entityId = cachedLayer.entities.FindFirst(); entityId != cachedLayer.entities.npos; entityId = cachedLayer.entities.FindNext(entityId))
+					{
+						if (pendingCreationMap.find(entityId) == pendingCreationMap.end())
+							enableLayerPacket.removedEntities.emplace_back(static_cast<Nz::UInt32>(entityId));
 					}
-				});
 
-				Packets::EnableLayer enableLayerPacket;
-				enableLayerPacket.layerIndex = layerIndex;
-				enableLayerPacket.stateTick = networkTick;
+					m_cachedEntityCount -= cachedLayer.entityCount;
+					m_cachedLayers.erase(cacheIt);
+				}
+				else
+				{
+					syncSystem.CreateEntities([&](const NetworkSyncSystem::EntityCreation* entitiesCreation, std::size_t entityCount)
+					{
+						for (std::size_t i = 0; i < entityCount; ++i)
+						{
+							if (!layer.visibleEntities.UnboundedTest(entitiesCreation[i].entityId))
+								pendingCreationMap[entitiesCreation[i].entityId] = entitiesCreation[i];
+						}
+					});
+				}
 
 				std::function<void(PendingCreationEventMap::iterator it)> PushEntity;
 				PushEntity = [&](PendingCreationEventMap::iterator it)
@@ -223,7 +325,7 @@ namespace bw
 				for (auto it = pendingCreationMap.begin(); it != pendingCreationMap.end(); ++it)
 					PushEntity(it);
 
-				m_session.SendPacket(enableLayerPacket);
+				m_session.QueuePacket(enableLayerPacket);
 
 				m_clientVisibleLayers.UnboundedSet(layerIndex);
 
@@ -232,6 +334,10 @@ namespace bw
 			m_newlyVisibleLayers.Clear();
 		}
 
+		// Entities moved from a layer to another are moved client-side instead of being destroyed and recreated
+		if (m_pendingEvents.Test(VisibilityEventType::Creation) && m_pendingEvents.Test(VisibilityEventType::Destruction))
+			ResolveLayerChanges();
+
 		// Send packet in fixed order
 		if (m_pendingEvents.Test(VisibilityEventType::Death))
 		{
@@ -258,7 +364,7 @@ namespace bw
 				layer.deathEvents.clear();
 			}
 
-			m_session.SendPacket(m_entitiesDeathPacket);
+			m_session.QueuePacket(m_entitiesDeathPacket);
 
 			m_pendingEvents.Clear(VisibilityEventType::Death);
 		}
@@ -288,13 +394,22 @@ namespace bw
 					entityData.id = entityId;
 				}
 				layer.destructionEvents.clear();
+				layer.layerChangeCandidates.clear();
 			}
 
-			m_session.SendPacket(m_deleteEntitiesPacket);
+			m_session.QueuePacket(m_deleteEntitiesPacket);
 
 			m_pendingEvents.Clear(VisibilityEventType::Destruction);
 		}
 
+		if (m_pendingEvents.Test(VisibilityEventType::LayerChange))
+		{
+			m_entitiesLayerChangePacket.stateTick = networkTick;
+			m_session.QueuePacket(m_entitiesLayerChangePacket);
+
+			m_pendingEvents.Clear(VisibilityEventType::LayerChange);
+		}
+
 		if (m_pendingEvents.Test(VisibilityEventType::Creation))
 		{
 			m_createEntitiesPacket.stateTick = networkTick;
@@ -332,7 +447,7 @@ namespace bw
 
 					auto& entityData = m_createEntitiesPacket.entities.emplace_back();
 					entityData.id = eventData->entityId;
-					FillEntityData(eventData.value(), entityData.data);
+					entityData.serializedData = SerializeEntityData(eventData.value());
 
 					eventData.reset();
 				};
@@ -346,7 +461,7 @@ namespace bw
 				layer.creationEvents.clear();
 			}
 
-			m_session.SendPacket(m_createEntitiesPacket);
+			m_session.QueuePacket(m_createEntitiesPacket);
 
 			m_pendingEvents.Clear(VisibilityEventType::Creation);
 		}
@@ -381,11 +496,59 @@ namespace bw
 				layer.healthUpdateEvents.clear();
 			}
 
-			m_session.SendPacket(m_healthUpdatePacket);
+			m_session.QueuePacket(m_healthUpdatePacket);
 
 			m_pendingEvents.Clear(VisibilityEventType::HealthUpdate);
 		}
 
+		if (m_pendingEvents.Test(VisibilityEventType::PropertyUpdate))
+		{
+			m_propertyUpdatePacket.stateTick = networkTick;
+
+			m_propertyUpdatePacket.entities.clear();
+			m_propertyUpdatePacket.layers.clear();
+
+			for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
+			{
+				auto& layer = *it.value();
+				if (layer.propertyUpdateEvents.empty())
+					continue;
+
+				LayerIndex layerIndex = it.key();
+
+				auto& layerData = m_propertyUpdatePacket.layers.emplace_back();
+				layerData.layerIndex = layerIndex;
+				layerData.entityCount = static_cast<Nz::UInt32>(layer.propertyUpdateEvents.size());
+
+				for (auto&& pair : layer.propertyUpdateEvents)
+				{
+					auto& eventData = pair.second;
+
+					auto& entityData = m_propertyUpdatePacket.entities.emplace_back();
+					entityData.id = pair.first;
+
+					std::size_t propertyCount = eventData.properties.GetPropertyCount();
+					for (std::size_t i = 0; i < propertyCount; ++i)
+					{
+						if (!eventData.updatedProperties.test(i))
+							continue;
+
+						const EntityProperty* property = eventData.properties.GetProperty(i);
+						assert(property);
+
+						auto& propertyData = entityData.properties.emplace_back();
+						propertyData.index = static_cast<Nz::UInt8>(i);
+						FillPropertyValue(*property, propertyData.value, propertyData.isArray);
+					}
+				}
+				layer.propertyUpdateEvents.clear();
+			}
+
+			m_session.QueuePacket(m_propertyUpdatePacket);
+
+			m_pendingEvents.Clear(VisibilityEventType::PropertyUpdate);
+		}
+
 		if (m_pendingEvents.Test(VisibilityEventType::InputUpdate))
 		{
 			m_inputUpdatePacket.stateTick = networkTick;
@@ -416,7 +579,7 @@ namespace bw
 				layer.inputUpdateEvents.clear();
 			}
 
-			m_session.SendPacket(m_inputUpdatePacket);
+			m_session.QueuePacket(m_inputUpdatePacket);
 
 			m_pendingEvents.Clear(VisibilityEventType::InputUpdate);
 		}
@@ -451,14 +614,17 @@ namespace bw
 				layer.playAnimationEvents.clear();
 			}
 
-			m_session.SendPacket(m_entitiesAnimationPacket);
+			m_session.QueuePacket(m_entitiesAnimationPacket);
 
 			m_pendingEvents.Clear(VisibilityEventType::PlayAnimation);
 		}
 
 		if (!m_layers.empty())
 			SendMatchState();
+	}
 
+	void MatchClientVisibility::Update()
+	{
 		for (auto it = m_pendingEntitiesEvent.begin(); it != m_pendingEntitiesEvent.end();)
 		{
 			LayerIndex layerId = LayerIndex(it.key() >> 32);
@@ -537,17 +703,225 @@ namespace bw
 			{
 				layer.destructionEvents.insert(entityId);
 				m_pendingEvents.Set(VisibilityEventType::Destruction);
+
+				// If the client holds an up-to-date version of this entity, it may be moved to another layer instead of being recreated
+				bool isUpToDate = m_clientVisibleLayers.UnboundedTest(layerIndex) && !m_newlyVisibleLayers.UnboundedTest(layerIndex) &&
+				                  layer.inputUpdateEvents.find(entityId) == layer.inputUpdateEvents.end() &&
+				                  layer.healthUpdateEvents.find(entityId) == layer.healthUpdateEvents.end() &&
+				                  layer.playAnimationEvents.find(entityId) == layer.playAnimationEvents.end() &&
+				                  layer.propertyUpdateEvents.find(entityId) == layer.propertyUpdateEvents.end() &&
+				                  layer.staticMovementUpdateEvents.find(entityId) == layer.staticMovementUpdateEvents.end();
+
+				if (isUpToDate)
+					layer.layerChangeCandidates.insert(entityId);
 			}
 		}
 
 		layer.inputUpdateEvents.erase(entityId);
 		layer.healthUpdateEvents.erase(entityId);
 		layer.playAnimationEvents.erase(entityId);
+		layer.propertyUpdateEvents.erase(entityId);
 		layer.staticMovementUpdateEvents.erase(entityId);
 
 		layer.visibleEntities.UnboundedReset(entityId);
 	}
 
+	void MatchClientVisibility::PrepareLayerCache(LayerIndex layerIndex, const Layer& layer)
+	{
+		if (m_layerCacheSize == 0)
+			return;
+
+		// Layer may be hidden multiple times before the client is notified, the first hiding is what the client holds
+		if (m_hiddenLayerCaches.find(layerIndex) != m_hiddenLayerCaches.end())
+			return;
+
+		CachedLayer cachedLayer;
+		cachedLayer.entities = layer.visibleEntities;
+		cachedLayer.revision = layer.clientRevision;
+
+		// Entities with unsent events are out of date client-side (or don't even exist yet)
+		for (auto&& [entityId, creationEvent] : layer.creationEvents)
+			cachedLayer.entities.UnboundedReset(entityId);
+
+		for (auto&& [entityId, healthEvent] : layer.healthUpdateEvents)
+			cachedLayer.entities.UnboundedReset(entityId);
+
+		for (auto&& [entityId, inputEvent] : layer.inputUpdateEvents)
+			cachedLayer.entities.UnboundedReset(entityId);
+
+		for (auto&& [entityId, propertyEvent] : layer.propertyUpdateEvents)
+			cachedLayer.entities.UnboundedReset(entityId);
+
+		for (auto&& [entityId, movementEvent] : layer.staticMovementUpdateEvents)
+			cachedLayer.entities.UnboundedReset(entityId);
+
+		// On the other hand, client still has entities whose destruction has not been sent
+		for (Nz::UInt32 entityId : layer.deathEvents)
+			cachedLayer.entities.UnboundedSet(entityId);
+
+		for (Nz::UInt32 entityId : layer.destructionEvents)
+			cachedLayer.entities.UnboundedSet(entityId);
+
+		m_hiddenLayerCaches.emplace(layerIndex, std::move(cachedLayer));
+	}
+
+	void MatchClientVisibility::ResolveLayerChanges()
+	{
+		struct LayerChange
+		{
+			LayerIndex previousLayerIndex;
+			LayerIndex layerIndex;
+			Nz::UInt32 previousEntityId;
+			Nz::UInt32 entityId;
+			std::optional<Nz::UInt32> parentId;
+		};
+
+		auto BuildKey = [](LayerIndex layerIndex, Nz::UInt32 entityId)
+		{
+			return Nz::UInt64(layerIndex) << 32 | entityId;
+		};
+
+		tsl::hopscotch_map<Nz::UInt64 /*layerId|entityId*/, LayerChange> layerChanges;
+		for (auto layerIt = m_layers.begin(); layerIt != m_layers.end(); ++layerIt)
+		{
+			LayerIndex layerIndex = layerIt.key();
+			for (auto&& [entityId, creationEvent] : layerIt.value()->creationEvents)
+			{
+				if (!creationEvent || !creationEvent->previousLocation)
+					continue;
+
+				auto [previousLayerIndex, previousEntityId] = creationEvent->previousLocation.value();
+
+				auto previousLayerIt = m_layers.find(previousLayerIndex);
+				if (previousLayerIt == m_layers.end())
+					continue;
+
+				const Layer& previousLayer = *previousLayerIt.value();
+				if (previousLayer.layerChangeCandidates.find(static_cast<Nz::UInt32>(previousEntityId)) == previousLayer.layerChangeCandidates.end())
+					continue;
+
+				LayerChange& layerChange = layerChanges[BuildKey(layerIndex, static_cast<Nz::UInt32>(entityId))];
+				layerChange.layerIndex = layerIndex;
+				layerChange.entityId = static_cast<Nz::UInt32>(entityId);
+				layerChange.previousLayerIndex = previousLayerIndex;
+				layerChange.previousEntityId = static_cast<Nz::UInt32>(previousEntityId);
+				if (creationEvent->parent)
+					layerChange.parentId = static_cast<Nz::UInt32>(creationEvent->parent.value());
+			}
+		}
+
+		if (layerChanges.empty())
+			return;
+
+		// A moved entity can't reference an entity which will only be created afterwards, fallback to recreation for those
+		auto IsAvailable = [&](LayerIndex layerIndex, Nz::UInt32 entityId)
+		{
+			if (layerChanges.find(BuildKey(layerIndex, entityId)) != layerChanges.end())
+				return true;
+
+			auto layerIt = m_layers.find(layerIndex);
+			if (layerIt == m_layers.end())
+				return true;
+
+			const Layer& layer = *layerIt.value();
+			return layer.creationEvents.find(entityId) == layer.creationEvents.end();
+		};
+
+		bool hasChanged;
+		do
+		{
+			hasChanged = false;
+			for (auto it = layerChanges.begin(); it != layerChanges.end();)
+			{
+				const LayerChange& layerChange = it.value();
+				const auto& creationEvent = m_layers[layerChange.layerIndex]->creationEvents[layerChange.entityId];
+
+				bool canMove = !layerChange.parentId || IsAvailable(layerChange.layerIndex, layerChange.parentId.value());
+				for (auto&& [dependentLayerIndex, dependentId] : creationEvent->dependentIds)
+				{
+					if (!canMove)
+						break;
+
+					canMove = IsAvailable(dependentLayerIndex, static_cast<Nz::UInt32>(dependentId));
+				}
+
+				if (!canMove)
+				{
+					it = layerChanges.erase(it);
+					hasChanged = true;
+				}
+				else
+					++it;
+			}
+		}
+		while (hasChanged);
+
+		if (layerChanges.empty())
+			return;
+
+		std::vector<LayerChange> sortedChanges;
+		sortedChanges.reserve(layerChanges.size());
+		for (auto&& [key, layerChange] : layerChanges)
+			sortedChanges.push_back(layerChange);
+
+		std::sort(sortedChanges.begin(), sortedChanges.end(), [](const LayerChange& lhs, const LayerChange& rhs)
+		{
+			if (lhs.previousLayerIndex != rhs.previousLayerIndex)
+				return lhs.previousLayerIndex < rhs.previousLayerIndex;
+
+			return lhs.layerIndex < rhs.layerIndex;
+		});
+
+		m_entitiesLayerChangePacket.entities.clear();
+		m_entitiesLayerChangePacket.layers.clear();
+
+		Packets::EntitiesLayerChange::Layer* layerData = nullptr;
+		for (const LayerChange& layerChange : sortedChanges)
+		{
+			if (!layerData || layerData->layerIndex != layerChange.previousLayerIndex || layerData->newLayerIndex != layerChange.layerIndex)
+			{
+				layerData = &m_entitiesLayerChangePacket.layers.emplace_back();
+				layerData->layerIndex = layerChange.previousLayerIndex;
+				layerData->newLayerIndex = layerChange.layerIndex;
+				layerData->entityCount = 0;
+			}
+
+			++layerData->entityCount;
+
+			auto& entityData = m_entitiesLayerChangePacket.entities.emplace_back();
+			entityData.id = layerChange.previousEntityId;
+			entityData.newEntityId = layerChange.entityId;
+			if (layerChange.parentId)
+				entityData.newParentId.emplace(layerChange.parentId.value());
+
+			Layer& previousLayer = *m_layers[layerChange.previousLayerIndex];
+			previousLayer.destructionEvents.erase(layerChange.previousEntityId);
+			previousLayer.layerChangeCandidates.erase(layerChange.previousEntityId);
+
+			m_layers[layerChange.layerIndex]->creationEvents.erase(layerChange.entityId);
+		}
+
+		m_pendingEvents.Set(VisibilityEventType::LayerChange);
+
+		// Don't send empty creation/destruction packets if every entity was moved
+		auto HasEvents = [&](auto&& member)
+		{
+			for (auto it = m_layers.begin(); it != m_layers.end(); ++it)
+			{
+				if (!(it.value().get()->*member).empty())
+					return true;
+			}
+
+			return false;
+		};
+
+		if (!HasEvents(&Layer::creationEvents))
+			m_pendingEvents.Clear(VisibilityEventType::Creation);
+
+		if (!HasEvents(&Layer::destructionEvents))
+			m_pendingEvents.Clear(VisibilityEventType::Destruction);
+	}
+
 	void MatchClientVisibility::SendMatchState()
 	{
 		Terrain& terrain = m_match.GetTerrain();
@@ -571,6 +945,9 @@ namespace bw
 			TerrainLayer& terrainLayer = terrain.GetLayer(layerIndex);
 			const NetworkSyncSystem& syncSystem = terrainLayer.GetWorld().GetSystem<NetworkSyncSystem>();
 
+			// Every signaled change has been sent by now (or is about to be)
+			layer.clientRevision = syncSystem.GetPublishedRevision();
+
 			syncSystem.MoveEntities([&](const NetworkSyncSystem::EntityMovement* entitiesMovement, std::size_t entityCount)
 			{
 				for (std::size_t i = 0; i < entityCount; ++i)
@@ -586,7 +963,68 @@ namespace bw
 			}
 		}
 
-		m_session.SendPacket(m_matchStatePacket);
+		m_session.QueuePacket(m_matchStatePacket);
+	}
+
+	std::shared_ptr<const Nz::ByteArray> MatchClientVisibility::SerializeEntityData(const NetworkSyncSystem::EntityCreation& creationEvent)
+	{
+		auto EncodeEntity = [&](Nz::ByteArray& serializedData)
+		{
+			Packets::Helper::EntityData entityData;
+			FillEntityData(creationEvent, entityData);
+
+			Nz::NetPacket packet;
+			PacketSerializer serializer(packet, true);
+			Packets::Serialize(serializer, entityData);
+			packet.FlushBits();
+
+			serializedData = Nz::ByteArray(packet.GetConstData() + Nz::NetPacket::HeaderSize, packet.GetDataSize());
+		};
+
+		const auto& payload = creationEvent.payload;
+		if (!payload)
+		{
+			auto serializedData = std::make_shared<Nz::ByteArray>();
+			EncodeEntity(*serializedData);
+
+			return serializedData;
+		}
+
+		// Sessions build their packets concurrently, whichever comes first encodes the entity for all of them
+		std::call_once(payload->encodeFlag, EncodeEntity, std::ref(payload->data));
+
+		return std::shared_ptr<const Nz::ByteArray>(payload, &payload->data);
+	}
+
+	bool MatchClientVisibility::StoreLayerCache(LayerIndex layerIndex, CachedLayer&& cachedLayer, Nz::UInt16 networkTick)
+	{
+		cachedLayer.entityCount = cachedLayer.entities.Count();
+		if (cachedLayer.entityCount > m_layerCacheSize)
+			return false;
+
+		// Evict least recently disabled layers until the new one fits
+		while (m_cachedEntityCount + cachedLayer.entityCount > m_layerCacheSize)
+		{
+			assert(!m_cachedLayers.empty());
+
+			auto oldestIt = std::min_element(m_cachedLayers.begin(), m_cachedLayers.end(), [](const auto& lhs, const auto& rhs) { return lhs.second.storeOrder < rhs.second.storeOrder; });
+
+			Packets::DisableLayer releaseLayer;
+			releaseLayer.keepEntities = false;
+			releaseLayer.layerIndex = oldestIt->first;
+			releaseLayer.stateTick = networkTick;
+
+			m_session.QueuePacket(releaseLayer);
+
+			m_cachedEntityCount -= oldestIt->second.entityCount;
+			m_cachedLayers.erase(oldestIt);
+		}
+
+		cachedLayer.storeOrder = m_nextCacheStoreOrder++;
+		m_cachedEntityCount += cachedLayer.entityCount;
+
+		m_cachedLayers.emplace(layerIndex, std::move(cachedLayer));
+		return true;
 	}
 
 	void MatchClientVisibility::BuildMovementPacket(Packets::MatchState::Entity& packetData, const NetworkSyncSystem::EntityMovement& eventData)
@@ -649,33 +1087,46 @@ namespace bw
 			entityData.physicsProperties->linearVelocity = creationEvent.physicsProperties->linearVelocity;
 		}
 
-		for (auto&& [propertyName, propertyValue] : creationEvent.properties)
+		if (const auto& element = creationEvent.scriptElement)
 		{
-			auto& propertyData = entityData.properties.emplace_back();
-			propertyData.name = networkStringStore.CheckStringIndex(propertyName);
-
-			std::visit([&](auto&& propertyValue)
+			for (auto&& [propertyName, propertyInfo] : element->properties)
 			{
-				using T = std::decay_t<decltype(propertyValue)>;
-				constexpr bool IsArray = IsSameTpl_v<EntityPropertyArray, T>;
-				using PropertyType = std::conditional_t<IsArray, typename IsSameTpl<EntityPropertyArray, T>::ContainedType, T>;
+				if (!propertyInfo.shared || !creationEvent.properties.IsOverridden(propertyInfo.index))
+					continue;
 
-				propertyData.isArray = IsArray;
+				const EntityProperty* property = creationEvent.properties.GetProperty(propertyInfo.index);
+				assert(property);
 
-				auto& vec = propertyData.value.emplace<std::vector<PropertyType>>();
+				auto& propertyData = entityData.properties.emplace_back();
+				propertyData.name = networkStringStore.CheckStringIndex(propertyName);
+				FillPropertyValue(*property, propertyData.value, propertyData.isArray);
+			}
+		}
+	}
 
-				if constexpr (IsArray)
-				{
-					std::size_t elementCount = propertyValue.GetSize();
-					vec.reserve(elementCount);
+	void MatchClientVisibility::FillPropertyValue(const EntityProperty& property, Packets::Helper::Properties::PropertyValue& value, bool& isArray)
+	{
+		std::visit([&](auto&& propertyValue)
+		{
+			using T = std::decay_t<decltype(propertyValue)>;
+			constexpr bool IsArray = IsSameTpl_v<EntityPropertyArray, T>;
+			using PropertyType = std::conditional_t<IsArray, typename IsSameTpl<EntityPropertyArray, T>::ContainedType, T>;
 
-					for (std::size_t i = 0; i < elementCount; ++i)
-						vec.emplace_back(std::move(propertyValue[i]));
-				}
-				else
-					vec.push_back(propertyValue);
+			isArray = IsArray;
 
-			}, std::move(propertyValue));
-		}
+			auto& vec = value.emplace<std::vector<PropertyType>>();
+
+			if constexpr (IsArray)
+			{
+				std::size_t elementCount = propertyValue.GetSize();
+				vec.reserve(elementCount);
+
+				for (std::size_t i = 0; i < elementCount; ++i)
+					vec.emplace_back(propertyValue[i]);
+			}
+			else
+				vec.push_back(propertyValue);
+
+		}, property);
 	}
 }
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/MatchSessions.hpp>
+#include <CoreLib/ConfigFile.hpp>
 #include <CoreLib/LogSystem/Logger.hpp>
 #include <CoreLib/Match.hpp>
 #include <CoreLib/MatchClientSession.hpp>
@@ -12,7 +13,7 @@ namespace bw
 	MatchSessions::MatchSessions(Match& match) :
 	m_nextSessionId(0),
 	m_match(match),
-	m_commandStore(m_match.GetLogger()),
+	m_commandStore(m_match.GetLogger(), m_match.GetApp().GetConfig()),
 	m_sessionPool(sizeof(MatchClientSession))
 	{
 	}
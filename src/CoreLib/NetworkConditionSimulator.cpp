@@ -0,0 +1,197 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/NetworkConditionSimulator.hpp>
+#include <CoreLib/ConfigFile.hpp>
+#include <cassert>
+
+namespace bw
+{
+	NetworkConditions NetworkConditions::FromConfig(const ConfigFile& config)
+	{
+		NetworkConditions conditions;
+		conditions.bandwidth = config.GetIntegerValue<Nz::UInt32>("Debug.NetworkSimulation.Bandwidth");
+		conditions.duplicationChance = config.GetFloatValue<float>("Debug.NetworkSimulation.DuplicationChance");
+		conditions.jitter = config.GetIntegerValue<Nz::UInt32>("Debug.NetworkSimulation.Jitter");
+		conditions.latency = config.GetIntegerValue<Nz::UInt32>("Debug.NetworkSimulation.Latency");
+		conditions.lossBurstLength = config.GetFloatValue<float>("Debug.NetworkSimulation.LossBurstLength");
+		conditions.lossChance = config.GetFloatValue<float>("Debug.NetworkSimulation.LossChance");
+		conditions.reorderChance = config.GetFloatValue<float>("Debug.NetworkSimulation.ReorderChance");
+
+		const std::string& jitterDistribution = config.GetStringValue("Debug.NetworkSimulation.JitterDistribution");
+		if (jitterDistribution == "normal")
+			conditions.jitterDistribution = JitterDistribution::Normal;
+		else
+			conditions.jitterDistribution = JitterDistribution::Uniform;
+
+		return conditions;
+	}
+
+	NetworkConditionSimulator::NetworkConditionSimulator(const NetworkConditions& conditions) :
+	m_randomGenerator(std::random_device{}()),
+	m_conditions(conditions),
+	m_linkAvailableTime(0),
+	m_nextOrder(0),
+	m_isInLossBurst(false)
+	{
+	}
+
+	void NetworkConditionSimulator::Push(Nz::UInt64 now, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet)
+	{
+		Nz::UInt64 deliveryTime = now;
+
+		// Bandwidth cap: packets are serialized on the link one after another, excess traffic queues up
+		if (m_conditions.bandwidth > 0)
+		{
+			Nz::UInt64 transmissionTime = (packet.GetDataSize() + Nz::NetPacket::HeaderSize) * 1'000'000ULL / m_conditions.bandwidth;
+			m_linkAvailableTime = std::max(m_linkAvailableTime, now) + transmissionTime;
+
+			deliveryTime = m_linkAvailableTime;
+		}
+
+		ChannelState& channel = GetChannel(channelId);
+
+		if (flags & Nz::ENetPacketFlag_Reliable)
+		{
+			deliveryTime += ComputeTransitDelay();
+
+			// A lost reliable packet is resent by ENet after a timeout, it only arrives later
+			Nz::UInt64 retransmissionDelay = std::max<Nz::UInt64>(2ULL * (m_conditions.latency + 2 * m_conditions.jitter) * 1000, MinRetransmissionDelay);
+			while (ShouldLosePacket())
+			{
+				deliveryTime += retransmissionDelay;
+				m_statistics.retransmittedPackets++;
+			}
+
+			// Reliable packets are delivered in order on their channel, one late packet holds back the following ones
+			deliveryTime = std::max(deliveryTime, channel.lastReliableDeliveryTime);
+			channel.lastReliableDeliveryTime = deliveryTime;
+
+			Schedule(deliveryTime, channelId, flags, 0, std::move(packet));
+			return;
+		}
+
+		if (ShouldLosePacket())
+		{
+			m_statistics.droppedPackets++;
+			return;
+		}
+
+		Nz::UInt32 sequence = 0;
+		if (!(flags & Nz::ENetPacketFlag_Unsequenced))
+			sequence = channel.nextSequence++;
+
+		std::uniform_real_distribution<float> chanceDis(0.f, 1.f);
+
+		if (m_conditions.duplicationChance > 0.f && chanceDis(m_randomGenerator) < m_conditions.duplicationChance)
+		{
+			m_statistics.duplicatedPackets++;
+			Schedule(deliveryTime + ComputeTransitDelay(), channelId, flags, sequence, DuplicatePacket(packet));
+		}
+
+		deliveryTime += ComputeTransitDelay();
+
+		if (m_conditions.reorderChance > 0.f && chanceDis(m_randomGenerator) < m_conditions.reorderChance)
+		{
+			// Hold the packet back long enough for the next ones to overtake it
+			std::uniform_int_distribution<Nz::UInt64> holdDis(1'000, std::max<Nz::UInt64>(m_conditions.latency + m_conditions.jitter, 10) * 1000);
+			deliveryTime += holdDis(m_randomGenerator);
+
+			m_statistics.reorderedPackets++;
+		}
+
+		Schedule(deliveryTime, channelId, flags, sequence, std::move(packet));
+	}
+
+	Nz::UInt64 NetworkConditionSimulator::ComputeTransitDelay()
+	{
+		double delay = m_conditions.latency;
+		if (m_conditions.jitter > 0)
+		{
+			switch (m_conditions.jitterDistribution)
+			{
+				case JitterDistribution::Normal:
+				{
+					std::normal_distribution<double> jitterDis(0.0, m_conditions.jitter);
+					delay += jitterDis(m_randomGenerator);
+					break;
+				}
+
+				case JitterDistribution::Uniform:
+				{
+					std::uniform_real_distribution<double> jitterDis(-double(m_conditions.jitter), double(m_conditions.jitter));
+					delay += jitterDis(m_randomGenerator);
+					break;
+				}
+			}
+		}
+
+		return static_cast<Nz::UInt64>(std::max(delay, 0.0) * 1000.0);
+	}
+
+	auto NetworkConditionSimulator::GetChannel(Nz::UInt8 channelId) -> ChannelState&
+	{
+		if (channelId >= m_channels.size())
+			m_channels.resize(channelId + 1);
+
+		return m_channels[channelId];
+	}
+
+	void NetworkConditionSimulator::Schedule(Nz::UInt64 deliveryTime, Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::UInt32 sequence, Nz::NetPacket&& packet)
+	{
+		PendingPacket& pendingPacket = m_pendingPackets.emplace_back();
+		pendingPacket.channelId = channelId;
+		pendingPacket.deliveryTime = deliveryTime;
+		pendingPacket.flags = flags;
+		pendingPacket.order = m_nextOrder++;
+		pendingPacket.packet = std::move(packet);
+		pendingPacket.sequence = sequence;
+
+		std::push_heap(m_pendingPackets.begin(), m_pendingPackets.end(), &NetworkConditionSimulator::ComparePendingPackets);
+	}
+
+	bool NetworkConditionSimulator::ShouldLosePacket()
+	{
+		if (m_conditions.lossChance <= 0.f)
+			return false;
+
+		std::uniform_real_distribution<float> chanceDis(0.f, 1.f);
+
+		// Two-state (Gilbert) model: once a packet is lost, following ones are lost until the burst ends
+		if (m_isInLossBurst)
+		{
+			float burstEndChance = 1.f / std::max(m_conditions.lossBurstLength, 1.f);
+			if (chanceDis(m_randomGenerator) >= burstEndChance)
+				return true;
+
+			m_isInLossBurst = false;
+			return false;
+		}
+
+		if (chanceDis(m_randomGenerator) < m_conditions.lossChance)
+		{
+			m_isInLossBurst = true;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool NetworkConditionSimulator::ComparePendingPackets(const PendingPacket& lhs, const PendingPacket& rhs)
+	{
+		// std heaps are max-heaps, earliest delivery (then earliest push) has to compare as the greatest
+		if (lhs.deliveryTime != rhs.deliveryTime)
+			return lhs.deliveryTime > rhs.deliveryTime;
+
+		return lhs.order > rhs.order;
+	}
+
+	Nz::NetPacket NetworkConditionSimulator::DuplicatePacket(const Nz::NetPacket& packet)
+	{
+		Nz::NetPacket duplicate(packet.GetNetCode(), packet.GetConstData() + Nz::NetPacket::HeaderSize, packet.GetDataSize());
+		duplicate.GetStream()->SetCursorPos(packet.GetStream()->GetCursorPos());
+
+		return duplicate;
+	}
+}
@@ -4,7 +4,10 @@
 
 #include <CoreLib/NetworkReactor.hpp>
 #include <CoreLib/Config.hpp>
+#include <CoreLib/StatusQueryResponder.hpp>
 #include <CoreLib/Utils.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <algorithm>
 #include <cassert>
 #include <condition_variable>
 #include <mutex>
@@ -12,19 +15,24 @@
 
 namespace bw
 {
-	NetworkReactor::NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient) :
+	NetworkReactor::NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient, std::size_t pendingSlotCount) :
 	m_firstId(firstId),
-	m_protocol(protocol)
+	m_maxClient(maxClient),
+	m_protocol(protocol),
+	m_lastConnectionSourcePruning(0)
 	{
+		std::size_t peerCount = maxClient + pendingSlotCount;
 		if (port > 0)
 		{
-			if (!m_host.Create(protocol, port, maxClient, NetworkChannelCount))
+			if (!m_host.Create(protocol, port, peerCount, NetworkChannelCount))
 				throw std::runtime_error("failed to start reactor");
 		}
-		else if (!m_host.Create((protocol == Nz::NetProtocol_IPv4) ? Nz::IpAddress::LoopbackIpV4 : Nz::IpAddress::LoopbackIpV6, maxClient, NetworkChannelCount))
+		else if (!m_host.Create((protocol == Nz::NetProtocol_IPv4) ? Nz::IpAddress::LoopbackIpV4 : Nz::IpAddress::LoopbackIpV6, peerCount, NetworkChannelCount))
 			throw std::runtime_error("failed to start reactor");
 
-		m_clients.resize(maxClient, nullptr);
+		m_clients.resize(peerCount, nullptr);
+		m_pendingPeers.Resize(peerCount, false);
+		m_simulatedPeers.resize(peerCount);
 
 		m_running.store(true, std::memory_order_release);
 		m_thread = Nz::Thread(&NetworkReactor::WorkerThread, this);
@@ -84,6 +92,28 @@ namespace bw
 		m_outgoingQueue.enqueue(std::move(outgoingData));
 	}
 
+	void NetworkReactor::EnableStatusQueries(std::shared_ptr<StatusQueryResponder> responder)
+	{
+		OutgoingEvent outgoingRequest;
+		auto& statusQueries = outgoingRequest.data.emplace<OutgoingEvent::StatusQueries>();
+		statusQueries.responder = std::move(responder);
+
+		m_outgoingQueue.enqueue(std::move(outgoingRequest));
+	}
+
+	auto NetworkReactor::GetConnectionStatistics() const -> ConnectionStatistics
+	{
+		ConnectionStatistics statistics;
+		statistics.abandonedConnections = m_connectionStatistics.abandonedConnections.load(std::memory_order_relaxed);
+		statistics.acceptedConnections = m_connectionStatistics.acceptedConnections.load(std::memory_order_relaxed);
+		statistics.evictedConnections = m_connectionStatistics.evictedConnections.load(std::memory_order_relaxed);
+		statistics.expiredConnections = m_connectionStatistics.expiredConnections.load(std::memory_order_relaxed);
+		statistics.pendingConnections = m_connectionStatistics.pendingConnections.load(std::memory_order_relaxed);
+		statistics.refusedConnections = m_connectionStatistics.refusedConnections.load(std::memory_order_relaxed);
+
+		return statistics;
+	}
+
 	void NetworkReactor::QueryInfo(std::size_t peerId, PeerInfoCallback callback)
 	{
 		assert(peerId >= m_firstId);
@@ -113,6 +143,24 @@ namespace bw
 		m_outgoingQueue.enqueue(std::move(outgoingData));
 	}
 
+	void NetworkReactor::SetConnectionLimits(const ConnectionLimits& limits)
+	{
+		OutgoingEvent outgoingRequest;
+		auto& connectionLimits = outgoingRequest.data.emplace<OutgoingEvent::SetConnectionLimits>();
+		connectionLimits.limits = limits;
+
+		m_outgoingQueue.enqueue(std::move(outgoingRequest));
+	}
+
+	void NetworkReactor::SimulateNetworkConditions(const NetworkConditions& conditions)
+	{
+		OutgoingEvent outgoingRequest;
+		auto& simulateConditions = outgoingRequest.data.emplace<OutgoingEvent::SimulateConditions>();
+		simulateConditions.conditions = conditions;
+
+		m_outgoingQueue.enqueue(std::move(outgoingRequest));
+	}
+
 	void NetworkReactor::WorkerThread()
 	{
 		moodycamel::ConsumerToken connectionToken(m_connectionRequests);
@@ -122,7 +170,16 @@ namespace bw
 		while (m_running.load(std::memory_order_acquire))
 		{
 			ReceivePackets(incomingToken);
+
+			if (m_connectionLimits)
+				ExpirePendingConnections();
+
 			SendPackets(incomingToken, outgoingToken);
+			UpdateSimulatedPeers(incomingToken);
+
+			// Status queries are answered from the last published snapshot, they never reach the match thread
+			if (m_statusResponder)
+				m_statusResponder->Poll();
 
 			// Handle connection requests last to treat disconnection request before connection requests
 			HandleConnectionRequests(connectionToken);
@@ -131,15 +188,48 @@ namespace bw
 		EnsureProperDisconnection(incomingToken, outgoingToken);
 	}
 
+	bool NetworkReactor::AcceptPendingConnection(std::size_t peerId, const moodycamel::ProducerToken& producterToken)
+	{
+		auto it = std::find_if(m_pendingConnections.begin(), m_pendingConnections.end(), [&](const PendingConnection& pendingConnection) { return pendingConnection.peerId == peerId; });
+		assert(it != m_pendingConnections.end());
+
+		Nz::UInt32 data = it->data;
+		RemovePendingConnection(it);
+
+		// Pending peers may use the spare slots, they only become clients if there's room for them
+		if (CountClients() > m_maxClient)
+		{
+			m_clients[peerId]->DisconnectNow(0);
+			m_clients[peerId] = nullptr;
+
+			m_connectionStatistics.refusedConnections.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_connectionStatistics.acceptedConnections.fetch_add(1, std::memory_order_relaxed);
+
+		NotifyConnection(peerId, false, data, producterToken);
+		return true;
+	}
+
+	std::size_t NetworkReactor::CountClients() const
+	{
+		std::size_t peerCount = std::count_if(m_clients.begin(), m_clients.end(), [](Nz::ENetPeer* peer) { return peer != nullptr; });
+		return peerCount - m_pendingConnections.size();
+	}
+
 	void NetworkReactor::EnsureProperDisconnection(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token)
 	{
 		// Prevent someone connecting from now
 		if (Nz::IpAddress listenAddress = m_host.GetBoundAddress(); listenAddress.IsValid() && !listenAddress.IsLoopback())
 			m_host.AllowsIncomingConnections(false);
 
-		// Send every pending packet and handle disconnection requests
+		// Send every pending packet (including the ones held by network simulation) and handle disconnection requests
 		SendPackets(producterToken, token);
 
+		for (std::size_t peerId = 0; peerId < m_simulatedPeers.size(); ++peerId)
+			UpdateSimulatedPeer(peerId, producterToken, std::numeric_limits<Nz::UInt64>::max());
+
 		// Then, force a disconnection for every remaining peer
 		for (Nz::ENetPeer* peer : m_clients)
 		{
@@ -188,6 +278,40 @@ namespace bw
 		}
 	}
 
+	void NetworkReactor::ExpirePendingConnections()
+	{
+		Nz::UInt64 now = Nz::GetElapsedMilliseconds();
+
+		while (!m_pendingConnections.empty() && now - m_pendingConnections.front().connectionTime >= m_connectionLimits->pendingTimeout)
+		{
+			std::size_t peerId = m_pendingConnections.front().peerId;
+			m_clients[peerId]->DisconnectNow(0);
+			m_clients[peerId] = nullptr;
+
+			RemovePendingConnection(m_pendingConnections.begin());
+
+			m_connectionStatistics.expiredConnections.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (now - m_lastConnectionSourcePruning < 1000)
+			return;
+
+		// Forget idle addresses once their budget would have refilled anyway
+		Nz::UInt64 sourceExpiration = m_connectionLimits->pendingTimeout;
+		if (m_connectionLimits->addressRate > 0.f)
+			sourceExpiration = std::max(sourceExpiration, static_cast<Nz::UInt64>(m_connectionLimits->addressBurst / m_connectionLimits->addressRate * 1000.f));
+
+		for (auto it = m_connectionSources.begin(); it != m_connectionSources.end();)
+		{
+			if (it->second.pendingConnectionCount == 0 && now - it->second.lastConnectionTime >= sourceExpiration)
+				it = m_connectionSources.erase(it);
+			else
+				++it;
+		}
+
+		m_lastConnectionSourcePruning = now;
+	}
+
 	void NetworkReactor::HandleConnectionRequests(moodycamel::ConsumerToken& token)
 {
 		ConnectionRequest request;
@@ -205,6 +329,19 @@ namespace bw
 		}
 	}
 
+	void NetworkReactor::NotifyConnection(std::size_t peerId, bool outgoing, Nz::UInt32 data, const moodycamel::ProducerToken& producterToken)
+	{
+		IncomingEvent::ConnectEvent connectEvent;
+		connectEvent.data = data;
+		connectEvent.outgoingConnection = outgoing;
+
+		IncomingEvent newEvent;
+		newEvent.peerId = m_firstId + peerId;
+		newEvent.data.emplace<IncomingEvent::ConnectEvent>(std::move(connectEvent));
+
+		m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+	}
+
 	void NetworkReactor::ReceivePackets(const moodycamel::ProducerToken& producterToken)
 	{
 		Nz::ENetEvent event;
@@ -219,6 +356,23 @@ namespace bw
 						Nz::UInt16 peerId = event.peer->GetPeerId();
 						m_clients[peerId] = nullptr;
 
+						// The owner never heard of pending peers
+						if (m_pendingPeers.Test(peerId))
+						{
+							auto it = std::find_if(m_pendingConnections.begin(), m_pendingConnections.end(), [&](const PendingConnection& pendingConnection) { return pendingConnection.peerId == peerId; });
+							assert(it != m_pendingConnections.end());
+
+							RemovePendingConnection(it);
+							m_simulatedPeers[peerId].reset();
+
+							m_connectionStatistics.abandonedConnections.fetch_add(1, std::memory_order_relaxed);
+							break;
+						}
+
+						// Packets held back by network simulation were received before the disconnection
+						UpdateSimulatedPeer(peerId, producterToken, std::numeric_limits<Nz::UInt64>::max());
+						m_simulatedPeers[peerId].reset();
+
 						IncomingEvent::DisconnectEvent disconnectEvent;
 						disconnectEvent.data = event.data;
 
@@ -235,16 +389,28 @@ namespace bw
 					{
 						Nz::UInt16 peerId = event.peer->GetPeerId();
 						m_clients[peerId] = event.peer;
+						m_simulatedPeers[peerId].reset();
 
-						IncomingEvent::ConnectEvent connectEvent;
-						connectEvent.data = event.data;
-						connectEvent.outgoingConnection = (event.type == Nz::ENetEventType::OutgoingConnect);
+						if (event.type == Nz::ENetEventType::IncomingConnect)
+						{
+							// Don't bother the owner with connections which may never send anything
+							if (m_connectionLimits)
+							{
+								RegisterPendingConnection(event.peer, event.data);
+								break;
+							}
 
-						IncomingEvent newEvent;
-						newEvent.peerId = m_firstId + peerId;
-						newEvent.data.emplace<IncomingEvent::ConnectEvent>(std::move(connectEvent));
+							if (CountClients() > m_maxClient)
+							{
+								event.peer->DisconnectNow(0);
+								m_clients[peerId] = nullptr;
 
-						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+								m_connectionStatistics.refusedConnections.fetch_add(1, std::memory_order_relaxed);
+								break;
+							}
+						}
+
+						NotifyConnection(peerId, event.type == Nz::ENetEventType::OutgoingConnect, event.data, producterToken);
 						break;
 					}
 
@@ -252,6 +418,15 @@ namespace bw
 					{
 						Nz::UInt16 peerId = event.peer->GetPeerId();
 
+						if (m_pendingPeers.Test(peerId) && !AcceptPendingConnection(peerId, producterToken))
+							break;
+
+						if (SimulatedPeer* simulatedPeer = RetrieveSimulatedPeer(peerId))
+						{
+							simulatedPeer->incoming.Push(Nz::GetElapsedMicroseconds(), event.channelId, event.packet->flags, std::move(event.packet->data));
+							break;
+						}
+
 						IncomingEvent::PacketEvent packetEvent;
 						packetEvent.packet = std::move(event.packet->data);
 
@@ -271,6 +446,84 @@ namespace bw
 		}
 	}
 
+	void NetworkReactor::RegisterPendingConnection(Nz::ENetPeer* peer, Nz::UInt32 data)
+	{
+		Nz::UInt16 peerId = peer->GetPeerId();
+		Nz::UInt64 now = Nz::GetElapsedMilliseconds();
+
+		// Limits are per address, a source can't get around them by changing port
+		Nz::IpAddress address = peer->GetAddress();
+		address.SetPort(0);
+
+		auto it = m_connectionSources.find(address);
+		if (it == m_connectionSources.end())
+			it = m_connectionSources.emplace(address, ConnectionSource{ TokenBucket(m_connectionLimits->addressRate, m_connectionLimits->addressBurst), now, 0 }).first;
+
+		ConnectionSource& source = it.value();
+		source.lastConnectionTime = now;
+
+		bool hasBudget = (m_connectionLimits->addressRate <= 0.f || source.budget.Consume(now));
+		if (!hasBudget || source.pendingConnectionCount >= m_connectionLimits->maxPendingConnectionsPerAddress)
+		{
+			peer->DisconnectNow(0);
+			m_clients[peerId] = nullptr;
+
+			m_connectionStatistics.refusedConnections.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		// Legitimate clients send their authentication right away, under a flood the oldest attempts are the ones to give up on
+		std::size_t maxPendingConnections = std::min(m_connectionLimits->maxPendingConnections, m_clients.size() / 2);
+		while (!m_pendingConnections.empty() && m_pendingConnections.size() >= maxPendingConnections)
+		{
+			std::size_t oldestPeerId = m_pendingConnections.front().peerId;
+			m_clients[oldestPeerId]->DisconnectNow(0);
+			m_clients[oldestPeerId] = nullptr;
+
+			RemovePendingConnection(m_pendingConnections.begin());
+
+			m_connectionStatistics.evictedConnections.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		source.pendingConnectionCount++;
+
+		PendingConnection& pendingConnection = m_pendingConnections.emplace_back();
+		pendingConnection.address = std::move(address);
+		pendingConnection.connectionTime = now;
+		pendingConnection.data = data;
+		pendingConnection.peerId = peerId;
+
+		m_pendingPeers.Set(peerId, true);
+		m_connectionStatistics.pendingConnections.store(m_pendingConnections.size(), std::memory_order_relaxed);
+	}
+
+	void NetworkReactor::RemovePendingConnection(std::vector<PendingConnection>::iterator it)
+	{
+		auto sourceIt = m_connectionSources.find(it->address);
+		assert(sourceIt != m_connectionSources.end());
+		assert(sourceIt->second.pendingConnectionCount > 0);
+		sourceIt.value().pendingConnectionCount--;
+
+		m_pendingPeers.Set(it->peerId, false);
+		m_pendingConnections.erase(it);
+
+		m_connectionStatistics.pendingConnections.store(m_pendingConnections.size(), std::memory_order_relaxed);
+	}
+
+	auto NetworkReactor::RetrieveSimulatedPeer(std::size_t peerId) -> SimulatedPeer*
+	{
+		std::optional<SimulatedPeer>& simulatedPeer = m_simulatedPeers[peerId];
+		if (!simulatedPeer)
+		{
+			if (!m_simulatedConditions)
+				return nullptr;
+
+			simulatedPeer.emplace(SimulatedPeer{ NetworkConditionSimulator(*m_simulatedConditions), NetworkConditionSimulator(*m_simulatedConditions) });
+		}
+
+		return &simulatedPeer.value();
+	}
+
 	void NetworkReactor::SendPackets(const moodycamel::ProducerToken& producterToken, moodycamel::ConsumerToken& token)
 	{
 		OutgoingEvent outEvent;
@@ -282,6 +535,9 @@ namespace bw
 				{
 					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
 					{
+						// Packets held back by network simulation were sent before the disconnection request
+						UpdateSimulatedPeer(outEvent.peerId, producterToken, std::numeric_limits<Nz::UInt64>::max());
+
 						switch (arg.type)
 						{
 							case DisconnectionType::Kick:
@@ -290,6 +546,7 @@ namespace bw
 
 								// DisconnectNow does not generate Disconnect event
 								m_clients[outEvent.peerId] = nullptr;
+								m_simulatedPeers[outEvent.peerId].reset();
 
 								IncomingEvent newEvent;
 								newEvent.peerId = m_firstId + outEvent.peerId;
@@ -318,7 +575,12 @@ namespace bw
 				else if constexpr (std::is_same_v<T, OutgoingEvent::PacketEvent>)
 				{
 					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
-						peer->Send(arg.channelId, arg.flags, std::move(arg.packet));
+					{
+						if (SimulatedPeer* simulatedPeer = RetrieveSimulatedPeer(outEvent.peerId))
+							simulatedPeer->outgoing.Push(Nz::GetElapsedMicroseconds(), arg.channelId, arg.flags, std::move(arg.packet));
+						else
+							peer->Send(arg.channelId, arg.flags, std::move(arg.packet));
+					}
 				}
 				else if constexpr (std::is_same_v<T, OutgoingEvent::QueryPeerInfo>)
 				{
@@ -340,10 +602,69 @@ namespace bw
 						m_incomingQueue.enqueue(producterToken, std::move(newEvent));
 					}
 				}
+				else if constexpr (std::is_same_v<T, OutgoingEvent::SetConnectionLimits>)
+				{
+					m_connectionLimits = arg.limits;
+				}
+				else if constexpr (std::is_same_v<T, OutgoingEvent::SimulateConditions>)
+				{
+					// Peers already simulated keep their simulator until their pending packets are delivered
+					if (!arg.conditions.IsPerfect())
+						m_simulatedConditions = arg.conditions;
+					else
+						m_simulatedConditions.reset();
+
+					for (auto& simulatedPeer : m_simulatedPeers)
+					{
+						if (simulatedPeer)
+						{
+							simulatedPeer->incoming.UpdateConditions(arg.conditions);
+							simulatedPeer->outgoing.UpdateConditions(arg.conditions);
+						}
+					}
+				}
+				else if constexpr (std::is_same_v<T, OutgoingEvent::StatusQueries>)
+				{
+					m_statusResponder = std::move(arg.responder);
+				}
 				else
 					static_assert(AlwaysFalse<T>::value, "non-exhaustive visitor");
 
 			}, outEvent.data);
 		}
 	}
+
+	void NetworkReactor::UpdateSimulatedPeer(std::size_t peerId, const moodycamel::ProducerToken& producterToken, Nz::UInt64 now)
+	{
+		std::optional<SimulatedPeer>& simulatedPeer = m_simulatedPeers[peerId];
+		if (!simulatedPeer)
+			return;
+
+		simulatedPeer->outgoing.Poll(now, [&](Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet)
+		{
+			if (Nz::ENetPeer* peer = m_clients[peerId])
+				peer->Send(channelId, flags, std::move(packet));
+		});
+
+		simulatedPeer->incoming.Poll(now, [&](Nz::UInt8 /*channelId*/, Nz::ENetPacketFlags /*flags*/, Nz::NetPacket&& packet)
+		{
+			IncomingEvent newEvent;
+			newEvent.peerId = m_firstId + peerId;
+			auto& packetEvent = newEvent.data.emplace<IncomingEvent::PacketEvent>();
+			packetEvent.packet = std::move(packet);
+
+			m_incomingQueue.enqueue(producterToken, std::move(newEvent));
+		});
+
+		// Simulation was disabled, get rid of the simulator once it has nothing left to deliver
+		if (!m_simulatedConditions && !simulatedPeer->incoming.HasPendingPackets() && !simulatedPeer->outgoing.HasPendingPackets())
+			simulatedPeer.reset();
+	}
+
+	void NetworkReactor::UpdateSimulatedPeers(const moodycamel::ProducerToken& producterToken)
+	{
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+		for (std::size_t peerId = 0; peerId < m_simulatedPeers.size(); ++peerId)
+			UpdateSimulatedPeer(peerId, producterToken, now);
+	}
 }
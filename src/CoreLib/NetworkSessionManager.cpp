@@ -3,6 +3,8 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/NetworkSessionManager.hpp>
+#include <CoreLib/BurgApp.hpp>
+#include <CoreLib/ConfigFile.hpp>
 #include <CoreLib/MatchClientSession.hpp>
 #include <CoreLib/NetworkSessionBridge.hpp>
 #include <CoreLib/Match.hpp>
@@ -13,8 +15,19 @@ namespace bw
 {
 	NetworkSessionManager::NetworkSessionManager(MatchSessions* owner, Nz::UInt16 port, std::size_t maxClient) :
 	SessionManager(owner),
-	m_reactor(0, Nz::NetProtocol_Any, port, maxClient)
+	m_reactor(0, Nz::NetProtocol_Any, port, maxClient, owner->GetMatch().GetApp().GetConfig().GetIntegerValue<std::size_t>("Network.ConnectionLimits.MaxPending")), //< pending peers get their own slots
+	m_lastConnectionReport(0)
 	{
+		const ConfigFile& config = owner->GetMatch().GetApp().GetConfig();
+
+		NetworkReactor::ConnectionLimits connectionLimits;
+		connectionLimits.addressBurst = config.GetFloatValue<float>("Network.ConnectionLimits.AddressBurst");
+		connectionLimits.addressRate = config.GetFloatValue<float>("Network.ConnectionLimits.AddressRate");
+		connectionLimits.maxPendingConnections = config.GetIntegerValue<std::size_t>("Network.ConnectionLimits.MaxPending");
+		connectionLimits.maxPendingConnectionsPerAddress = config.GetIntegerValue<std::size_t>("Network.ConnectionLimits.MaxPendingPerAddress");
+		connectionLimits.pendingTimeout = config.GetIntegerValue<Nz::UInt64>("Network.ConnectionLimits.PendingTimeout");
+
+		m_reactor.SetConnectionLimits(connectionLimits);
 	}
 
 	NetworkSessionManager::~NetworkSessionManager() = default;
@@ -24,6 +37,13 @@ namespace bw
 		m_reactor.Poll([&](bool outgoing, std::size_t peerId, Nz::UInt32 data) { HandlePeerConnection(outgoing, peerId, data); },
 		               [&](std::size_t peerId, Nz::UInt32 data) { HandlePeerDisconnection(peerId, data); },
 		               [&](std::size_t peerId, Nz::NetPacket&& packet) { HandlePeerPacket(peerId, std::move(packet)); });
+
+		Nz::UInt64 appTime = GetOwner()->GetMatch().GetApp().GetAppTime();
+		if (appTime - m_lastConnectionReport >= ConnectionReportInterval)
+		{
+			ReportConnectionStatistics();
+			m_lastConnectionReport = appTime;
+		}
 	}
 
 	void NetworkSessionManager::HandlePeerConnection(bool /*outgoing*/, std::size_t peerId, Nz::UInt32 /*data*/)
@@ -59,4 +79,18 @@ namespace bw
 		//bwLog(m_logger, LogLevel::Info, "Peer #{0} sent packet", peerId);
 		session->HandleIncomingPacket(packet);
 	}
+
+	void NetworkSessionManager::ReportConnectionStatistics()
+	{
+		NetworkReactor::ConnectionStatistics connectionStatistics = m_reactor.GetConnectionStatistics();
+
+		Nz::UInt64 refusedConnections = connectionStatistics.refusedConnections - m_lastConnectionStatistics.refusedConnections;
+		Nz::UInt64 evictedConnections = connectionStatistics.evictedConnections - m_lastConnectionStatistics.evictedConnections;
+		Nz::UInt64 expiredConnections = connectionStatistics.expiredConnections - m_lastConnectionStatistics.expiredConnections;
+
+		if (refusedConnections > 0 || evictedConnections > 0 || expiredConnections > 0)
+			bwLog(GetOwner()->GetMatch().GetLogger(), LogLevel::Warning, "Connection attempts dropped: {0} refused, {1} evicted, {2} expired ({3} pending)", refusedConnections, evictedConnections, expiredConnections, connectionStatistics.pendingConnections);
+
+		m_lastConnectionStatistics = connectionStatistics;
+	}
 }
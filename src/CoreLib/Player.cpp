@@ -131,42 +131,12 @@ namespace bw
 			{
 				if (m_playerEntity)
 				{
-					Terrain& terrain = m_match.GetTerrain();
-					Ndk::World& world = terrain.GetLayer(layerIndex).GetWorld();
-
-					const Ndk::EntityHandle& newPlayerEntity = world.CloneEntity(m_playerEntity);
-					/*const auto& componentBits = m_playerEntity->GetComponentBits();
-					for (std::size_t i = componentBits.FindFirst(); i != componentBits.npos; i = componentBits.FindNext(i))
+					// Player entity is moved along with its weapons, keeping their unique ids
+					m_match.MoveEntityToLayer(m_playerEntity, layerIndex, [ply = CreateHandle()](const Ndk::EntityHandle& oldEntity, const Ndk::EntityHandle& newEntity, LayerIndex previousLayerIndex)
 					{
-						// Leave physics component because dropping it during a physics callback would crash the physics engine
-						if (i != Ndk::GetComponentIndex<MatchComponent>() && i != Ndk::GetComponentIndex<Ndk::PhysicsComponent2D>())
-							newPlayerEntity->AddComponent(m_playerEntity->DropComponent(static_cast<Ndk::ComponentIndex>(i)));
-					}
-
-					newPlayerEntity->AddComponent(m_playerEntity->GetComponent<Ndk::PhysicsComponent2D>().Clone());*/
-
-					Nz::Int64 uniqueId = m_match.AllocateUniqueId();
-
-					newPlayerEntity->AddComponent<MatchComponent>(m_match, layerIndex, uniqueId);
-
-					m_match.RegisterEntity(uniqueId, newPlayerEntity);
-
-					UpdateControlledEntity(newPlayerEntity, true, true);
-
-					for (auto& weaponEntity : m_weapons)
-					{
-						Nz::Int64 weaponUniqueId = m_match.AllocateUniqueId();
-
-						weaponEntity = world.CloneEntity(weaponEntity);
-						weaponEntity->AddComponent<MatchComponent>(m_match, layerIndex, weaponUniqueId);
-						weaponEntity->GetComponent<Ndk::NodeComponent>().SetParent(newPlayerEntity);
-						weaponEntity->GetComponent<NetworkSyncComponent>().UpdateParent(newPlayerEntity);
-						weaponEntity->GetComponent<WeaponComponent>().UpdateOwner(newPlayerEntity);
-
-						m_match.RegisterEntity(weaponUniqueId, weaponEntity);
-					}
-
-					m_shouldSendWeapons = true;
+						if (ply)
+							ply->OnEntityLayerChange(oldEntity, newEntity, previousLayerIndex);
+					});
 				}
 			}
 			else
@@ -457,6 +427,61 @@ namespace bw
 		m_activeWeaponIndex = NoWeapon;
 	}
 
+	void Player::OnEntityLayerChange(const Ndk::EntityHandle& oldEntity, const Ndk::EntityHandle& newEntity, LayerIndex previousLayerIndex)
+	{
+		if (m_playerEntity == oldEntity)
+		{
+			MatchClientVisibility& visibility = m_session.GetVisibility();
+			visibility.SetEntityControlledStatus(previousLayerIndex, static_cast<Nz::UInt32>(oldEntity->GetId()), false);
+
+			m_playerEntity = newEntity;
+
+			// Health component has been moved with its signals, only the entity changed
+			m_onPlayerEntityDestruction.Connect(m_playerEntity->OnEntityDestruction, [this](Ndk::Entity* /*entity*/)
+			{
+				OnDeath(Ndk::EntityHandle::InvalidHandle);
+			});
+
+			LayerIndex layerIndex = m_playerEntity->GetComponent<MatchComponent>().GetLayerIndex();
+			visibility.SetEntityControlledStatus(layerIndex, static_cast<Nz::UInt32>(newEntity->GetId()), true);
+
+			Packets::ControlEntity controlEntity;
+			controlEntity.entityId = static_cast<Nz::UInt32>(newEntity->GetId());
+			controlEntity.layerIndex = layerIndex;
+			controlEntity.localIndex = m_localIndex;
+
+			visibility.PushEntityPacket(layerIndex, controlEntity.entityId, controlEntity);
+			return;
+		}
+
+		for (auto& weaponEntity : m_weapons)
+		{
+			if (weaponEntity == oldEntity)
+			{
+				weaponEntity = newEntity;
+				m_shouldSendWeapons = true;
+				break;
+			}
+		}
+	}
+
+	void Player::OnMapChange()
+	{
+		// Entities are destroyed along with the previous map, this isn't a death
+		m_onPlayerEntityDied.Disconnect();
+		m_onPlayerEntityDestruction.Disconnect();
+
+		m_playerEntity.Reset();
+		m_weapons.clear();
+		m_weaponByName.clear();
+		m_activeWeaponIndex = NoWeapon;
+		m_shouldSendWeapons = false;
+
+		// Session visibility is reset by the match, layers don't have to be hidden one by one
+		m_layerIndex = NoLayer;
+		m_visibleLayers.Clear();
+	}
+
 	void Player::SetReady()
 	{
 		assert(!m_isReady);
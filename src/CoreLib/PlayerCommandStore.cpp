@@ -3,18 +3,20 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <CoreLib/PlayerCommandStore.hpp>
+#include <CoreLib/ConfigFile.hpp>
 #include <CoreLib/MatchClientSession.hpp>
 #include <CoreLib/Protocol/Packets.hpp>
 
 namespace bw
 {
-	PlayerCommandStore::PlayerCommandStore(const Logger& logger) :
+	PlayerCommandStore::PlayerCommandStore(const Logger& logger, const ConfigFile& config) :
 	CommandStore(logger)
 	{
 #define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type>(#Type, [](MatchClientSession& session, Packets::Type&& packet) \
 { \
 	session.HandleIncomingPacket(std::move(packet)); \
 })
+#define IncomingCommandBudget(Type) SetIncomingCommandBudget<Packets::Type>(config.GetFloatValue<float>("Network.PacketBudgets." #Type ".Rate"), config.GetFloatValue<float>("Network.PacketBudgets." #Type ".Burst"))
 #define OutgoingCommand(Type, Flags, Channel) RegisterOutgoingCommand<Packets::Type>(#Type, Flags, Channel)
 
 		// Incoming commands
@@ -28,6 +30,12 @@ namespace bw
 		IncomingCommand(ScriptPacket);
 		IncomingCommand(UpdatePlayerName);
 
+		// Budgets of incoming commands triggering scripts callbacks or broadcasts
+		IncomingCommandBudget(PlayerChat);
+		IncomingCommandBudget(PlayerConsoleCommand);
+		IncomingCommandBudget(ScriptPacket);
+		IncomingCommandBudget(UpdatePlayerName);
+
 		// Outgoing commands
 		OutgoingCommand(AuthFailure,                  Nz::ENetPacketFlag_Reliable,    0);
 		OutgoingCommand(AuthSuccess,                  Nz::ENetPacketFlag_Reliable,    0);
@@ -44,12 +52,15 @@ namespace bw
 		OutgoingCommand(EntitiesAnimation,            Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(EntitiesDeath,                Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(EntitiesInputs,               Nz::ENetPacketFlag_Reliable,    1);
+		OutgoingCommand(EntitiesLayerChange,          Nz::ENetPacketFlag_Reliable,    1);
+		OutgoingCommand(EntitiesPropertyUpdate,       Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(EntityWeapon,                 Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(HealthUpdate,                 Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(InputTimingCorrection,        Nz::ENetPacketFlag_Unsequenced, 0);
+		OutgoingCommand(MapChange,                    Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(MatchData,                    Nz::ENetPacketFlag_Reliable,    0);
 		OutgoingCommand(MatchState,                   0,                              1);
-		OutgoingCommand(NetworkStrings,               Nz::ENetPacketFlag_Reliable,    0);
+		OutgoingCommand(NetworkStrings,               Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(PlayerJoined,                 Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(PlayerLayer,                  Nz::ENetPacketFlag_Reliable,    1);
 		OutgoingCommand(PlayerLeaving,                Nz::ENetPacketFlag_Reliable,    1);
@@ -59,6 +70,7 @@ namespace bw
 		OutgoingCommand(ScriptPacket,                 Nz::ENetPacketFlag_Reliable,    1);
 
 #undef IncomingCommand
+#undef IncomingCommandBudget
 #undef OutgoingCommand
 	}
 }
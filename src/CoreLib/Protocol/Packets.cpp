@@ -50,6 +50,8 @@ namespace bw
 
 			for (auto& player : data.players)
 				serializer &= player.nickname;
+
+			serializer &= data.layerCacheSize;
 		}
 
 		void Serialize(PacketSerializer& /*serializer*/, AuthFailure& /*data*/)
@@ -117,7 +119,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -126,17 +128,23 @@ namespace bw
 				serializer &= layer.entityCount;
 
 				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
 			}
 
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+				data.entities.resize(static_cast<std::size_t>(entityCount));
 
 			for (auto& entity : data.entities)
 			{
 				serializer &= entity.id;
-				Serialize(serializer, entity.data);
+
+				// Entity data starts and ends on a byte boundary, an encoding made separately can be spliced in
+				if (serializer.IsWriting() && entity.serializedData)
+					serializer.Write(entity.serializedData->GetConstBuffer(), entity.serializedData->GetSize());
+				else
+					Serialize(serializer, entity.data);
 			}
 		}
 
@@ -152,7 +160,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -161,12 +169,13 @@ namespace bw
 				serializer &= layer.entityCount;
 
 				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
 			}
 
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+				data.entities.resize(static_cast<std::size_t>(entityCount));
 
 			for (auto& entity : data.entities)
 			{
@@ -178,6 +187,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 			serializer &= data.layerIndex;
+			serializer &= data.keepEntities;
 		}
 
 		void Serialize(PacketSerializer& serializer, DownloadClientScriptRequest& data)
@@ -198,6 +208,11 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 			serializer &= data.layerIndex;
+			serializer &= data.isDelta;
+
+			serializer.SerializeArraySize(data.removedEntities);
+			for (auto& entityId : data.removedEntities)
+				serializer &= entityId;
 
 			serializer.SerializeArraySize(data.layerEntities);
 			for (auto& entity : data.layerEntities)
@@ -211,7 +226,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -220,12 +235,13 @@ namespace bw
 				serializer &= layer.entityCount;
 
 				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
 			}
 
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+				data.entities.resize(static_cast<std::size_t>(entityCount));
 
 			for (auto& entity : data.entities)
 			{
@@ -238,7 +254,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -247,12 +263,13 @@ namespace bw
 				serializer &= layer.entityCount;
 
 				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
 			}
 
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+				data.entities.resize(static_cast<std::size_t>(entityCount));
 
 			for (auto& entity : data.entities)
 			{
@@ -264,7 +281,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -273,12 +290,13 @@ namespace bw
 				serializer &= layer.entityCount;
 
 				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
 			}
 
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+				data.entities.resize(static_cast<std::size_t>(entityCount));
 
 			for (auto& entity : data.entities)
 			{
@@ -287,6 +305,85 @@ namespace bw
 			}
 		}
 
+		void Serialize(PacketSerializer& serializer, EntitiesLayerChange& data)
+		{
+			serializer &= data.stateTick;
+
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
+
+			serializer.SerializeArraySize(data.layers);
+			for (auto& layer : data.layers)
+			{
+				serializer &= layer.layerIndex;
+				serializer &= layer.newLayerIndex;
+				serializer &= layer.entityCount;
+
+				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
+			}
+
+			if (serializer.IsWriting())
+				assert(data.entities.size() == entityCount);
+			else
+				data.entities.resize(static_cast<std::size_t>(entityCount));
+
+			for (auto& entity : data.entities)
+			{
+				serializer &= entity.id;
+				serializer &= entity.newEntityId;
+
+				bool hasParent;
+				if (serializer.IsWriting())
+					hasParent = entity.newParentId.has_value();
+
+				serializer &= hasParent;
+
+				if (hasParent)
+				{
+					if (!serializer.IsWriting())
+						entity.newParentId.emplace();
+
+					serializer &= entity.newParentId.value();
+				}
+			}
+		}
+
+		void Serialize(PacketSerializer& serializer, EntitiesPropertyUpdate& data)
+		{
+			serializer &= data.stateTick;
+
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
+
+			serializer.SerializeArraySize(data.layers);
+			for (auto& layer : data.layers)
+			{
+				serializer &= layer.layerIndex;
+				serializer &= layer.entityCount;
+
+				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
+			}
+
+			if (serializer.IsWriting())
+				assert(data.entities.size() == entityCount);
+			else
+				data.entities.resize(static_cast<std::size_t>(entityCount));
+
+			for (auto& entity : data.entities)
+			{
+				serializer &= entity.id;
+
+				serializer.SerializeArraySize(entity.properties);
+				for (auto& property : entity.properties)
+				{
+					serializer &= property.index;
+					serializer &= property.isArray;
+
+					Serialize(serializer, property.value, property.isArray);
+				}
+			}
+		}
+
 		void Serialize(PacketSerializer& serializer, EntityWeapon& data)
 		{
 			serializer &= data.layerIndex;
@@ -299,7 +396,7 @@ namespace bw
 		{
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -308,12 +405,13 @@ namespace bw
 				serializer &= layer.entityCount;
 
 				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
 			}
 
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+				data.entities.resize(static_cast<std::size_t>(entityCount));
 
 			for (auto& entity : data.entities)
 			{
@@ -328,6 +426,32 @@ namespace bw
 			serializer &= data.tickError;
 		}
 
+		void Serialize(PacketSerializer& serializer, MapChange& data)
+		{
+			serializer &= data.stateTick;
+
+			serializer.SerializeArraySize(data.assets);
+			serializer.SerializeArraySize(data.fastDownloadUrls);
+
+			for (auto& downloadUrl : data.fastDownloadUrls)
+				serializer &= downloadUrl;
+
+			for (auto& asset : data.assets)
+			{
+				serializer &= asset.path;
+				serializer &= asset.size;
+
+				if (serializer.IsWriting())
+					serializer.Write(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+				else
+					serializer.Read(asset.sha1Checksum.data(), asset.sha1Checksum.size());
+			}
+
+			serializer.SerializeArraySize(data.layers);
+			for (auto& layer : data.layers)
+				serializer &= layer.backgroundColor;
+		}
+
 		void Serialize(PacketSerializer& serializer, MatchData& data)
 		{
 			serializer &= data.currentTick;
@@ -374,7 +498,7 @@ namespace bw
 
 			serializer &= data.stateTick;
 
-			Nz::UInt32 entityCount = 0;
+			Nz::UInt64 entityCount = 0; //< can't wrap around with malformed layer counts
 
 			serializer.SerializeArraySize(data.layers);
 			for (auto& layer : data.layers)
@@ -383,12 +507,13 @@ namespace bw
 				serializer &= layer.entityCount;
 
 				entityCount += layer.entityCount;
+				serializer.CheckArraySize(entityCount);
 			}
 
 			if (serializer.IsWriting())
 				assert(data.entities.size() == entityCount);
 			else
-				data.entities.resize(entityCount);
+				data.entities.resize(static_cast<std::size_t>(entityCount));
 
 			for (auto& entity : data.entities)
 			{
@@ -650,106 +775,109 @@ namespace bw
 			for (auto& property : data.properties)
 			{
 				serializer &= property.name;
+				serializer &= property.isArray;
 
-				// Serialize type
-				Nz::UInt8 dataType;
-				if (serializer.IsWriting())
-					dataType = static_cast<Nz::UInt8>(property.value.index());
+				Serialize(serializer, property.value, property.isArray);
+			}
+		}
 
-				serializer &= dataType;
-				serializer &= property.isArray;
+		void Serialize(PacketSerializer& serializer, Helper::Properties::PropertyValue& value, bool isArray)
+		{
+			// Serialize type
+			Nz::UInt8 dataType;
+			if (serializer.IsWriting())
+				dataType = static_cast<Nz::UInt8>(value.index());
+
+			serializer &= dataType;
 
-				// Read/write value
+			// Waiting for template lambda in C++20
+			auto SerializeValue = [&](auto dummyType)
+			{
+				using T = std::decay_t<decltype(dummyType)>;
+
+				auto& elements = (serializer.IsWriting()) ? std::get<std::vector<T>>(value) : value.emplace<std::vector<T>>();
 
-				// Waiting for template lambda in C++20
-				auto SerializeValue = [&](auto dummyType)
+				if (isArray)
+				{
+					serializer.SerializeArraySize(elements);
+					for (auto& element : elements)
+						serializer &= element;
+				}
+				else
 				{
-					using T = std::decay_t<decltype(dummyType)>;
+					assert(!serializer.IsWriting() || elements.size() == 1);
+					if (!serializer.IsWriting())
+						elements.resize(1);
+
+					serializer &= elements.front();
+				}
+			};
 
-					auto& elements = (serializer.IsWriting()) ? std::get<std::vector<T>>(property.value) : property.value.emplace<std::vector<T>>();
 
-					if (property.isArray)
+			static_assert(std::variant_size_v<Helper::Properties::PropertyValue> == 10);
+			switch (dataType)
+			{
+				case 0:
+				{
+					// Handle std::vector<bool> specialization
+					auto& elements = (serializer.IsWriting()) ? std::get<std::vector<bool>>(value) : value.emplace<std::vector<bool>>();
+
+					serializer.SerializeArraySize(elements);
+					if (serializer.IsWriting())
 					{
-						serializer.SerializeArraySize(elements);
-						for (auto& element : elements)
-							serializer &= element;
+						for (bool val : elements)
+							serializer &= val;
 					}
 					else
 					{
-						assert(!serializer.IsWriting() || elements.size() == 1);
-						if (!serializer.IsWriting())
-							elements.resize(1);
+						for (std::size_t i = 0; i < elements.size(); ++i)
+						{
+							bool val;
+							serializer &= val;
 
-						serializer &= elements.front();
+							elements[i] = val;
+						}
 					}
-				};
 
+					break;
+				}
+
+				case 1: SerializeValue(float()); break;
+				case 2: SerializeValue(Nz::Int64()); break;
+				case 3: SerializeValue(Nz::Vector2f()); break;
+				case 4: SerializeValue(Nz::Vector2i64()); break;
+				case 5: SerializeValue(Nz::Vector3f()); break;
+				case 6: SerializeValue(Nz::Vector3i64()); break;
+				case 7: SerializeValue(Nz::Vector4f()); break;
+				case 8: SerializeValue(Nz::Vector4i64()); break;
 
-				static_assert(std::variant_size_v<Helper::Properties::PropertyValue> == 10);
-				switch (dataType)
+				case 9: // std::string
 				{
-					case 0:
-					{
-						// Handle std::vector<bool> specialization
-						auto& elements = (serializer.IsWriting()) ? std::get<std::vector<bool>>(property.value) : property.value.emplace<std::vector<bool>>();
+					auto& elements = (serializer.IsWriting()) ? std::get<std::vector<std::string>>(value) : value.emplace<std::vector<std::string>>();
 
-						serializer.SerializeArraySize(elements);
-						if (serializer.IsWriting())
-						{
-							for (bool val : elements)
-								serializer &= val;
-						}
-						else
+					serializer.SerializeArraySize(elements);
+					if (serializer.IsWriting())
+					{
+						for (const auto& element : elements)
 						{
-							for (std::size_t i = 0; i < elements.size(); ++i)
-							{
-								bool val;
-								serializer &= val;
-
-								elements[i] = val;
-							}
+							serializer.SerializeArraySize(element);
+							serializer.Write(element.data(), element.size());
 						}
-
-						break;
 					}
-
-					case 1: SerializeValue(float()); break;
-					case 2: SerializeValue(Nz::Int64()); break;
-					case 3: SerializeValue(Nz::Vector2f()); break;
-					case 4: SerializeValue(Nz::Vector2i64()); break;
-					case 5: SerializeValue(Nz::Vector3f()); break;
-					case 6: SerializeValue(Nz::Vector3i64()); break;
-					case 7: SerializeValue(Nz::Vector4f()); break;
-					case 8: SerializeValue(Nz::Vector4i64()); break;
-
-					case 9: // std::string
+					else
 					{
-						auto& elements = (serializer.IsWriting()) ? std::get<std::vector<std::string>>(property.value) : property.value.emplace<std::vector<std::string>>();
-
-						serializer.SerializeArraySize(elements);
-						if (serializer.IsWriting())
-						{
-							for (const auto& element : elements)
-							{
-								serializer.SerializeArraySize(element);
-								serializer.Write(element.data(), element.size());
-							}
-						}
-						else
+						for (auto& element : elements)
 						{
-							for (auto& element : elements)
-							{
-								serializer.SerializeArraySize(element);
-								serializer.Read(element.data(), element.size());
-							}
+							serializer.SerializeArraySize(element);
+							serializer.Read(element.data(), element.size());
 						}
-						break;
 					}
-
-					default:
-						assert(!"Unexpected datatype");
-						break;
+					break;
 				}
+
+				default:
+					assert(!"Unexpected datatype");
+					break;
 			}
 		}
 	}
@@ -0,0 +1,131 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Scripting/LuaAllocator.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace bw
+{
+	void* LuaAllocator::Allocate(void* userdata, void* ptr, std::size_t oldSize, std::size_t newSize)
+	{
+		LuaAllocator* allocator = static_cast<LuaAllocator*>(userdata);
+		return allocator->Reallocate(ptr, (ptr) ? oldSize : 0, newSize); //< when ptr is null, oldSize holds the Lua type of the object
+	}
+
+	void* LuaAllocator::AllocateFromPool(std::size_t sizeClass)
+	{
+		assert(sizeClass < SizeClassCount);
+
+		if (FreeSlot* slot = m_freeSlots[sizeClass])
+		{
+			m_freeSlots[sizeClass] = slot->next;
+			return slot;
+		}
+
+		// Carve a new slot from the current page, pages are only released with the allocator
+		std::size_t slotSize = (sizeClass + 1) * PoolGranularity;
+		if (m_pageOffset + slotSize > PoolPageSize)
+		{
+			std::unique_ptr<Nz::UInt8[]> page(new (std::nothrow) Nz::UInt8[PoolPageSize]);
+			if (!page)
+				return nullptr;
+
+			m_pages.emplace_back(std::move(page));
+			m_pageOffset = 0;
+		}
+
+		void* slot = &m_pages.back()[m_pageOffset];
+		m_pageOffset += slotSize;
+
+		return slot;
+	}
+
+	void LuaAllocator::FreeToPool(void* ptr, std::size_t sizeClass)
+	{
+		assert(sizeClass < SizeClassCount);
+
+		FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+		slot->next = m_freeSlots[sizeClass];
+		m_freeSlots[sizeClass] = slot;
+	}
+
+	void* LuaAllocator::Reallocate(void* ptr, std::size_t oldSize, std::size_t newSize)
+	{
+		std::size_t oldClass = (ptr) ? GetSizeClass(oldSize) : Unpooled;
+
+		if (newSize == 0)
+		{
+			if (ptr)
+			{
+				if (oldClass != Unpooled)
+					FreeToPool(ptr, oldClass);
+				else
+					std::free(ptr);
+
+				m_memoryUsage -= oldSize;
+			}
+
+			return nullptr;
+		}
+
+		// Returning null makes Lua run an emergency collection before raising a memory error
+		if (m_memoryLimit > 0 && newSize > oldSize && m_memoryUsage + (newSize - oldSize) > m_memoryLimit)
+			return nullptr;
+
+		std::size_t newClass = GetSizeClass(newSize);
+
+		// Lua requires shrinking a block to never fail, the original block is kept when no smaller one can be allocated.
+		// It will be freed as the smaller size class later, which is fine as it's at least as big as the slots of that class.
+		bool isShrinking = (ptr && newSize <= oldSize);
+
+		void* newPtr;
+		if (ptr && oldClass == newClass)
+		{
+			if (newClass == Unpooled)
+			{
+				newPtr = std::realloc(ptr, newSize);
+				if (!newPtr)
+				{
+					if (!isShrinking)
+						return nullptr;
+
+					newPtr = ptr;
+				}
+			}
+			else
+				newPtr = ptr; //< Slot is big enough
+		}
+		else
+		{
+			newPtr = (newClass != Unpooled) ? AllocateFromPool(newClass) : std::malloc(newSize);
+			if (!newPtr)
+			{
+				if (!isShrinking)
+					return nullptr;
+
+				newPtr = ptr;
+			}
+			else if (ptr)
+			{
+				std::memcpy(newPtr, ptr, std::min(oldSize, newSize));
+
+				if (oldClass != Unpooled)
+					FreeToPool(ptr, oldClass);
+				else
+					std::free(ptr);
+			}
+		}
+
+		if (newSize > oldSize)
+			m_allocatedBytes += newSize - oldSize;
+
+		m_memoryUsage = m_memoryUsage - oldSize + newSize;
+		m_peakMemoryUsage = std::max(m_peakMemoryUsage, m_memoryUsage);
+
+		return newPtr;
+	}
+}
@@ -6,7 +6,10 @@
 #include <CoreLib/Scripting/SharedScriptingLibrary.hpp>
 #include <CoreLib/SharedMatch.hpp>
 #include <CoreLib/Utils.hpp>
+#include <Nazara/Core/AbstractHash.hpp>
+#include <Nazara/Core/ByteArray.hpp>
 #include <Nazara/Core/CallOnExit.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <Nazara/Core/File.hpp>
 #include <filesystem>
 
@@ -15,6 +18,18 @@ namespace bw
 	namespace
 	{
 		std::size_t MaxInactiveCoroutines = 50;
+		int GarbageCollectorStepSize = 16; //< KiB
+		Nz::UInt64 MemoryWarningInterval = 10'000'000; //< us
+		float MemoryWarningThreshold = 0.9f;
+
+		Nz::ByteArray ComputeBytecodeDigest(const std::vector<Nz::UInt8>& bytecode)
+		{
+			auto hash = Nz::AbstractHash::Get(Nz::HashType_SHA1);
+			hash->Begin();
+			hash->Append(bytecode.data(), bytecode.size());
+
+			return hash->End();
+		}
 	}
 
 	ScriptingContext::~ScriptingContext()
@@ -23,6 +38,13 @@ namespace bw
 		m_runningThreads.clear();
 	}
 
+	void ScriptingContext::EnableManualGarbageCollection(bool enable)
+	{
+		// Stopping the collector prevents allocations from triggering collection steps, StepGarbageCollector has to be called regularly
+		lua_gc(m_luaState, (enable) ? LUA_GCSTOP : LUA_GCRESTART, 0);
+		m_manualGarbageCollection = enable;
+	}
+
 	bool ScriptingContext::Load(const std::filesystem::path& folderOrFile)
 	{
 		VirtualDirectory::Entry entry;
@@ -47,10 +69,8 @@ namespace bw
 				m_currentFile = folderOrFile;
 				m_currentFolder = folderOrFile.parent_path();
 
-				sol::state& state = GetLuaState();
-				sol::protected_function_result result;
 				if constexpr (std::is_same_v<T, VirtualDirectory::FileContentEntry>)
-					result = state.do_string(std::string_view(reinterpret_cast<const char*>(arg.data()), arg.size()), folderOrFile.generic_string());
+					return Execute(std::string_view(reinterpret_cast<const char*>(arg.data()), arg.size()), folderOrFile);
 				else if constexpr (std::is_same_v<T, VirtualDirectory::PhysicalFileEntry>)
 				{
 					std::vector<Nz::UInt8> content;
@@ -69,22 +89,10 @@ namespace bw
 						return false;
 					}
 
-					result = state.do_string(std::string_view(reinterpret_cast<const char*>(content.data()), content.size()), folderOrFile.generic_string());
+					return Execute(std::string_view(reinterpret_cast<const char*>(content.data()), content.size()), folderOrFile);
 				}
 				else
 					static_assert(AlwaysFalse<T>::value, "non-exhaustive if");
-
-				if (result.valid())
-				{
-					bwLog(m_logger, LogLevel::Info, "Loaded {0}", folderOrFile.generic_u8string());
-					return true;
-				}
-				else
-				{
-					sol::error err = result;
-					bwLog(m_logger, LogLevel::Error, "Failed to load {0}: {1}", folderOrFile.generic_u8string(), err.what());
-					return false;
-				}
 			}
 			else if constexpr (std::is_same_v<T, VirtualDirectory::VirtualDirectoryEntry>)
 			{
@@ -115,6 +123,48 @@ namespace bw
 			library->RegisterLibrary(*this);
 	}
 
+	void ScriptingContext::StepGarbageCollector(float maxDuration)
+	{
+		Nz::UInt64 startTime = Nz::GetElapsedMicroseconds();
+
+		if (m_manualGarbageCollection)
+		{
+			Nz::UInt64 maxDurationUs = static_cast<Nz::UInt64>(std::max(maxDuration, 0.f) * 1'000'000.f);
+
+			// Always do at least one step so memory cannot grow unbounded when there's no idle time
+			do
+			{
+				if (lua_gc(m_luaState, LUA_GCSTEP, GarbageCollectorStepSize) != 0)
+					break; //< cycle finished
+			}
+			while (Nz::GetElapsedMicroseconds() - startTime < maxDurationUs);
+		}
+
+		std::size_t memoryLimit = m_allocator.GetMemoryLimit();
+		if (memoryLimit > 0 && m_allocator.GetMemoryUsage() > memoryLimit * MemoryWarningThreshold && startTime - m_lastMemoryWarning > MemoryWarningInterval)
+		{
+			m_lastMemoryWarning = startTime;
+
+			const std::string* topOwner = nullptr;
+			std::size_t topAllocatedBytes = 0;
+			m_allocator.ForEachOwnerAllocation([&](const std::string& ownerName, std::size_t allocatedBytes)
+			{
+				if (allocatedBytes > topAllocatedBytes)
+				{
+					topOwner = &ownerName;
+					topAllocatedBytes = allocatedBytes;
+				}
+			});
+
+			if (topOwner)
+				bwLog(m_logger, LogLevel::Warning, "Lua memory usage is close to its limit ({0} / {1} KiB), top allocating element: {2} ({3} KiB allocated)", m_allocator.GetMemoryUsage() / 1024, memoryLimit / 1024, *topOwner, topAllocatedBytes / 1024);
+			else
+				bwLog(m_logger, LogLevel::Warning, "Lua memory usage is close to its limit ({0} / {1} KiB)", m_allocator.GetMemoryUsage() / 1024, memoryLimit / 1024);
+
+			m_allocator.ResetOwnerStatistics();
+		}
+	}
+
 	void ScriptingContext::Update()
 	{
 		for (auto it = m_runningThreads.begin(); it != m_runningThreads.end();)
@@ -151,6 +201,40 @@ namespace bw
 		}
 	}
 
+	sol::load_result ScriptingContext::CompileChunk(const std::string_view& source, const std::string& chunkName)
+	{
+		sol::state& state = GetLuaState();
+
+		// Compiled chunks embed their name (used in error messages), it's part of the key
+		auto hash = Nz::AbstractHash::Get(Nz::HashType_SHA1);
+		hash->Begin();
+		hash->Append(reinterpret_cast<const Nz::UInt8*>(chunkName.data()), chunkName.size() + 1);
+		hash->Append(reinterpret_cast<const Nz::UInt8*>(source.data()), source.size());
+
+		std::string cacheKey = hash->End().ToHex().ToStdString();
+
+		if (const std::vector<Nz::UInt8>* bytecode = RetrieveBytecode(cacheKey))
+		{
+			sol::load_result loadResult = state.load_buffer(reinterpret_cast<const char*>(bytecode->data()), bytecode->size(), chunkName, sol::load_mode::binary);
+			if (loadResult.valid())
+				return loadResult;
+
+			// Cache entry may have been produced by another Lua version, compile again
+			bwLog(m_logger, LogLevel::Warning, "Failed to load cached bytecode of {0}, recompiling it", chunkName);
+			m_bytecodeCache.erase(cacheKey);
+		}
+
+		// Only load text chunks from sources, downloaded scripts should never be able to provide bytecode
+		sol::load_result loadResult = state.load_buffer(source.data(), source.size(), chunkName, sol::load_mode::text);
+		if (loadResult.valid())
+		{
+			sol::protected_function chunk = loadResult;
+			StoreBytecode(cacheKey, chunk);
+		}
+
+		return loadResult;
+	}
+
 	sol::thread& ScriptingContext::CreateThread()
 	{
 		auto AllocateThread = [&]() -> sol::thread&
@@ -169,4 +253,121 @@ namespace bw
 
 		return (!m_availableThreads.empty()) ? PopThread() : AllocateThread();
 	}
+
+	bool ScriptingContext::Execute(const std::string_view& source, const std::filesystem::path& path)
+	{
+		sol::load_result loadResult = CompileChunk(source, path.generic_string());
+		if (!loadResult.valid())
+		{
+			sol::error err = loadResult;
+			bwLog(m_logger, LogLevel::Error, "Failed to load {0}: {1}", path.generic_u8string(), err.what());
+			return false;
+		}
+
+		sol::protected_function chunk = loadResult;
+
+		sol::protected_function_result result = chunk();
+		if (!result.valid())
+		{
+			sol::error err = result;
+			bwLog(m_logger, LogLevel::Error, "Failed to load {0}: {1}", path.generic_u8string(), err.what());
+			return false;
+		}
+
+		bwLog(m_logger, LogLevel::Info, "Loaded {0}", path.generic_u8string());
+		return true;
+	}
+
+	const std::vector<Nz::UInt8>* ScriptingContext::RetrieveBytecode(const std::string& cacheKey)
+	{
+		if (auto it = m_bytecodeCache.find(cacheKey); it != m_bytecodeCache.end())
+			return &it.value();
+
+		if (!m_bytecodeCacheFolder)
+			return nullptr;
+
+		std::filesystem::path cachePath = *m_bytecodeCacheFolder / (cacheKey + ".luac");
+		if (!std::filesystem::is_regular_file(cachePath))
+			return nullptr;
+
+		Nz::File cacheFile(cachePath.generic_u8string());
+		if (!cacheFile.Open(Nz::OpenMode_ReadOnly))
+			return nullptr;
+
+		// Cache files start with the SHA1 of their bytecode, which is checked before Lua ever sees it
+		Nz::ByteArray digest(Nz::AbstractHash::Get(Nz::HashType_SHA1)->GetDigestLength(), 0);
+		Nz::UInt64 fileSize = cacheFile.GetSize();
+		if (fileSize <= digest.GetSize() || cacheFile.Read(digest.GetBuffer(), digest.GetSize()) != digest.GetSize())
+		{
+			bwLog(m_logger, LogLevel::Warning, "Failed to read bytecode cache file {0}", cachePath.generic_u8string());
+			return nullptr;
+		}
+
+		std::vector<Nz::UInt8> bytecode(fileSize - digest.GetSize());
+		if (cacheFile.Read(bytecode.data(), bytecode.size()) != bytecode.size())
+		{
+			bwLog(m_logger, LogLevel::Warning, "Failed to read bytecode cache file {0}", cachePath.generic_u8string());
+			return nullptr;
+		}
+
+		if (ComputeBytecodeDigest(bytecode) != digest)
+		{
+			// Truncated or corrupted, it will be written again once the chunk is compiled
+			bwLog(m_logger, LogLevel::Warning, "Bytecode cache file {0} is corrupted, ignoring it", cachePath.generic_u8string());
+			return nullptr;
+		}
+
+		auto it = m_bytecodeCache.emplace(cacheKey, std::move(bytecode)).first;
+		return &it.value();
+	}
+
+	void ScriptingContext::StoreBytecode(const std::string& cacheKey, const sol::protected_function& chunk)
+	{
+		std::vector<Nz::UInt8> bytecode;
+		int errCode = chunk.dump([](lua_State* /*L*/, const void* data, std::size_t size, void* userdata) -> int
+		{
+			auto& bytecode = *static_cast<std::vector<Nz::UInt8>*>(userdata);
+
+			const Nz::UInt8* bytes = static_cast<const Nz::UInt8*>(data);
+			bytecode.insert(bytecode.end(), bytes, bytes + size);
+
+			return 0;
+		}, &bytecode, false, &sol::dump_pass_on_error);
+
+		if (errCode != 0)
+		{
+			bwLog(m_logger, LogLevel::Warning, "Failed to dump bytecode (error code {0})", errCode);
+			return;
+		}
+
+		if (m_bytecodeCacheFolder)
+		{
+			std::error_code ec;
+			std::filesystem::create_directories(*m_bytecodeCacheFolder, ec);
+
+			std::filesystem::path cachePath = *m_bytecodeCacheFolder / (cacheKey + ".luac");
+			std::filesystem::path tempPath = *m_bytecodeCacheFolder / (cacheKey + ".luac.tmp");
+
+			Nz::ByteArray digest = ComputeBytecodeDigest(bytecode);
+
+			// Write to a temporary file first so an interrupted write never leaves a partial cache file behind
+			Nz::File cacheFile(tempPath.generic_u8string(), Nz::OpenMode_WriteOnly | Nz::OpenMode_Truncate);
+			bool written = cacheFile.IsOpen() &&
+			               cacheFile.Write(digest.GetConstBuffer(), digest.GetSize()) == digest.GetSize() &&
+			               cacheFile.Write(bytecode.data(), bytecode.size()) == bytecode.size();
+
+			cacheFile.Close();
+
+			if (written)
+				std::filesystem::rename(tempPath, cachePath, ec);
+
+			if (!written || ec)
+			{
+				bwLog(m_logger, LogLevel::Warning, "Failed to write bytecode cache file {0}", cachePath.generic_u8string());
+				std::filesystem::remove(tempPath, ec);
+			}
+		}
+
+		m_bytecodeCache.emplace(cacheKey, std::move(bytecode));
+	}
 }
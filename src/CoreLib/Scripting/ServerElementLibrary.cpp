@@ -7,6 +7,7 @@
 #include <CoreLib/Components/MatchComponent.hpp>
 #include <CoreLib/Components/NetworkSyncComponent.hpp>
 #include <CoreLib/Components/OwnerComponent.hpp>
+#include <CoreLib/Components/PlayerControlledComponent.hpp>
 #include <CoreLib/Components/ScriptComponent.hpp>
 #include <CoreLib/Match.hpp>
 #include <CoreLib/Player.hpp>
@@ -61,28 +62,27 @@ namespace bw
 			Ndk::EntityHandle entity = AbstractElementLibrary::AssertScriptEntity(table);
 
 			auto& entityScript = entity->GetComponent<ScriptComponent>();
+			const auto& entityElement = entityScript.GetElement();
 
-			auto propertyVal = entityScript.GetProperty(propertyName);
-			if (propertyVal.has_value())
-			{
-				sol::state_view lua(s);
-				const EntityProperty& property = propertyVal.value();
+			auto propertyIt = entityElement->properties.find(propertyName);
+			if (propertyIt == entityElement->properties.end())
+				return sol::nil;
 
-				Match* match;
-				if (entity->HasComponent<MatchComponent>())
-					match = &entity->GetComponent<MatchComponent>().GetMatch();
-				else
-					match = nullptr;
+			const auto& propertyInfo = propertyIt->second;
 
-				const auto& entityElement = entityScript.GetElement();
-				
-				auto propertyIt = entityElement->properties.find(propertyName);
-				assert(propertyIt != entityElement->properties.end());
+			const EntityProperty* property = entityScript.GetProperty(propertyInfo.index);
+			if (!property)
+				return sol::nil;
 
-				return TranslateEntityPropertyToLua(match, lua, property, propertyIt->second.type);
-			}
+			sol::state_view lua(s);
+
+			Match* match;
+			if (entity->HasComponent<MatchComponent>())
+				match = &entity->GetComponent<MatchComponent>().GetMatch();
 			else
-				return sol::nil;
+				match = nullptr;
+
+			return TranslateEntityPropertyToLua(match, lua, *property, propertyInfo.type);
 		};
 
 		elementTable["GetOwner"] = [](sol::this_state s, const sol::table& table) -> sol::object
@@ -95,6 +95,49 @@ namespace bw
 			return sol::make_object(s, entity->GetComponent<OwnerComponent>().GetOwner()->CreateHandle());
 		};
 
+		elementTable["MoveToLayer"] = [](const sol::table& entityTable, LayerIndex layerIndex)
+		{
+			Ndk::EntityHandle entity = AbstractElementLibrary::AssertScriptEntity(entityTable);
+
+			Match& match = entity->GetComponent<MatchComponent>().GetMatch();
+			if (layerIndex >= match.GetLayerCount())
+				throw std::runtime_error("Layer index out of range");
+
+			// Controlled entities move with their player
+			if (entity->HasComponent<PlayerControlledComponent>())
+			{
+				if (Player* owner = entity->GetComponent<PlayerControlledComponent>().GetOwner())
+				{
+					owner->MoveToLayer(layerIndex);
+					return;
+				}
+			}
+
+			match.MoveEntityToLayer(entity, layerIndex);
+		};
+
+		elementTable["SetProperty"] = [](const sol::table& entityTable, const std::string& propertyName, const sol::object& value)
+		{
+			Ndk::EntityHandle entity = AbstractElementLibrary::AssertScriptEntity(entityTable);
+
+			auto& entityScript = entity->GetComponent<ScriptComponent>();
+			const auto& entityElement = entityScript.GetElement();
+
+			auto propertyIt = entityElement->properties.find(propertyName);
+			if (propertyIt == entityElement->properties.end())
+				throw std::runtime_error("Entity has no property \"" + propertyName + "\"");
+
+			const auto& propertyInfo = propertyIt->second;
+
+			Match* match;
+			if (entity->HasComponent<MatchComponent>())
+				match = &entity->GetComponent<MatchComponent>().GetMatch();
+			else
+				match = nullptr;
+
+			entityScript.SetProperty(propertyInfo.index, TranslateEntityPropertyFromLua(match, value, propertyInfo.type, propertyInfo.isArray));
+		};
+
 		elementTable["SetParent"] = [](const sol::table& entityTable, const sol::table& parentTable)
 		{
 			Ndk::EntityHandle entity = AbstractElementLibrary::AssertScriptEntity(entityTable);
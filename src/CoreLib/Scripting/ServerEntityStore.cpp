@@ -6,6 +6,7 @@
 #include <NDK/Components.hpp>
 #include <Nazara/Utility/Image.hpp>
 #include <CoreLib/TerrainLayer.hpp>
+#include <CoreLib/Utils.hpp>
 #include <CoreLib/Components/HealthComponent.hpp>
 #include <CoreLib/Components/MatchComponent.hpp>
 #include <CoreLib/Components/NetworkSyncComponent.hpp>
@@ -84,11 +85,81 @@ namespace bw
 		return entity;
 	}
 
+	Ndk::EntityHandle ServerEntityStore::RecycleEntity(TerrainLayer& layer, std::size_t entityIndex, Nz::Int64 uniqueId, const Nz::Vector2f& position, const Nz::DegreeAnglef& rotation, const EntityProperties& properties, const Ndk::EntityHandle& parent) const
+	{
+		const auto& entityClass = GetElement(entityIndex);
+		if (!entityClass->entityPool)
+			return Ndk::EntityHandle::InvalidHandle;
+
+		EntityPropertyContainer entityProperties = BuildEntityProperties(*entityClass, properties);
+
+		Ndk::EntityHandle entity = layer.AcquirePooledEntity(entityClass->fullName);
+		if (!entity)
+			return Ndk::EntityHandle::InvalidHandle;
+
+		bool hasInputs = entityClass->elementTable.get_or("HasInputs", false);
+		bool playerControlled = entityClass->elementTable.get_or("PlayerControlled", false);
+
+		// Element may have been reloaded since the entity was pooled, only reuse it if it still has the same components
+		bool hasHealth = entity->HasComponent<HealthComponent>();
+		if (hasHealth != (entityClass->maxHealth > 0) || (hasHealth && entity->GetComponent<HealthComponent>().GetMaxHealth() != entityClass->maxHealth) ||
+		    entity->HasComponent<NetworkSyncComponent>() != entityClass->isNetworked ||
+		    entity->HasComponent<PlayerMovementComponent>() != playerControlled ||
+		    entity->HasComponent<InputComponent>() != hasInputs)
+		{
+			entity->Kill();
+			return Ndk::EntityHandle::InvalidHandle;
+		}
+
+		// Scripts may still hold the previous instance, it keeps its (detached) table and unique id
+		entity->GetComponent<MatchComponent>().UpdateUniqueId(uniqueId);
+		entity->GetComponent<ScriptComponent>().Recycle(entityClass, CreateEntityTable(*entityClass), std::move(entityProperties));
+
+		auto& node = entity->GetComponent<Ndk::NodeComponent>();
+		node.SetPosition(position);
+		node.SetRotation(rotation);
+
+		if (parent)
+			node.SetParent(parent);
+		else
+			node.SetParent(static_cast<Nz::Node*>(nullptr));
+
+		if (entity->HasComponent<Ndk::PhysicsComponent2D>())
+		{
+			// Initialize may keep the previous body, put it back in place
+			auto& entityPhys = entity->GetComponent<Ndk::PhysicsComponent2D>();
+			entityPhys.SetPosition(Nz::Vector2f(node.GetPosition(Nz::CoordSys_Global)));
+			entityPhys.SetRotation(AngleFromQuaternion(node.GetRotation(Nz::CoordSys_Global)));
+			entityPhys.SetAngularVelocity(Nz::RadianAnglef::Zero());
+			entityPhys.SetVelocity(Nz::Vector2f::Zero());
+		}
+
+		if (hasHealth)
+			entity->GetComponent<HealthComponent>().ResetHealth();
+
+		if (entityClass->isNetworked)
+		{
+			auto& networkSync = entity->GetComponent<NetworkSyncComponent>();
+			networkSync.UpdateParent((parent && parent->HasComponent<NetworkSyncComponent>()) ? parent : Ndk::EntityHandle::InvalidHandle);
+		}
+
+		entity->Enable();
+
+		if (!InitializeEntity(*entityClass, entity))
+			entity->Kill();
+
+		bwLog(GetLogger(), LogLevel::Debug, "Recycled entity {} on layer {} of type {}", uniqueId, layer.GetLayerIndex(), entityClass->fullName);
+
+		return entity;
+	}
+
 	void ServerEntityStore::InitializeElementTable(sol::table& elementTable)
 	{
 		SharedEntityStore::InitializeElementTable(elementTable);
 
 		elementTable["IsNetworked"] = false;
+		elementTable["Poolable"] = false;
+		elementTable["PoolSize"] = DefaultPoolSize;
 	}
 
 	void ServerEntityStore::InitializeElement(sol::table& elementTable, ScriptedEntity& element)
@@ -97,5 +168,36 @@ namespace bw
 
 		element.isNetworked = elementTable["IsNetworked"];
 		element.maxHealth = elementTable.get_or("MaxHealth", Nz::UInt16(0));
+
+		if (elementTable.get_or("Poolable", false))
+		{
+			element.resetFunction = elementTable["OnReset"];
+
+			auto& entityPool = m_entityPools[element.fullName];
+			if (!entityPool)
+				entityPool = std::make_shared<ScriptedElement::EntityPool>();
+
+			entityPool->capacity = elementTable.get_or("PoolSize", DefaultPoolSize);
+
+			auto& entityTables = entityPool->entityTables;
+			if (entityTables.size() > entityPool->capacity)
+				entityTables.erase(entityTables.begin() + entityPool->capacity, entityTables.end());
+
+			// Prewarm pool so the first wave of entities doesn't have to create their tables
+			sol::state& state = GetLuaState();
+
+			entityTables.reserve(entityPool->capacity);
+			while (entityTables.size() < entityPool->capacity)
+			{
+				sol::table entityTable = state.create_table();
+				entityTable[sol::metatable_key] = elementTable;
+
+				entityTables.emplace_back(std::move(entityTable));
+			}
+
+			element.entityPool = entityPool;
+		}
+		else
+			m_entityPools.erase(element.fullName);
 	}
 }
@@ -131,10 +131,19 @@ namespace bw
 		{
 			Match& match = GetMatch();
 
+			// Packet name may have been registered this tick
+			match.FlushNetworkStrings();
+
 			const NetworkStringStore& networkStringStore = match.GetNetworkStringStore();
 			match.BroadcastPacket(outgoingPacket.ToPacket(networkStringStore));
 		};
 
+		library["ChangeMap"] = [&](const std::string& mapFile)
+		{
+			// Map is loaded in the background and replaces the current one once ready
+			GetMatch().ChangeMap(mapFile);
+		};
+
 		library["CreateEntity"] = [&](const sol::table& parameters)
 		{
 			Match& match = GetMatch();
@@ -186,17 +195,23 @@ namespace bw
 			if (std::optional<sol::table> propertyTableOpt = parameters.get_or<std::optional<sol::table>>("Parent", std::nullopt); propertyTableOpt)
 				parentEntity = AbstractElementLibrary::AssertScriptEntity(propertyTableOpt.value());
 
+			TerrainLayer& layer = match.GetLayer(layerIndex);
+
 			Nz::Int64 uniqueId = match.AllocateUniqueId();
 
-			const Ndk::EntityHandle& entity = entityStore.InstantiateEntity(match.GetLayer(layerIndex), elementIndex, uniqueId, position, rotation, entityProperties, parentEntity);
+			Ndk::EntityHandle entity = entityStore.RecycleEntity(layer, elementIndex, uniqueId, position, rotation, entityProperties, parentEntity);
 			if (!entity)
-				throw std::runtime_error("Failed to create \"" + entityType + "\"");
+			{
+				entity = entityStore.InstantiateEntity(layer, elementIndex, uniqueId, position, rotation, entityProperties, parentEntity);
+				if (!entity)
+					throw std::runtime_error("Failed to create \"" + entityType + "\"");
+			}
+
+			match.RegisterEntity(uniqueId, entity);
 
 			if (owner)
 				entity->AddComponent<OwnerComponent>(std::move(owner));
 
-			match.RegisterEntity(uniqueId, entity);
-
 			if (lifeOwner)
 			{
 				if (!lifeOwner->HasComponent<EntityOwnerComponent>())
@@ -261,6 +276,9 @@ namespace bw
 			"RemoveWeapon", &Player::RemoveWeapon,
 			"SendPacket", [this](Player& player, const OutgoingNetworkPacket& outgoingPacket)
 			{
+				// Packet name may have been registered this tick
+				GetMatch().FlushNetworkStrings();
+
 				const NetworkStringStore& networkStringStore = GetSharedMatch().GetNetworkStringStore();
 				player.SendPacket(outgoingPacket.ToPacket(networkStringStore));
 			},
@@ -71,8 +71,9 @@ namespace bw
 
 		elementMetatable["IsValid"] = [](const sol::table& entityTable)
 		{
+			// Pooled entities are disabled and their previous tables detached
 			Ndk::EntityHandle entity = AbstractElementLibrary::RetrieveScriptEntity(entityTable);
-			return entity.IsValid();
+			return entity.IsValid() && entity->IsEnabled();
 		};
 
 		elementMetatable["SetLifeTime"] = [](const sol::table& entityTable, float lifetime)
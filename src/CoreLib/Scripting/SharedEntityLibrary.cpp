@@ -6,6 +6,7 @@
 #include <CoreLib/PlayerMovementController.hpp>
 #include <CoreLib/Utils.hpp>
 #include <CoreLib/Components/HealthComponent.hpp>
+#include <CoreLib/Components/MatchComponent.hpp>
 #include <CoreLib/Components/PlayerMovementComponent.hpp>
 #include <CoreLib/Components/ScriptComponent.hpp>
 #include <CoreLib/Components/WeaponWielderComponent.hpp>
@@ -267,6 +268,8 @@ namespace bw
 				auto& entityHealth = entity->GetComponent<HealthComponent>();
 				entityHealth.Damage(entityHealth.GetHealth(), entity);
 			}
+			else if (entity->HasComponent<MatchComponent>())
+				entity->GetComponent<MatchComponent>().Kill();
 			else
 				entity->Kill();
 		};
@@ -309,7 +312,10 @@ namespace bw
 		elementMetatable["Remove"] = [](const sol::table& entityTable)
 		{
 			Ndk::EntityHandle entity = AbstractElementLibrary::AssertScriptEntity(entityTable);
-			entity->Kill();
+			if (entity->HasComponent<MatchComponent>())
+				entity->GetComponent<MatchComponent>().Kill();
+			else
+				entity->Kill();
 		};
 
 		elementMetatable["SetCollider"] = [](sol::this_state L, const sol::table& entityTable, const sol::table& colliderTable)
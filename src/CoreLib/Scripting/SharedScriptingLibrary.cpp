@@ -11,13 +11,89 @@
 #include <CoreLib/Scripting/NetworkPacket.hpp>
 #include <CoreLib/Scripting/SharedElementLibrary.hpp>
 #include <CoreLib/Scripting/ScriptingContext.hpp>
+#include <Nazara/Math/Algorithm.hpp>
 #include <Nazara/Physics2D/Constraint2D.hpp>
 #include <NDK/Components/ConstraintComponent2D.hpp>
+#include <NDK/Components/NodeComponent.hpp>
+#include <NDK/Components/PhysicsComponent2D.hpp>
 #include <NDK/Systems/PhysicsSystem2D.hpp>
 #include <CoreLib/SharedMatch.hpp>
+#include <cmath>
 
 namespace bw
 {
+	namespace
+	{
+		struct SpatialQueryOptions
+		{
+			std::optional<std::string> entityClass;
+			std::optional<sol::table> resultTable;
+			Nz::UInt32 categoryMask = 0xFFFFFFFF;
+			Nz::UInt32 collisionGroup = 0;
+			Nz::UInt32 collisionMask = 0xFFFFFFFF;
+		};
+
+		SpatialQueryOptions ParseSpatialQueryOptions(const std::optional<sol::table>& optionTable)
+		{
+			SpatialQueryOptions options;
+			if (optionTable)
+			{
+				options.categoryMask = optionTable->get_or("CategoryMask", options.categoryMask);
+				options.collisionGroup = optionTable->get_or("CollisionGroup", options.collisionGroup);
+				options.collisionMask = optionTable->get_or("CollisionMask", options.collisionMask);
+				options.entityClass = optionTable->get_or<std::optional<std::string>>("Class", std::nullopt);
+				options.resultTable = optionTable->get_or<std::optional<sol::table>>("Result", std::nullopt);
+			}
+
+			return options;
+		}
+
+		bool FilterQueriedEntity(const SpatialQueryOptions& options, const Ndk::EntityHandle& entity)
+		{
+			if (!entity->HasComponent<ScriptComponent>())
+				return false;
+
+			if (options.entityClass && entity->GetComponent<ScriptComponent>().GetElement()->fullName != *options.entityClass)
+				return false;
+
+			return true;
+		}
+
+		float GetQueriedEntitySquaredDistance(const Ndk::EntityHandle& entity, const Nz::Vector2f& position)
+		{
+			// Use the closest point of the body bounding box when there is one, so big entities are found by their border
+			if (entity->HasComponent<Ndk::PhysicsComponent2D>())
+			{
+				Nz::Rectf aabb = entity->GetComponent<Ndk::PhysicsComponent2D>().GetAABB();
+
+				Nz::Vector2f closestPoint;
+				closestPoint.x = Nz::Clamp(position.x, aabb.x, aabb.x + aabb.width);
+				closestPoint.y = Nz::Clamp(position.y, aabb.y, aabb.y + aabb.height);
+
+				return closestPoint.SquaredDistance(position);
+			}
+
+			return Nz::Vector2f(entity->GetComponent<Ndk::NodeComponent>().GetPosition(Nz::CoordSys_Global)).SquaredDistance(position);
+		}
+
+		sol::table PrepareQueryResult(sol::this_state L, SpatialQueryOptions& options)
+		{
+			// Reusing the caller table prevents allocating a new table on every query
+			if (options.resultTable)
+				return std::move(*options.resultTable);
+
+			sol::state_view state(L);
+			return state.create_table();
+		}
+
+		void TrimQueryResult(sol::table& result, std::size_t entityCount)
+		{
+			std::size_t previousSize = result.size();
+			for (std::size_t i = entityCount + 1; i <= previousSize; ++i)
+				result[i] = sol::nil;
+		}
+	}
+
 	SharedScriptingLibrary::SharedScriptingLibrary(SharedMatch& sharedMatch) :
 	AbstractScriptingLibrary(sharedMatch.GetLogger()),
 	m_match(sharedMatch)
@@ -146,7 +222,8 @@ namespace bw
 			std::size_t index = 1;
 			auto entityFunc = [&](const Ndk::EntityHandle& entity)
 			{
-				if (!entity->HasComponent<ScriptComponent>())
+				// Disabled entities are pooled
+				if (!entity->IsEnabled() || !entity->HasComponent<ScriptComponent>())
 					return;
 
 				auto& entityScript = entity->GetComponent<ScriptComponent>();
@@ -264,6 +341,99 @@ namespace bw
 			return RotaryLimitConstraint(constraintEntity, constraintComponent.CreateConstraint<Nz::RotaryLimitConstraint2D>(firstEntity, secondEntity, minAngle, maxAngle));
 		};
 
+		library["FindEntitiesInRadius"] = [this](sol::this_state L, LayerIndex layer, const Nz::Vector2f& center, float radius, std::optional<sol::table> optionTable)
+		{
+			if (layer >= m_match.GetLayerCount())
+				throw std::runtime_error("Invalid layer index");
+
+			SpatialQueryOptions options = ParseSpatialQueryOptions(optionTable);
+
+			Ndk::World& world = m_match.GetLayer(layer).GetWorld();
+			auto& physSystem = world.GetSystem<Ndk::PhysicsSystem2D>();
+
+			sol::table result = PrepareQueryResult(L, options);
+
+			float squaredRadius = radius * radius;
+			std::size_t entityCount = 0;
+			physSystem.RegionQuery(Nz::Rectf(center.x - radius, center.y - radius, radius * 2.f, radius * 2.f), options.collisionGroup, options.categoryMask, options.collisionMask, [&](const Ndk::EntityHandle& entity)
+			{
+				if (!FilterQueriedEntity(options, entity))
+					return;
+
+				if (GetQueriedEntitySquaredDistance(entity, center) > squaredRadius)
+					return;
+
+				result[++entityCount] = entity->GetComponent<ScriptComponent>().GetTable();
+			});
+
+			TrimQueryResult(result, entityCount);
+
+			return result;
+		};
+
+		library["FindEntitiesInRect"] = [this](sol::this_state L, LayerIndex layer, const Nz::Rectf& rect, std::optional<sol::table> optionTable)
+		{
+			if (layer >= m_match.GetLayerCount())
+				throw std::runtime_error("Invalid layer index");
+
+			SpatialQueryOptions options = ParseSpatialQueryOptions(optionTable);
+
+			Ndk::World& world = m_match.GetLayer(layer).GetWorld();
+			auto& physSystem = world.GetSystem<Ndk::PhysicsSystem2D>();
+
+			sol::table result = PrepareQueryResult(L, options);
+
+			std::size_t entityCount = 0;
+			physSystem.RegionQuery(rect, options.collisionGroup, options.categoryMask, options.collisionMask, [&](const Ndk::EntityHandle& entity)
+			{
+				if (FilterQueriedEntity(options, entity))
+					result[++entityCount] = entity->GetComponent<ScriptComponent>().GetTable();
+			});
+
+			TrimQueryResult(result, entityCount);
+
+			return result;
+		};
+
+		library["FindNearestEntity"] = [this](LayerIndex layer, const Nz::Vector2f& position, float maxDistance, std::optional<sol::table> optionTable) -> std::tuple<sol::object, float>
+		{
+			if (layer >= m_match.GetLayerCount())
+				throw std::runtime_error("Invalid layer index");
+
+			SpatialQueryOptions options = ParseSpatialQueryOptions(optionTable);
+
+			Ndk::World& world = m_match.GetLayer(layer).GetWorld();
+			auto& physSystem = world.GetSystem<Ndk::PhysicsSystem2D>();
+
+			// Ask the spatial index first, its answer is only usable if it passes our filters
+			Ndk::PhysicsSystem2D::NearestQueryResult nearestResult;
+			if (!physSystem.NearestBodyQuery(position, maxDistance, options.collisionGroup, options.categoryMask, options.collisionMask, &nearestResult))
+				return { sol::nil, 0.f };
+
+			if (FilterQueriedEntity(options, nearestResult.nearestBody))
+				return { nearestResult.nearestBody->GetComponent<ScriptComponent>().GetTable(), nearestResult.distance };
+
+			Ndk::EntityHandle nearestEntity;
+			float nearestSquaredDistance = maxDistance * maxDistance;
+			physSystem.RegionQuery(Nz::Rectf(position.x - maxDistance, position.y - maxDistance, maxDistance * 2.f, maxDistance * 2.f), options.collisionGroup, options.categoryMask, options.collisionMask, [&](const Ndk::EntityHandle& entity)
+			{
+				if (!FilterQueriedEntity(options, entity))
+					return;
+
+				float squaredDistance = GetQueriedEntitySquaredDistance(entity, position);
+				if (squaredDistance <= nearestSquaredDistance)
+				{
+					nearestEntity = entity;
+					nearestSquaredDistance = squaredDistance;
+				}
+			});
+
+			if (!nearestEntity)
+				return { sol::nil, 0.f };
+
+			return { nearestEntity->GetComponent<ScriptComponent>().GetTable(), std::sqrt(nearestSquaredDistance) };
+		};
+
 		library["Trace"] = [this](sol::this_state L, LayerIndex layer, Nz::Vector2f startPos, Nz::Vector2f endPos) -> sol::object
 		{
 			if (layer >= m_match.GetLayerCount())
@@ -9,9 +9,35 @@ namespace bw
 	SharedAppConfig::SharedAppConfig(BurgApp& app) :
 	ConfigFile(app)
 	{
+		RegisterBoolOption("Assets.HotReloadScripts", false);
 		RegisterStringOption("Assets.ResourceFolder");
+		RegisterStringOption("Assets.ScriptCacheFolder", "scriptcache");
 		RegisterStringOption("Assets.ScriptFolder");
+		RegisterIntegerOption("Debug.NetworkSimulation.Bandwidth", 0, 0xFFFFFFFF, 0); //< bytes per second, 0 means unlimited
+		RegisterFloatOption("Debug.NetworkSimulation.DuplicationChance", 0.0, 1.0, 0.0);
+		RegisterIntegerOption("Debug.NetworkSimulation.Jitter", 0, 10'000, 0); //< ms
+		RegisterStringOption("Debug.NetworkSimulation.JitterDistribution", "uniform");
+		RegisterIntegerOption("Debug.NetworkSimulation.Latency", 0, 10'000, 0); //< ms, one-way
+		RegisterFloatOption("Debug.NetworkSimulation.LossBurstLength", 1.0, 1000.0, 1.0);
+		RegisterFloatOption("Debug.NetworkSimulation.LossChance", 0.0, 1.0, 0.0);
+		RegisterFloatOption("Debug.NetworkSimulation.ReorderChance", 0.0, 1.0, 0.0);
 		RegisterBoolOption("Debug.SendServerState");
+		RegisterIntegerOption("GameSettings.EntityInstantiationBudget", 100, 1'000'000, 4'000); //< microseconds per frame spent instantiating received entities (client)
+		RegisterIntegerOption("GameSettings.ScriptMemoryLimit", 0, 64 * 1024, 256); //< MiB, 0 means unlimited
 		RegisterFloatOption("GameSettings.TickRate");
+		RegisterFloatOption("Network.ConnectionLimits.AddressBurst", 1.0, 1000.0, 5.0);
+		RegisterFloatOption("Network.ConnectionLimits.AddressRate", 0.0, 1000.0, 1.0); //< connections per second and per address, 0 means unlimited
+		RegisterIntegerOption("Network.ConnectionLimits.MaxPending", 1, 1024, 16);
+		RegisterIntegerOption("Network.ConnectionLimits.MaxPendingPerAddress", 1, 1024, 2);
+		RegisterIntegerOption("Network.ConnectionLimits.PendingTimeout", 100, 60'000, 2000); //< ms
+		RegisterIntegerOption("Network.PacketBudgets.KickThreshold", 0, 0xFFFFFFFF, 20); //< dropped packets, 0 means never kick
+		RegisterFloatOption("Network.PacketBudgets.PlayerChat.Burst", 1.0, 1000.0, 5.0);
+		RegisterFloatOption("Network.PacketBudgets.PlayerChat.Rate", 0.0, 1000.0, 1.0); //< packets per second, 0 means unlimited
+		RegisterFloatOption("Network.PacketBudgets.PlayerConsoleCommand.Burst", 1.0, 1000.0, 10.0);
+		RegisterFloatOption("Network.PacketBudgets.PlayerConsoleCommand.Rate", 0.0, 1000.0, 2.0);
+		RegisterFloatOption("Network.PacketBudgets.ScriptPacket.Burst", 1.0, 10000.0, 60.0);
+		RegisterFloatOption("Network.PacketBudgets.ScriptPacket.Rate", 0.0, 10000.0, 30.0);
+		RegisterFloatOption("Network.PacketBudgets.UpdatePlayerName.Burst", 1.0, 1000.0, 3.0);
+		RegisterFloatOption("Network.PacketBudgets.UpdatePlayerName.Rate", 0.0, 1000.0, 0.2);
 	}
 }
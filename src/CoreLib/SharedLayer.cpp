@@ -69,6 +69,24 @@ namespace bw
 
 	SharedLayer::~SharedLayer() = default;
 
+	const Ndk::EntityHandle& SharedLayer::MigrateEntity(const Ndk::EntityHandle& entity)
+	{
+		assert(entity->GetWorld() != &m_world);
+
+		const Ndk::EntityHandle& newEntity = m_world.CreateEntity();
+
+		// Components are moved rather than cloned, which keeps their state and everything connected to their signals.
+		// A physics body can't leave its space though, the physics component builds a new one from its last state once attached.
+		const Nz::Bitset<>& componentBits = entity->GetComponentBits();
+		for (std::size_t i = componentBits.FindFirst(); i != componentBits.npos; i = componentBits.FindNext(i))
+			newEntity->AddComponent(entity->DropComponent(static_cast<Ndk::ComponentIndex>(i)));
+
+		newEntity->Enable(entity->IsEnabled());
+
+		// Source entity is left without any component, it's up to the caller to kill it
+		return newEntity;
+	}
+
 	void SharedLayer::TickUpdate(float elapsedTime)
 	{
 		m_world.Update(elapsedTime);
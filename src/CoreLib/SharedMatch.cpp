@@ -7,7 +7,9 @@
 #include <CoreLib/Components/InputComponent.hpp>
 #include <CoreLib/LogSystem/EntityLogContext.hpp>
 #include <CoreLib/LogSystem/Logger.hpp>
+#include <CoreLib/Scripting/ScriptingContext.hpp>
 #include <NDK/Components/PhysicsComponent2D.hpp>
+#include <algorithm>
 #include <cassert>
 
 namespace bw
@@ -15,6 +17,8 @@ namespace bw
 	namespace
 	{
 		unsigned int MaxDelayedTick = 10;
+		float MaxGarbageCollectionDuration = 0.002f;
+		float GarbageCollectionIdleRatio = 0.25f;
 	}
 
 	SharedMatch::SharedMatch(BurgApp& app, LogSide side, std::string matchName, float tickDuration) :
@@ -59,5 +63,12 @@ namespace bw
 			m_currentTime += elapsedTimeMs;
 			m_floatingTime -= elapsedTimeMs;
 		}
+
+		// Collect Lua garbage between ticks rather than letting allocations trigger it in the middle of one
+		if (const auto& scriptingContext = GetScriptingContext())
+		{
+			float timeBeforeNextTick = m_tickDuration - m_tickTimer;
+			scriptingContext->StepGarbageCollector(std::min(timeBeforeNextTick * GarbageCollectionIdleRatio, MaxGarbageCollectionDuration));
+		}
 	}
 }
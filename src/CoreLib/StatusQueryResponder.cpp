@@ -0,0 +1,260 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/StatusQueryResponder.hpp>
+#include <Nazara/Core/ByteStream.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace bw
+{
+	namespace
+	{
+		std::size_t GetSerializedStringSize(const std::string& str)
+		{
+			return sizeof(Nz::UInt8) + std::min<std::size_t>(str.size(), 0xFF);
+		}
+
+		void WriteString(Nz::ByteStream& stream, const std::string& str)
+		{
+			Nz::UInt8 length = static_cast<Nz::UInt8>(std::min<std::size_t>(str.size(), 0xFF));
+
+			stream << length;
+			stream.Write(str.data(), length);
+		}
+	}
+
+	StatusQueryResponder::StatusQueryResponder(Nz::NetProtocol protocol, Nz::UInt16 port, const Settings& settings) :
+	m_secretGenerator(std::random_device{}()),
+	m_hash(Nz::AbstractHash::Get(Nz::HashType_SHA1)),
+	m_lastSecretRotation(Nz::GetElapsedMilliseconds()),
+	m_lastSourcePruning(m_lastSecretRotation),
+	m_settings(settings),
+	m_globalBudget(settings.globalRate, settings.globalBurst)
+	{
+		if (!m_socket.Create(protocol))
+			throw std::runtime_error("failed to create status query socket");
+
+		m_socket.EnableBlocking(false);
+
+		Nz::IpAddress listenAddress = (protocol == Nz::NetProtocol_IPv4) ? Nz::IpAddress::AnyIpV4 : Nz::IpAddress::AnyIpV6;
+		listenAddress.SetPort(port);
+
+		if (m_socket.Bind(listenAddress) != Nz::SocketState_Bound)
+			throw std::runtime_error("failed to bind status query socket on port " + std::to_string(port));
+
+		m_secrets[0] = m_secretGenerator();
+		m_secrets[1] = m_secretGenerator();
+	}
+
+	void StatusQueryResponder::Poll()
+	{
+		Nz::UInt64 now = Nz::GetElapsedMilliseconds();
+
+		if (now - m_lastSecretRotation >= SecretRotationInterval)
+		{
+			m_secrets[1] = m_secrets[0];
+			m_secrets[0] = m_secretGenerator();
+			m_lastSecretRotation = now;
+		}
+
+		if (now - m_lastSourcePruning >= SourceExpiration)
+		{
+			PruneSources(now);
+			m_lastSourcePruning = now;
+		}
+
+		// Bound the work done per reactor iteration, remaining queries wait in the socket buffer
+		std::array<Nz::UInt8, RequestSize> request;
+		for (std::size_t i = 0; i < MaxQueriesPerPoll; ++i)
+		{
+			Nz::IpAddress from;
+			std::size_t received;
+			if (!m_socket.Receive(request.data(), request.size(), &from, &received) || received == 0)
+				break;
+
+			HandleQuery(now, from, request.data(), received);
+		}
+	}
+
+	void StatusQueryResponder::Publish(const ServerStatus& status)
+	{
+		std::shared_ptr<Nz::ByteArray> response = std::make_shared<Nz::ByteArray>();
+		response->Reserve(MaxResponseSize);
+
+		Nz::ByteStream stream(response.get(), Nz::OpenMode_WriteOnly);
+		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		stream << QueryMagic << static_cast<Nz::UInt8>(QueryType::Status);
+		WriteString(stream, status.name);
+		WriteString(stream, status.gamemode);
+		WriteString(stream, status.map);
+		stream << static_cast<Nz::UInt16>(status.players.size()) << status.maxPlayerCount;
+		stream << status.tickRate << status.effectiveTickRate << status.peakUpdateTime;
+
+		// The player list is cut to keep the reply in a single datagram, the total count is sent above
+		std::size_t responseSize = static_cast<std::size_t>(stream.GetCursorPos()) + sizeof(Nz::UInt16);
+
+		Nz::UInt16 listedPlayerCount = 0;
+		for (const ServerStatus::Player& player : status.players)
+		{
+			responseSize += GetSerializedStringSize(player.name) + sizeof(Nz::UInt16);
+			if (responseSize > MaxResponseSize)
+				break;
+
+			listedPlayerCount++;
+		}
+
+		stream << listedPlayerCount;
+		for (Nz::UInt16 i = 0; i < listedPlayerCount; ++i)
+		{
+			const ServerStatus::Player& player = status.players[i];
+
+			WriteString(stream, player.name);
+			stream << player.ping;
+		}
+
+		std::atomic_store(&m_response, std::shared_ptr<const Nz::ByteArray>(std::move(response)));
+	}
+
+	Nz::UInt32 StatusQueryResponder::ComputeChallenge(const Nz::IpAddress& address, Nz::UInt64 secret)
+	{
+		m_hash->Begin();
+		m_hash->Append(reinterpret_cast<const Nz::UInt8*>(&secret), sizeof(secret));
+
+		switch (address.GetProtocol())
+		{
+			case Nz::NetProtocol_IPv4:
+			{
+				Nz::IpAddress::IPv4 ip = address.ToIPv4();
+				m_hash->Append(ip.data(), ip.size());
+				break;
+			}
+
+			case Nz::NetProtocol_IPv6:
+			{
+				Nz::IpAddress::IPv6 ip = address.ToIPv6();
+				m_hash->Append(reinterpret_cast<const Nz::UInt8*>(ip.data()), ip.size() * sizeof(Nz::UInt16));
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		Nz::UInt16 port = address.GetPort();
+		m_hash->Append(reinterpret_cast<const Nz::UInt8*>(&port), sizeof(port));
+
+		Nz::ByteArray digest = m_hash->End();
+
+		Nz::UInt32 challenge;
+		std::memcpy(&challenge, digest.GetConstBuffer(), sizeof(challenge));
+
+		return challenge;
+	}
+
+	bool StatusQueryResponder::ConsumeBudget(Nz::UInt64 now, const Nz::IpAddress& address)
+	{
+		// Budgets are per address, a source can't get more replies by changing port
+		Nz::IpAddress sourceAddress = address;
+		sourceAddress.SetPort(0);
+
+		auto it = m_sources.find(sourceAddress);
+		if (it == m_sources.end())
+		{
+			// Spoofed addresses are free for an attacker, don't let them grow the table without bound
+			// Refusing new sources would let a flood lock legitimate ones out, they only get the global budget instead
+			if (m_sources.size() >= MaxTrackedSources)
+				return m_globalBudget.Consume(now);
+
+			it = m_sources.emplace(sourceAddress, Source{ TokenBucket(m_settings.sourceRate, m_settings.sourceBurst), now }).first;
+		}
+
+		Source& source = it.value();
+		source.lastQueryTime = now;
+
+		if (!source.budget.Consume(now))
+			return false;
+
+		return m_globalBudget.Consume(now);
+	}
+
+	void StatusQueryResponder::HandleQuery(Nz::UInt64 now, const Nz::IpAddress& address, const Nz::UInt8* data, std::size_t size)
+	{
+		// Padding makes the request at least as big as a challenge reply, spoofing a source gets no amplification
+		if (size < RequestSize)
+			return;
+
+		Nz::ByteStream stream(data, size);
+		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+
+		Nz::UInt32 magic;
+		Nz::UInt8 queryType;
+		Nz::UInt32 challenge;
+		stream >> magic >> queryType >> challenge;
+
+		if (magic != QueryMagic)
+			return;
+
+		if (!ConsumeBudget(now, address))
+			return;
+
+		switch (static_cast<QueryType>(queryType))
+		{
+			case QueryType::ChallengeRequest:
+				SendChallenge(address);
+				break;
+
+			case QueryType::StatusRequest:
+			{
+				// Unknown or expired challenge, the source has to prove it receives our replies
+				if (challenge != ComputeChallenge(address, m_secrets[0]) && challenge != ComputeChallenge(address, m_secrets[1]))
+				{
+					SendChallenge(address);
+					break;
+				}
+
+				std::shared_ptr<const Nz::ByteArray> response = std::atomic_load(&m_response);
+				if (!response)
+					break;
+
+				m_socket.Send(address, response->GetConstBuffer(), response->GetSize(), nullptr);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	void StatusQueryResponder::PruneSources(Nz::UInt64 now)
+	{
+		// Keep sources at least as long as their budget needs to refill, forgetting them earlier would hand out a fresh burst
+		Nz::UInt64 expiration = SourceExpiration;
+		if (m_settings.sourceRate > 0.f)
+			expiration = std::max(expiration, static_cast<Nz::UInt64>(m_settings.sourceBurst / m_settings.sourceRate * 1000.f));
+
+		for (auto it = m_sources.begin(); it != m_sources.end();)
+		{
+			if (now - it->second.lastQueryTime >= expiration)
+				it = m_sources.erase(it);
+			else
+				++it;
+		}
+	}
+
+	void StatusQueryResponder::SendChallenge(const Nz::IpAddress& address)
+	{
+		std::array<Nz::UInt8, sizeof(Nz::UInt32) + sizeof(Nz::UInt8) + sizeof(Nz::UInt32)> reply;
+
+		Nz::ByteStream stream(reply.data(), reply.size());
+		stream.SetDataEndianness(Nz::Endianness_LittleEndian);
+		stream << QueryMagic << static_cast<Nz::UInt8>(QueryType::Challenge) << ComputeChallenge(address, m_secrets[0]);
+
+		m_socket.Send(address, reply.data(), reply.size(), nullptr);
+	}
+}
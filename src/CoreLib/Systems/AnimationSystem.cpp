@@ -4,7 +4,8 @@
 
 #include <CoreLib/Systems/AnimationSystem.hpp>
 #include <CoreLib/SharedMatch.hpp>
-#include <CoreLib/Components/AnimationComponent.hpp>
+#include <algorithm>
+#include <cassert>
 
 namespace bw
 {
@@ -15,16 +16,70 @@ namespace bw
 		SetMaximumUpdateRate(100.f);
 	}
 
+	void AnimationSystem::OnEntityAdded(Ndk::Entity* entity)
+	{
+		auto& animComponent = entity->GetComponent<AnimationComponent>();
+
+		assert(m_animationStartSlots.find(entity->GetId()) == m_animationStartSlots.end());
+		auto& slot = m_animationStartSlots[entity->GetId()];
+		slot.Connect(animComponent.OnAnimationStart, [this](AnimationComponent* emitter)
+		{
+			RegisterAnimationEnd(*emitter);
+		});
+
+		// Animation may have been started before the entity was handled by this system
+		if (animComponent.IsPlaying())
+			RegisterAnimationEnd(animComponent);
+	}
+
+	void AnimationSystem::OnEntityRemoved(Ndk::Entity* entity)
+	{
+		// Pending animation ends of this entity are skipped when popped
+		auto it = m_animationStartSlots.find(entity->GetId());
+		assert(it != m_animationStartSlots.end());
+		m_animationStartSlots.erase(it);
+	}
+
 	void AnimationSystem::OnUpdate(float /*elapsedTime*/)
 	{
 		Nz::UInt64 now = m_match.GetCurrentTime();
 
-		for (const Ndk::EntityHandle& entity : GetEntities())
+		// Only animations ending before now are visited, idle entities cost nothing
+		while (!m_pendingAnimationEnds.empty() && m_pendingAnimationEnds.front().endTime <= now)
 		{
+			std::pop_heap(m_pendingAnimationEnds.begin(), m_pendingAnimationEnds.end(), &AnimationSystem::ComparePendingAnimationEnds);
+			PendingAnimationEnd animationEnd = std::move(m_pendingAnimationEnds.back());
+			m_pendingAnimationEnds.pop_back();
+
+			const Ndk::EntityHandle& entity = animationEnd.entity;
+			if (!entity || !HasEntity(entity))
+				continue;
+
+			// Animation may have been replaced by another one since
 			auto& animComponent = entity->GetComponent<AnimationComponent>();
+			if (!animComponent.IsPlaying() || animComponent.GetEndTime() != animationEnd.endTime)
+				continue;
+
 			animComponent.Update(now);
 		}
 	}
 
+	void AnimationSystem::RegisterAnimationEnd(AnimationComponent& animComponent)
+	{
+		assert(animComponent.IsPlaying());
+
+		PendingAnimationEnd& animationEnd = m_pendingAnimationEnds.emplace_back();
+		animationEnd.endTime = animComponent.GetEndTime();
+		animationEnd.entity = animComponent.GetEntity();
+
+		std::push_heap(m_pendingAnimationEnds.begin(), m_pendingAnimationEnds.end(), &AnimationSystem::ComparePendingAnimationEnds);
+	}
+
+	bool AnimationSystem::ComparePendingAnimationEnds(const PendingAnimationEnd& lhs, const PendingAnimationEnd& rhs)
+	{
+		// std heaps are max-heaps, the earliest end time has to compare as the greatest
+		return lhs.endTime > rhs.endTime;
+	}
+
 	Ndk::SystemIndex AnimationSystem::systemIndex;
 }
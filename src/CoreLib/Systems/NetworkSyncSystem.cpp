@@ -13,10 +13,12 @@
 #include <CoreLib/Components/PlayerMovementComponent.hpp>
 #include <CoreLib/Components/ScriptComponent.hpp>
 #include <CoreLib/Utils.hpp>
+#include <cassert>
 
 namespace bw
 {
 	NetworkSyncSystem::NetworkSyncSystem(TerrainLayer& layer) :
+	m_revision(0),
 	m_layer(layer)
 	{
 		Requires<NetworkSyncComponent, Ndk::NodeComponent>();
@@ -26,15 +28,17 @@ namespace bw
 
 	void NetworkSyncSystem::CreateEntities(const std::function<void(const EntityCreation* entityCreation, std::size_t entityCount)>& callback) const
 	{
-		m_creationEvents.clear();
+		// Sessions may call this concurrently when building their packets, don't share the event buffer
+		std::vector<EntityCreation> creationEvents;
+		creationEvents.reserve(GetEntities().size());
 
 		for (const Ndk::EntityHandle& entity : GetEntities())
 		{
-			EntityCreation& creationEvent = m_creationEvents.emplace_back();
+			EntityCreation& creationEvent = creationEvents.emplace_back();
 			BuildEvent(creationEvent, entity);
 		}
 
-		callback(m_creationEvents.data(), m_creationEvents.size());
+		callback(creationEvents.data(), creationEvents.size());
 	}
 
 	void NetworkSyncSystem::DeleteEntities(const std::function<void(const EntityDestruction* entityDestruction, std::size_t entityCount)>& callback) const
@@ -50,14 +54,47 @@ namespace bw
 		callback(m_destructionEvents.data(), m_destructionEvents.size());
 	}
 
+	bool NetworkSyncSystem::HasEntityChangedSince(Ndk::EntityId entityId, Nz::UInt64 revision) const
+	{
+		auto it = m_entitySlots.find(entityId);
+		if (it == m_entitySlots.end())
+			return true;
+
+		return it->second.revision > revision;
+	}
+
 	void NetworkSyncSystem::MoveEntities(const std::function<void(const EntityMovement* entityMovement, std::size_t entityCount)>& callback) const
+	{
+		callback(m_movementEvents.data(), m_movementEvents.size());
+	}
+
+	void NetworkSyncSystem::NotifyLayerChange(Ndk::EntityId entityId, LayerIndex previousLayer, Ndk::EntityId previousEntityId)
+	{
+		m_layerChanges[entityId] = std::make_pair(previousLayer, previousEntityId);
+	}
+
+	void NetworkSyncSystem::UpdateMovementSnapshot()
 	{
 		m_movementEvents.clear();
 
+		auto IsFacingRight = [](const EntityMovement& movement) { return movement.playerMovement && movement.playerMovement->isFacingRight; };
+
 		for (const Ndk::EntityHandle& entity : m_physicsEntities)
-			BuildEvent(m_movementEvents.emplace_back(), entity);
+		{
+			EntityMovement& movementEvent = m_movementEvents.emplace_back();
+			BuildEvent(movementEvent, entity);
 
-		callback(m_movementEvents.data(), m_movementEvents.size());
+			auto slotIt = m_entitySlots.find(entity->GetId());
+			assert(slotIt != m_entitySlots.end());
+			auto& slots = slotIt.value();
+
+			// Physics entities have no invalidation event, compare with the last snapshot to find out if they moved
+			if (!slots.lastMovement || slots.lastMovement->position != movementEvent.position || slots.lastMovement->rotation != movementEvent.rotation || IsFacingRight(*slots.lastMovement) != IsFacingRight(movementEvent))
+			{
+				MarkAsChanged(slots);
+				slots.lastMovement = movementEvent;
+			}
+		}
 	}
 
 	void NetworkSyncSystem::BuildEvent(EntityCreation& creationEvent, Ndk::Entity* entity) const
@@ -130,32 +167,28 @@ namespace bw
 			auto& scriptComponent = entity->GetComponent<ScriptComponent>();
 
 			const auto& element = scriptComponent.GetElement();
+			const auto& properties = scriptComponent.GetProperties();
 
-			for (const auto& [key, value] : scriptComponent.GetProperties())
-			{
-				auto it = element->properties.find(key);
-				assert(it != element->properties.end());
+			creationEvent.scriptElement = element;
+			creationEvent.properties = properties;
 
-				if (!it->second.shared)
+			for (const auto& [key, propertyInfo] : element->properties)
+			{
+				if (!propertyInfo.shared || propertyInfo.type != PropertyType::Entity || !properties.IsOverridden(propertyInfo.index))
 					continue;
 
-				creationEvent.properties.emplace(key, value);
+				const EntityProperty* value = properties.GetProperty(propertyInfo.index);
+				assert(value);
+
+				if (!std::holds_alternative<Nz::Int64>(*value))
+					continue;
 
-				switch (it->second.type)
+				// Sessions build creation events concurrently, entities of layers not loaded yet don't exist for clients either
+				const Ndk::EntityHandle& propertyEntity = m_layer.GetMatch().RetrieveLoadedEntityByUniqueId(std::get<Nz::Int64>(*value));
+				if (propertyEntity)
 				{
-					case PropertyType::Entity:
-					{
-						const Ndk::EntityHandle& propertyEntity = m_layer.GetMatch().RetrieveEntityByUniqueId(std::get<Nz::Int64>(value));
-						if (propertyEntity)
-						{
-							auto& propertyEntityMatch = propertyEntity->GetComponent<MatchComponent>();
-							creationEvent.dependentIds.emplace_back(propertyEntityMatch.GetLayerIndex(), propertyEntity->GetId());
-						}
-						break;
-					}
-
-					default:
-						break;
+					auto& propertyEntityMatch = propertyEntity->GetComponent<MatchComponent>();
+					creationEvent.dependentIds.emplace_back(propertyEntityMatch.GetLayerIndex(), propertyEntity->GetId());
 				}
 			}
 		}
@@ -207,11 +240,19 @@ namespace bw
 	{
 		EntityCreation creationEvent;
 		BuildEvent(creationEvent, entity);
+		creationEvent.payload = std::make_shared<CreationPayload>();
+
+		if (auto it = m_layerChanges.find(entity->GetId()); it != m_layerChanges.end())
+		{
+			creationEvent.previousLocation = it->second;
+			m_layerChanges.erase(it);
+		}
 
 		OnEntityCreated(this, creationEvent);
 
 		assert(m_entitySlots.find(entity->GetId()) == m_entitySlots.end());
 		auto& slots = m_entitySlots.emplace(entity->GetId(), EntitySlots()).first.value();
+		MarkAsChanged(slots);
 
 		if (entity->HasComponent<Ndk::PhysicsComponent2D>())
 			m_physicsEntities.Insert(entity);
@@ -220,6 +261,8 @@ namespace bw
 			m_staticEntities.Insert(entity);
 			slots.onInvalidated.Connect(entity->GetComponent<NetworkSyncComponent>().OnInvalidated, [&](NetworkSyncComponent* netSync)
 			{
+				MarkAsChanged(netSync->GetEntity()->GetId());
+
 				EntityMovement movementEvent;
 				BuildEvent(movementEvent, netSync->GetEntity());
 
@@ -254,14 +297,34 @@ namespace bw
 
 			slots.onHealthChange.Connect(entityHealth.OnHealthChange, [&](HealthComponent* health)
 			{
+				MarkAsChanged(health->GetEntity()->GetId(), false);
 				m_healthUpdateEntities.Insert(health->GetEntity());
 			});
 		}
 
+		if (entity->HasComponent<ScriptComponent>())
+		{
+			slots.onPropertyUpdate.Connect(entity->GetComponent<ScriptComponent>().OnPropertyUpdate, [&](ScriptComponent* script, std::size_t propertyIndex)
+			{
+				if (!script->GetElement()->sharedProperties.test(propertyIndex))
+					return;
+
+				const Ndk::EntityHandle& scriptEntity = script->GetEntity();
+
+				auto slotIt = m_entitySlots.find(scriptEntity->GetId());
+				assert(slotIt != m_entitySlots.end());
+				slotIt.value().dirtyProperties.set(propertyIndex);
+				MarkAsChanged(slotIt.value(), false);
+
+				m_propertyUpdateEntities.Insert(scriptEntity);
+			});
+		}
+
 		if (entity->HasComponent<InputComponent>())
 		{
 			slots.onInputUpdate.Connect(entity->GetComponent<InputComponent>().OnInputUpdate, [&](InputComponent* input)
 			{
+				MarkAsChanged(input->GetEntity()->GetId(), false);
 				m_inputUpdateEntities.Insert(input->GetEntity());
 			});
 		}
@@ -277,6 +340,7 @@ namespace bw
 		m_healthUpdateEntities.Remove(entity);
 		m_inputUpdateEntities.Remove(entity);
 		m_physicsEntities.Remove(entity);
+		m_propertyUpdateEntities.Remove(entity);
 		m_staticEntities.Remove(entity);
 
 		auto it = m_entitySlots.find(entity->GetId());
@@ -316,6 +380,34 @@ namespace bw
 
 			OnEntitiesInputUpdate(this, m_inputEvents.data(), m_inputEvents.size());
 		}
+
+		if (!m_propertyUpdateEntities.empty())
+		{
+			m_propertyEvents.clear();
+
+			for (const auto& entity : m_propertyUpdateEntities)
+			{
+				auto slotIt = m_entitySlots.find(entity->GetId());
+				assert(slotIt != m_entitySlots.end());
+				auto& dirtyProperties = slotIt.value().dirtyProperties;
+
+				EntityPropertyUpdate& propertyEvent = m_propertyEvents.emplace_back();
+				propertyEvent.entityId = entity->GetId();
+				propertyEvent.properties = entity->GetComponent<ScriptComponent>().GetProperties();
+				propertyEvent.updatedProperties = dirtyProperties;
+
+				dirtyProperties.reset();
+			}
+
+			m_propertyUpdateEntities.Clear();
+
+			OnEntitiesPropertyUpdate(this, m_propertyEvents.data(), m_propertyEvents.size());
+
+			// Release shared property blocks so the next write doesn't trigger a copy
+			m_propertyEvents.clear();
+		}
+
+		m_firstUnpublishedRevision.reset();
 	}
 
 	Ndk::SystemIndex NetworkSyncSystem::systemIndex;
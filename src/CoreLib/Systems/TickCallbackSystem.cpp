@@ -42,6 +42,8 @@ namespace bw
 
 			assert(element->tickFunction);
 
+			LuaAllocator::OwnerScope allocationOwner(scriptComponent.GetContext()->GetAllocator(), element->fullName);
+
 			auto result = element->tickFunction(scriptComponent.GetTable());
 			if (!result.valid())
 			{
@@ -4,6 +4,7 @@
 
 #include <CoreLib/Terrain.hpp>
 #include <CoreLib/LayerIndex.hpp>
+#include <cassert>
 
 namespace bw
 {
@@ -14,9 +15,27 @@ namespace bw
 
 	void Terrain::Initialize(Match& match)
 	{
+		// Layers start empty, their entities are decoded and instantiated when the layer is first accessed
 		m_layers.reserve(m_map.GetLayerCount());
 		for (std::size_t layerIndex = 0; layerIndex < m_map.GetLayerCount(); ++layerIndex)
-			m_layers.emplace_back(match, LayerIndex(layerIndex), m_map.GetLayer(layerIndex));
+		{
+			m_layers.emplace_back(match, LayerIndex(layerIndex));
+
+			for (Nz::Int64 uniqueId : m_map.GetLayerUniqueIds(layerIndex))
+				m_pendingEntities.emplace(uniqueId, LayerIndex(layerIndex));
+		}
+
+		m_pendingLayers.Resize(m_layers.size(), true);
+	}
+
+	bool Terrain::LoadEntityLayer(Nz::Int64 uniqueId)
+	{
+		auto it = m_pendingEntities.find(uniqueId);
+		if (it == m_pendingEntities.end())
+			return false;
+
+		LoadLayer(it->second);
+		return true;
 	}
 
 	void Terrain::Update(float elapsedTime)
@@ -24,4 +43,18 @@ namespace bw
 		for (TerrainLayer& layer : m_layers)
 			layer.TickUpdate(elapsedTime);
 	}
+
+	void Terrain::LoadLayer(LayerIndex layerIndex) const
+	{
+		assert(m_pendingLayers.Test(layerIndex));
+
+		// Marked as loaded first, instantiated entities may look up map entities (of this layer too) by their unique id
+		m_pendingLayers.Reset(layerIndex);
+
+		const Map::Layer& layerData = m_map.GetLayer(layerIndex);
+		for (const Map::Entity& entityData : layerData.entities)
+			m_pendingEntities.erase(entityData.uniqueId);
+
+		m_layers[layerIndex].LoadEntities(layerData);
+	}
 }
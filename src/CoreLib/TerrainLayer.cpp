@@ -4,9 +4,13 @@
 
 #include <CoreLib/TerrainLayer.hpp>
 #include <CoreLib/Match.hpp>
+#include <CoreLib/Components/EntityOwnerComponent.hpp>
+#include <CoreLib/Components/MatchComponent.hpp>
 #include <CoreLib/Components/NetworkSyncComponent.hpp>
+#include <CoreLib/Components/OwnerComponent.hpp>
 #include <CoreLib/Components/PlayerControlledComponent.hpp>
 #include <CoreLib/Components/PlayerMovementComponent.hpp>
+#include <CoreLib/Components/ScriptComponent.hpp>
 #include <CoreLib/Systems/AnimationSystem.hpp>
 #include <CoreLib/Systems/NetworkSyncSystem.hpp>
 #include <CoreLib/Systems/PlayerMovementSystem.hpp>
@@ -17,11 +21,41 @@
 
 namespace bw
 {
-	TerrainLayer::TerrainLayer(Match& match, LayerIndex layerIndex, const Map::Layer& layerData) :
+	TerrainLayer::TerrainLayer(Match& match, LayerIndex layerIndex) :
 	SharedLayer(match, layerIndex)
 	{
 		Ndk::World& world = GetWorld();
 		world.AddSystem<NetworkSyncSystem>(*this);
+	}
+
+	Ndk::EntityHandle TerrainLayer::AcquirePooledEntity(const std::string& entityClass)
+	{
+		auto it = m_entityPools.find(entityClass);
+		if (it == m_entityPools.end())
+			return Ndk::EntityHandle::InvalidHandle;
+
+		auto& availableEntities = it.value().availableEntities;
+		while (!availableEntities.empty())
+		{
+			Ndk::EntityHandle entity = std::move(availableEntities.back());
+			availableEntities.pop_back();
+
+			// Pooled entities may still have been killed (by their life owner for example)
+			if (entity)
+				return entity;
+		}
+
+		return Ndk::EntityHandle::InvalidHandle;
+	}
+
+	Match& TerrainLayer::GetMatch()
+	{
+		return static_cast<Match&>(SharedLayer::GetMatch());
+	}
+
+	void TerrainLayer::LoadEntities(const Map::Layer& layerData)
+	{
+		Match& match = GetMatch();
 
 		auto& entityStore = match.GetEntityStore();
 		for (const Map::Entity& entityData : layerData.entities)
@@ -46,8 +80,58 @@ namespace bw
 		}
 	}
 
-	Match& TerrainLayer::GetMatch()
+	bool TerrainLayer::ReleaseEntity(const Ndk::EntityHandle& entity)
 	{
-		return static_cast<Match&>(SharedLayer::GetMatch());
+		// Entities are only disabled while pooled
+		if (!entity->IsEnabled())
+			return true;
+
+		if (!entity->HasComponent<ScriptComponent>())
+			return false;
+
+		const auto& element = entity->GetComponent<ScriptComponent>().GetElement();
+		if (!element->entityPool)
+			return false;
+
+		EntityPool& entityPool = m_entityPools[element->fullName];
+		if (entityPool.availableEntities.size() + entityPool.releasedEntities.size() >= element->entityPool->capacity)
+			return false;
+
+		// The script table and unique id belong to this instance, scripts still holding them must see it as removed
+		if (!entity->GetComponent<ScriptComponent>().Release())
+			return false;
+
+		GetMatch().UnregisterEntity(entity->GetComponent<MatchComponent>().GetUniqueId());
+
+		// Components added by scripts and ownership (given by whoever creates the entity) must not follow it in the pool
+		if (entity->HasComponent<EntityOwnerComponent>())
+			entity->RemoveComponent<EntityOwnerComponent>();
+
+		if (entity->HasComponent<OwnerComponent>())
+			entity->RemoveComponent<OwnerComponent>();
+
+		if (entity->HasComponent<Ndk::LifetimeComponent>())
+			entity->RemoveComponent<Ndk::LifetimeComponent>();
+
+		// Disabling the entity removes it from the systems, which sends its destruction to the clients
+		entity->Disable();
+		entityPool.releasedEntities.emplace_back(entity);
+
+		return true;
+	}
+
+	void TerrainLayer::TickUpdate(float elapsedTime)
+	{
+		// Entities released since the last tick are removed from the systems by this update, before anyone can reuse them
+		for (auto it = m_entityPools.begin(); it != m_entityPools.end(); ++it)
+		{
+			EntityPool& entityPool = it.value();
+			for (Ndk::EntityHandle& entity : entityPool.releasedEntities)
+				entityPool.availableEntities.emplace_back(std::move(entity));
+
+			entityPool.releasedEntities.clear();
+		}
+
+		SharedLayer::TickUpdate(elapsedTime);
 	}
 }
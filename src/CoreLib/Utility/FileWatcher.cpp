@@ -0,0 +1,22 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <CoreLib/Utility/FileWatcher.hpp>
+#include <Nazara/Prerequisites.hpp>
+
+#define BURGWAR_CORELIB_FILEWATCHER_CPP
+
+#ifdef NAZARA_PLATFORM_LINUX
+#include <CoreLib/Utility/FileWatcher_linux.cpp>
+#else
+#include <CoreLib/Utility/FileWatcher_fallback.cpp>
+#endif
+
+namespace bw
+{
+	FileWatcher::FileWatcher(FileWatcher&&) noexcept = default;
+	FileWatcher::~FileWatcher() = default;
+
+	FileWatcher& FileWatcher::operator=(FileWatcher&&) noexcept = default;
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#if defined(BURGWAR_CORELIB_FILEWATCHER_CPP)
+
+#include <CoreLib/Utility/FileWatcher.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
+#include <string>
+
+namespace bw
+{
+	struct FileWatcher::InternalData
+	{
+		tsl::hopscotch_map<std::string /*relativePath*/, std::filesystem::file_time_type> lastWriteTimes;
+	};
+
+	namespace
+	{
+		template<typename F>
+		void ForEachFile(const std::filesystem::path& folder, F&& callback)
+		{
+			std::error_code ec;
+			for (auto it = std::filesystem::recursive_directory_iterator(folder, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+			{
+				if (!it->is_regular_file(ec))
+					continue;
+
+				std::filesystem::file_time_type writeTime = it->last_write_time(ec);
+				if (!ec)
+					callback(std::filesystem::relative(it->path(), folder).generic_u8string(), writeTime);
+			}
+		}
+	}
+
+	FileWatcher::FileWatcher(std::filesystem::path folder) :
+	m_folder(std::move(folder)),
+	m_internalData(std::make_unique<InternalData>())
+	{
+		ForEachFile(m_folder, [&](std::string relativePath, std::filesystem::file_time_type writeTime)
+		{
+			m_internalData->lastWriteTimes.emplace(std::move(relativePath), writeTime);
+		});
+	}
+
+	bool FileWatcher::IsValid() const
+	{
+		return std::filesystem::is_directory(m_folder);
+	}
+
+	void FileWatcher::PollChanges(std::vector<std::filesystem::path>& changedFiles)
+	{
+		tsl::hopscotch_map<std::string, std::filesystem::file_time_type> lastWriteTimes;
+		ForEachFile(m_folder, [&](std::string relativePath, std::filesystem::file_time_type writeTime)
+		{
+			auto it = m_internalData->lastWriteTimes.find(relativePath);
+			if (it != m_internalData->lastWriteTimes.end())
+			{
+				if (it->second != writeTime)
+					changedFiles.emplace_back(relativePath);
+
+				m_internalData->lastWriteTimes.erase(it);
+			}
+			else
+				changedFiles.emplace_back(relativePath);
+
+			lastWriteTimes.emplace(std::move(relativePath), writeTime);
+		});
+
+		// Remaining entries were removed
+		for (auto&& [relativePath, writeTime] : m_internalData->lastWriteTimes)
+			changedFiles.emplace_back(relativePath);
+
+		m_internalData->lastWriteTimes = std::move(lastWriteTimes);
+	}
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#if defined(BURGWAR_CORELIB_FILEWATCHER_CPP)
+
+#include <CoreLib/Utility/FileWatcher.hpp>
+#include <Thirdparty/tsl/hopscotch_map.h>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace bw
+{
+	namespace
+	{
+		constexpr std::uint32_t WatchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+	}
+
+	struct FileWatcher::InternalData
+	{
+		~InternalData()
+		{
+			if (fd >= 0)
+				close(fd);
+		}
+
+		void AddWatch(const std::filesystem::path& root, const std::filesystem::path& relativeFolder)
+		{
+			// inotify is not recursive, every subfolder needs its own watch
+			int wd = inotify_add_watch(fd, (root / relativeFolder).c_str(), WatchMask);
+			if (wd < 0)
+				return;
+
+			watchedFolders[wd] = relativeFolder;
+
+			std::error_code ec;
+			for (auto it = std::filesystem::directory_iterator(root / relativeFolder, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+			{
+				if (it->is_directory(ec))
+					AddWatch(root, relativeFolder / it->path().filename());
+			}
+		}
+
+		tsl::hopscotch_map<int /*wd*/, std::filesystem::path /*relativeFolder*/> watchedFolders;
+		int fd = -1;
+	};
+
+	FileWatcher::FileWatcher(std::filesystem::path folder) :
+	m_folder(std::move(folder)),
+	m_internalData(std::make_unique<InternalData>())
+	{
+		m_internalData->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_internalData->fd >= 0)
+			m_internalData->AddWatch(m_folder, {});
+	}
+
+	bool FileWatcher::IsValid() const
+	{
+		return m_internalData->fd >= 0 && !m_internalData->watchedFolders.empty();
+	}
+
+	void FileWatcher::PollChanges(std::vector<std::filesystem::path>& changedFiles)
+	{
+		if (m_internalData->fd < 0)
+			return;
+
+		alignas(inotify_event) std::array<char, 4096> buffer;
+		for (;;)
+		{
+			ssize_t readSize = read(m_internalData->fd, buffer.data(), buffer.size());
+			if (readSize <= 0)
+				break; //< EAGAIN: no more event
+
+			for (ssize_t offset = 0; offset < readSize;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(&buffer[offset]);
+				offset += sizeof(inotify_event) + event->len;
+
+				if (event->mask & IN_IGNORED)
+				{
+					m_internalData->watchedFolders.erase(event->wd);
+					continue;
+				}
+
+				auto it = m_internalData->watchedFolders.find(event->wd);
+				if (it == m_internalData->watchedFolders.end() || event->len == 0)
+					continue;
+
+				std::filesystem::path relativePath = it->second / event->name;
+				if (event->mask & IN_ISDIR)
+				{
+					if (event->mask & (IN_CREATE | IN_MOVED_TO))
+						m_internalData->AddWatch(m_folder, relativePath);
+
+					continue;
+				}
+
+				// File creation is followed by IN_CLOSE_WRITE once its content has been written
+				if (event->mask & IN_CREATE)
+					continue;
+
+				changedFiles.emplace_back(std::move(relativePath));
+			}
+		}
+	}
+}
+
+#endif
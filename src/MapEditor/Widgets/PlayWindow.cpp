@@ -37,6 +37,7 @@ namespace bw
 
 		MatchSessions& sessions = m_match.GetSessions();
 		LocalSessionManager* sessionManager = sessions.CreateSessionManager<LocalSessionManager>();
+		sessionManager->SimulateNetworkConditions(NetworkConditions::FromConfig(app.GetConfig()));
 
 		m_session = std::make_shared<ClientSession>(app);
 		m_session->Connect(sessionManager->CreateSession());
@@ -0,0 +1,255 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <PacketBench/PacketPayloads.hpp>
+#include <random>
+#include <string>
+
+namespace bw
+{
+	namespace
+	{
+		constexpr std::size_t LayerCount = 4;
+
+		std::mt19937 CreateGenerator()
+		{
+			return std::mt19937(42);
+		}
+
+		float RandomFloat(std::mt19937& generator, float min, float max)
+		{
+			return std::uniform_real_distribution<float>(min, max)(generator);
+		}
+
+		Nz::Vector2f RandomPosition(std::mt19937& generator)
+		{
+			return Nz::Vector2f(RandomFloat(generator, -4000.f, 4000.f), RandomFloat(generator, -2000.f, 2000.f));
+		}
+
+		PlayerInputData RandomInputs(std::mt19937& generator)
+		{
+			std::bernoulli_distribution coinFlip;
+
+			PlayerInputData inputs;
+			inputs.aimDirection = Nz::Vector2f(RandomFloat(generator, -1.f, 1.f), RandomFloat(generator, -1.f, 1.f));
+			inputs.isAttacking = coinFlip(generator);
+			inputs.isCrouching = coinFlip(generator);
+			inputs.isJumping = coinFlip(generator);
+			inputs.isLookingRight = coinFlip(generator);
+			inputs.isMovingLeft = coinFlip(generator);
+			inputs.isMovingRight = coinFlip(generator);
+
+			return inputs;
+		}
+
+		// Entities are spread over multiple layers, as the server groups them
+		template<typename T>
+		void FillLayers(T& packet, std::size_t entityCount)
+		{
+			packet.entities.resize(entityCount);
+
+			std::size_t entityIndex = 0;
+			for (std::size_t i = 0; i < LayerCount; ++i)
+			{
+				std::size_t layerEntityCount = entityCount / LayerCount + ((i < entityCount % LayerCount) ? 1 : 0);
+
+				auto& layer = packet.layers.emplace_back();
+				layer.layerIndex = static_cast<LayerIndex>(i);
+				layer.entityCount = static_cast<Nz::UInt32>(layerEntityCount);
+
+				for (std::size_t j = 0; j < layerEntityCount; ++j)
+					packet.entities[entityIndex++].id = static_cast<Nz::UInt32>(j * 3); //< some entities were removed in-between
+			}
+		}
+	}
+
+	Packets::ChatMessage BuildChatMessage(std::size_t messageLength)
+	{
+		Packets::ChatMessage packet;
+		packet.localIndex = 0;
+		packet.playerIndex = 12;
+		packet.content.assign(messageLength, 'a');
+
+		return packet;
+	}
+
+	Packets::CreateEntities BuildCreateEntities(std::size_t entityCount)
+	{
+		std::mt19937 generator = CreateGenerator();
+		std::bernoulli_distribution coinFlip;
+
+		Packets::CreateEntities packet;
+		packet.stateTick = 1234;
+		FillLayers(packet, entityCount);
+
+		Nz::UInt64 uniqueId = 1000;
+		for (auto& entity : packet.entities)
+		{
+			auto& entityData = entity.data;
+			entityData.entityClass = static_cast<Nz::UInt32>(generator() % 64);
+			entityData.uniqueId = uniqueId++;
+			entityData.position = RandomPosition(generator);
+			entityData.rotation = Nz::RadianAnglef(RandomFloat(generator, -3.14f, 3.14f));
+
+			if (coinFlip(generator))
+				entityData.health = Packets::Helper::HealthData{ 100, 75 };
+
+			if (coinFlip(generator))
+			{
+				auto& physicsProperties = entityData.physicsProperties.emplace();
+				physicsProperties.angularVelocity = Nz::RadianAnglef(RandomFloat(generator, -1.f, 1.f));
+				physicsProperties.linearVelocity = Nz::Vector2f(RandomFloat(generator, -500.f, 500.f), RandomFloat(generator, -500.f, 500.f));
+			}
+
+			if (generator() % 8 == 0)
+				entityData.name = "entity_" + std::to_string(uniqueId);
+
+			auto& sizeProperty = entityData.properties.emplace_back();
+			sizeProperty.name = 1;
+			sizeProperty.isArray = false;
+			sizeProperty.value = std::vector<float>{ RandomFloat(generator, 0.5f, 2.f) };
+
+			auto& colorProperty = entityData.properties.emplace_back();
+			colorProperty.name = 2;
+			colorProperty.isArray = false;
+			colorProperty.value = std::vector<Nz::Vector4f>{ Nz::Vector4f(1.f, 0.5f, 0.25f, 1.f) };
+
+			auto& modelProperty = entityData.properties.emplace_back();
+			modelProperty.name = 3;
+			modelProperty.isArray = false;
+			modelProperty.value = std::vector<std::string>{ "Models/burger.png" };
+		}
+
+		return packet;
+	}
+
+	Packets::DeleteEntities BuildDeleteEntities(std::size_t entityCount)
+	{
+		Packets::DeleteEntities packet;
+		packet.stateTick = 1234;
+		FillLayers(packet, entityCount);
+
+		return packet;
+	}
+
+	Packets::DownloadClientScriptResponse BuildDownloadClientScriptResponse(std::size_t fileSize)
+	{
+		std::mt19937 generator = CreateGenerator();
+
+		Packets::DownloadClientScriptResponse packet;
+		packet.fileContent.resize(fileSize);
+		for (Nz::UInt8& byte : packet.fileContent)
+			byte = static_cast<Nz::UInt8>(' ' + generator() % 95);
+
+		return packet;
+	}
+
+	Packets::EntitiesInputs BuildEntitiesInputs(std::size_t playerCount)
+	{
+		std::mt19937 generator = CreateGenerator();
+
+		Packets::EntitiesInputs packet;
+		packet.stateTick = 1234;
+		FillLayers(packet, playerCount);
+
+		for (auto& entity : packet.entities)
+			entity.inputs = RandomInputs(generator);
+
+		return packet;
+	}
+
+	Packets::EntitiesPropertyUpdate BuildEntitiesPropertyUpdate(std::size_t entityCount)
+	{
+		std::mt19937 generator = CreateGenerator();
+
+		Packets::EntitiesPropertyUpdate packet;
+		packet.stateTick = 1234;
+		FillLayers(packet, entityCount);
+
+		for (auto& entity : packet.entities)
+		{
+			auto& countProperty = entity.properties.emplace_back();
+			countProperty.index = 0;
+			countProperty.isArray = false;
+			countProperty.value = std::vector<Nz::Int64>{ static_cast<Nz::Int64>(generator() % 1000) };
+
+			auto& pathProperty = entity.properties.emplace_back();
+			pathProperty.index = 3;
+			pathProperty.isArray = true;
+			pathProperty.value = std::vector<Nz::Vector2f>{ RandomPosition(generator), RandomPosition(generator), RandomPosition(generator) };
+		}
+
+		return packet;
+	}
+
+	Packets::HealthUpdate BuildHealthUpdate(std::size_t entityCount)
+	{
+		std::mt19937 generator = CreateGenerator();
+
+		Packets::HealthUpdate packet;
+		packet.stateTick = 1234;
+		FillLayers(packet, entityCount);
+
+		for (auto& entity : packet.entities)
+			entity.currentHealth = static_cast<Nz::UInt16>(generator() % 100);
+
+		return packet;
+	}
+
+	Packets::MatchState BuildMatchState(std::size_t playerCount, std::size_t physicalEntityCount)
+	{
+		std::mt19937 generator = CreateGenerator();
+		std::bernoulli_distribution coinFlip;
+
+		Packets::MatchState packet;
+		packet.stateTick = 1234;
+		std::size_t entityCount = playerCount + physicalEntityCount;
+		FillLayers(packet, entityCount);
+
+		// Players are spread evenly over layers, every sent entity is moving and has physics
+		for (std::size_t i = 0; i < entityCount; ++i)
+		{
+			auto& entity = packet.entities[i];
+			entity.position = RandomPosition(generator);
+			entity.rotation = Nz::RadianAnglef(RandomFloat(generator, -3.14f, 3.14f));
+
+			auto& physicsProperties = entity.physicsProperties.emplace();
+			physicsProperties.angularVelocity = Nz::RadianAnglef(RandomFloat(generator, -1.f, 1.f));
+			physicsProperties.linearVelocity = Nz::Vector2f(RandomFloat(generator, -500.f, 500.f), RandomFloat(generator, -500.f, 500.f));
+
+			if ((i * playerCount) % entityCount < playerCount)
+			{
+				auto& playerMovement = entity.playerMovement.emplace();
+				playerMovement.isFacingRight = coinFlip(generator);
+			}
+		}
+
+		return packet;
+	}
+
+	Packets::NetworkStrings BuildNetworkStrings(std::size_t stringCount)
+	{
+		Packets::NetworkStrings packet;
+		packet.startId = 0;
+
+		packet.strings.reserve(stringCount);
+		for (std::size_t i = 0; i < stringCount; ++i)
+			packet.strings.push_back("entity_property_" + std::to_string(i));
+
+		return packet;
+	}
+
+	Packets::PlayersInput BuildPlayersInput(std::size_t localPlayerCount)
+	{
+		std::mt19937 generator = CreateGenerator();
+
+		Packets::PlayersInput packet;
+		packet.estimatedServerTick = 1234;
+
+		for (std::size_t i = 0; i < localPlayerCount; ++i)
+			packet.inputs.emplace_back(RandomInputs(generator));
+
+		return packet;
+	}
+}
@@ -0,0 +1,27 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef BURGWAR_PACKETBENCH_PACKETPAYLOADS_HPP
+#define BURGWAR_PACKETBENCH_PACKETPAYLOADS_HPP
+
+#include <CoreLib/Protocol/Packets.hpp>
+
+namespace bw
+{
+	// Payloads are generated from a fixed seed, with a given toolchain their serialized size only changes with the protocol
+	Packets::ChatMessage BuildChatMessage(std::size_t messageLength);
+	Packets::CreateEntities BuildCreateEntities(std::size_t entityCount);
+	Packets::DeleteEntities BuildDeleteEntities(std::size_t entityCount);
+	Packets::DownloadClientScriptResponse BuildDownloadClientScriptResponse(std::size_t fileSize);
+	Packets::EntitiesInputs BuildEntitiesInputs(std::size_t playerCount);
+	Packets::EntitiesPropertyUpdate BuildEntitiesPropertyUpdate(std::size_t entityCount);
+	Packets::HealthUpdate BuildHealthUpdate(std::size_t entityCount);
+	Packets::MatchState BuildMatchState(std::size_t playerCount, std::size_t physicalEntityCount);
+	Packets::NetworkStrings BuildNetworkStrings(std::size_t stringCount);
+	Packets::PlayersInput BuildPlayersInput(std::size_t localPlayerCount);
+}
+
+#endif
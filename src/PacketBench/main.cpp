@@ -0,0 +1,302 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <CoreLib/Protocol/Packets.hpp>
+#include <PacketBench/PacketPayloads.hpp>
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+// Usage: BWPacketBench [--baseline file] [--update-baseline] [--tolerance percent] [--iterations count]
+// Returns a non-zero exit code if a packet got bigger, allocates more or is slower than the baseline (beyond tolerance),
+// or if the baseline is missing a benchmark. The reference baseline is src/PacketBench/baseline.json, only --update-baseline writes it.
+
+namespace
+{
+	bool s_countAllocations = false;
+	std::size_t s_allocationCount = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	if (s_countAllocations)
+		s_allocationCount++;
+
+	if (void* ptr = std::malloc(size > 0 ? size : 1))
+		return ptr;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+
+namespace
+{
+	struct BenchmarkResult
+	{
+		std::string name;
+		std::size_t bytesPerOp;
+		double serializeNsPerOp;
+		double unserializeNsPerOp;
+		std::size_t serializeAllocsPerOp;
+		std::size_t unserializeAllocsPerOp;
+	};
+
+	struct Settings
+	{
+		std::filesystem::path baselinePath = "../../src/PacketBench/baseline.json"; //< relative to bin/<config>, where the project runs
+		std::size_t iterations = 1000;
+		double timeTolerance = 0.25;
+		bool updateBaseline = false;
+	};
+
+	constexpr std::size_t RunCount = 5; //< best run is kept, to filter out scheduling noise
+
+	double MeasureNsPerOp(std::size_t iterations, const std::function<void()>& operation)
+	{
+		double bestTime = std::numeric_limits<double>::infinity();
+		for (std::size_t run = 0; run < RunCount; ++run)
+		{
+			auto startTime = std::chrono::steady_clock::now();
+			for (std::size_t i = 0; i < iterations; ++i)
+				operation();
+
+			std::chrono::duration<double, std::nano> elapsedTime = std::chrono::steady_clock::now() - startTime;
+			bestTime = std::min(bestTime, elapsedTime.count() / iterations);
+		}
+
+		return bestTime;
+	}
+
+	std::size_t CountAllocations(const std::function<void()>& operation)
+	{
+		// Warm-up run, Nazara keeps released packet buffers for reuse
+		operation();
+
+		s_allocationCount = 0;
+		s_countAllocations = true;
+		operation();
+		s_countAllocations = false;
+
+		return s_allocationCount;
+	}
+
+	// Mirrors CommandStore::SerializePacket and its registered unserialize function, without the opcode
+	template<typename T>
+	BenchmarkResult RunBenchmark(std::string name, const T& payload, std::size_t iterations)
+	{
+		T& payloadRef = const_cast<T&>(payload); //< serialize functions take a non-const reference
+
+		auto Serialize = [&]
+		{
+			Nz::NetPacket packet;
+			bw::PacketSerializer serializer(packet, true);
+			bw::Packets::Serialize(serializer, payloadRef);
+			packet.FlushBits();
+		};
+
+		Nz::NetPacket serializedPacket;
+		{
+			bw::PacketSerializer serializer(serializedPacket, true);
+			bw::Packets::Serialize(serializer, payloadRef);
+			serializedPacket.FlushBits();
+		}
+
+		std::vector<Nz::UInt8> serializedData(serializedPacket.GetConstData() + Nz::NetPacket::HeaderSize, serializedPacket.GetConstData() + Nz::NetPacket::HeaderSize + serializedPacket.GetDataSize());
+
+		auto Unserialize = [&]
+		{
+			Nz::NetPacket packet(0, serializedData.data(), serializedData.size());
+
+			T data;
+			bw::PacketSerializer serializer(packet, false);
+			bw::Packets::Serialize(serializer, data);
+		};
+
+		BenchmarkResult result;
+		result.name = std::move(name);
+		result.bytesPerOp = serializedData.size();
+		result.serializeAllocsPerOp = CountAllocations(Serialize);
+		result.unserializeAllocsPerOp = CountAllocations(Unserialize);
+		result.serializeNsPerOp = MeasureNsPerOp(iterations, Serialize);
+		result.unserializeNsPerOp = MeasureNsPerOp(iterations, Unserialize);
+
+		return result;
+	}
+
+	std::vector<BenchmarkResult> RunBenchmarks(std::size_t iterations)
+	{
+		std::vector<BenchmarkResult> results;
+
+		// Per tick
+		results.push_back(RunBenchmark("MatchState (64 players, 192 props)", bw::BuildMatchState(64, 192), iterations));
+		results.push_back(RunBenchmark("EntitiesInputs (64 players)", bw::BuildEntitiesInputs(64), iterations));
+		results.push_back(RunBenchmark("PlayersInput (4 local players)", bw::BuildPlayersInput(4), iterations));
+		results.push_back(RunBenchmark("EntitiesPropertyUpdate (256 entities)", bw::BuildEntitiesPropertyUpdate(256), iterations));
+		results.push_back(RunBenchmark("HealthUpdate (64 entities)", bw::BuildHealthUpdate(64), iterations));
+
+		// Visibility changes and match join
+		results.push_back(RunBenchmark("CreateEntities (2048 entities)", bw::BuildCreateEntities(2048), std::max<std::size_t>(iterations / 10, 1)));
+		results.push_back(RunBenchmark("DeleteEntities (512 entities)", bw::BuildDeleteEntities(512), iterations));
+		results.push_back(RunBenchmark("NetworkStrings (512 strings)", bw::BuildNetworkStrings(512), iterations));
+		results.push_back(RunBenchmark("DownloadClientScriptResponse (64 KiB)", bw::BuildDownloadClientScriptResponse(64 * 1024), iterations));
+		results.push_back(RunBenchmark("ChatMessage (128 chars)", bw::BuildChatMessage(128), iterations));
+
+		return results;
+	}
+
+	bool CheckBaseline(const std::vector<BenchmarkResult>& results, const nlohmann::json& baseline, double timeTolerance)
+	{
+		bool success = true;
+		auto Fail = [&](const std::string& benchmarkName, const std::string& message)
+		{
+			fmt::print("REGRESSION {0}: {1}\n", benchmarkName, message);
+			success = false;
+		};
+
+		for (const BenchmarkResult& result : results)
+		{
+			auto it = baseline.find(result.name);
+			if (it == baseline.end() || it->is_null())
+			{
+				Fail(result.name, "not recorded in baseline (record it with --update-baseline)");
+				continue;
+			}
+
+			const nlohmann::json& reference = *it;
+
+			// Sizes and allocation counts are deterministic, any increase is a regression
+			std::size_t referenceBytes = reference.at("bytesPerOp");
+			if (result.bytesPerOp > referenceBytes)
+				Fail(result.name, fmt::format("{0} bytes/op (baseline: {1})", result.bytesPerOp, referenceBytes));
+
+			std::size_t referenceSerializeAllocs = reference.at("serializeAllocsPerOp");
+			if (result.serializeAllocsPerOp > referenceSerializeAllocs)
+				Fail(result.name, fmt::format("{0} serialization allocs/op (baseline: {1})", result.serializeAllocsPerOp, referenceSerializeAllocs));
+
+			std::size_t referenceUnserializeAllocs = reference.at("unserializeAllocsPerOp");
+			if (result.unserializeAllocsPerOp > referenceUnserializeAllocs)
+				Fail(result.name, fmt::format("{0} unserialization allocs/op (baseline: {1})", result.unserializeAllocsPerOp, referenceUnserializeAllocs));
+
+			// Timings depend on the machine, baseline has to be recorded where the gate runs
+			double referenceSerializeTime = reference.at("serializeNsPerOp");
+			if (result.serializeNsPerOp > referenceSerializeTime * (1.0 + timeTolerance))
+				Fail(result.name, fmt::format("{0:.1f} serialization ns/op (baseline: {1:.1f})", result.serializeNsPerOp, referenceSerializeTime));
+
+			double referenceUnserializeTime = reference.at("unserializeNsPerOp");
+			if (result.unserializeNsPerOp > referenceUnserializeTime * (1.0 + timeTolerance))
+				Fail(result.name, fmt::format("{0:.1f} unserialization ns/op (baseline: {1:.1f})", result.unserializeNsPerOp, referenceUnserializeTime));
+		}
+
+		return success;
+	}
+
+	void SaveBaseline(const std::vector<BenchmarkResult>& results, const std::filesystem::path& baselinePath)
+	{
+		nlohmann::json baseline = nlohmann::json::object();
+		for (const BenchmarkResult& result : results)
+		{
+			baseline[result.name] = nlohmann::json{
+				{ "bytesPerOp", result.bytesPerOp },
+				{ "serializeAllocsPerOp", result.serializeAllocsPerOp },
+				{ "serializeNsPerOp", result.serializeNsPerOp },
+				{ "unserializeAllocsPerOp", result.unserializeAllocsPerOp },
+				{ "unserializeNsPerOp", result.unserializeNsPerOp }
+			};
+		}
+
+		std::ofstream baselineFile(baselinePath, std::ios::trunc);
+		baselineFile << baseline.dump(1, '\t');
+	}
+
+	bool ParseSettings(int argc, char* argv[], Settings& settings)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			bool hasValue = (i + 1 < argc);
+
+			if (arg == "--baseline" && hasValue)
+				settings.baselinePath = argv[++i];
+			else if (arg == "--iterations" && hasValue)
+				settings.iterations = std::max<std::size_t>(std::strtoull(argv[++i], nullptr, 10), 1);
+			else if (arg == "--tolerance" && hasValue)
+				settings.timeTolerance = std::strtod(argv[++i], nullptr) / 100.0;
+			else if (arg == "--update-baseline")
+				settings.updateBaseline = true;
+			else
+			{
+				fmt::print("unknown or incomplete option {0}\n", arg);
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Settings settings;
+	if (!ParseSettings(argc, argv, settings))
+		return EXIT_FAILURE;
+
+	if (!settings.updateBaseline && !std::filesystem::is_regular_file(settings.baselinePath))
+	{
+		fmt::print("baseline {0} not found (record it with --update-baseline)\n", settings.baselinePath.generic_u8string());
+		return EXIT_FAILURE;
+	}
+
+	Nz::Initializer<Nz::Network> network;
+
+	std::vector<BenchmarkResult> results = RunBenchmarks(settings.iterations);
+
+	fmt::print("{0:<40} {1:>10} {2:>14} {3:>14} {4:>12} {5:>12}\n", "packet", "bytes/op", "ser. ns/op", "unser. ns/op", "ser. alloc", "unser. alloc");
+	for (const BenchmarkResult& result : results)
+		fmt::print("{0:<40} {1:>10} {2:>14.1f} {3:>14.1f} {4:>12} {5:>12}\n", result.name, result.bytesPerOp, result.serializeNsPerOp, result.unserializeNsPerOp, result.serializeAllocsPerOp, result.unserializeAllocsPerOp);
+
+	if (settings.updateBaseline)
+	{
+		SaveBaseline(results, settings.baselinePath);
+		fmt::print("baseline saved to {0}\n", settings.baselinePath.generic_u8string());
+		return EXIT_SUCCESS;
+	}
+
+	nlohmann::json baseline;
+	try
+	{
+		std::ifstream baselineFile(settings.baselinePath);
+		baseline = nlohmann::json::parse(baselineFile);
+	}
+	catch (const std::exception& e)
+	{
+		fmt::print("failed to load baseline {0}: {1}\n", settings.baselinePath.generic_u8string(), e.what());
+		return EXIT_FAILURE;
+	}
+
+	if (!CheckBaseline(results, baseline, settings.timeTolerance))
+		return EXIT_FAILURE;
+
+	fmt::print("no regression against {0}\n", settings.baselinePath.generic_u8string());
+	return EXIT_SUCCESS;
+}
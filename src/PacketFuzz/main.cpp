@@ -0,0 +1,142 @@
+// Copyright (C) 2020 Jérôme Leclercq
+// This file is part of the "Burgwar" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <CoreLib/Protocol/Packets.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+// Fuzzing entry point for every packet (client and server inbound), input is an opcode followed by the packet content.
+// Built with --fuzzer (clang), libFuzzer drives it. Otherwise the standalone main runs each file given as argument
+// or stdin, which works with AFL (afl-fuzz -- BWPacketFuzz @@) and to replay crashing inputs.
+
+namespace
+{
+	template<typename T>
+	void Unserialize(Nz::NetPacket& packet)
+	{
+		T data;
+		try
+		{
+			// Same decoding as CommandStore registered commands, malformed packets are expected to throw
+			bw::PacketSerializer serializer(packet, false);
+			bw::Packets::Serialize(serializer, data);
+		}
+		catch (const std::exception&)
+		{
+			return;
+		}
+
+		// Anything accepted must be encodable again (serializers assert their invariants when writing)
+		Nz::NetPacket reencodedPacket;
+		bw::PacketSerializer serializer(reencodedPacket, true);
+		bw::Packets::Serialize(serializer, data);
+		reencodedPacket.FlushBits();
+	}
+}
+
+extern "C" int LLVMFuzzerInitialize(int* /*argc*/, char*** /*argv*/)
+{
+	static Nz::Initializer<Nz::Network> network;
+	return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+	if (size == 0)
+		return 0;
+
+	Nz::NetPacket packet(0, data + 1, size - 1);
+
+	switch (static_cast<bw::PacketType>(data[0]))
+	{
+#define BURGWAR_FUZZ_PACKET(Type) case bw::PacketType::Type: Unserialize<bw::Packets::Type>(packet); break
+
+		BURGWAR_FUZZ_PACKET(Auth);
+		BURGWAR_FUZZ_PACKET(AuthFailure);
+		BURGWAR_FUZZ_PACKET(AuthSuccess);
+		BURGWAR_FUZZ_PACKET(ChatMessage);
+		BURGWAR_FUZZ_PACKET(ClientAssetList);
+		BURGWAR_FUZZ_PACKET(ClientScriptList);
+		BURGWAR_FUZZ_PACKET(ConsoleAnswer);
+		BURGWAR_FUZZ_PACKET(ControlEntity);
+		BURGWAR_FUZZ_PACKET(CreateEntities);
+		BURGWAR_FUZZ_PACKET(DeleteEntities);
+		BURGWAR_FUZZ_PACKET(DisableLayer);
+		BURGWAR_FUZZ_PACKET(DownloadClientScriptRequest);
+		BURGWAR_FUZZ_PACKET(DownloadClientScriptResponse);
+		BURGWAR_FUZZ_PACKET(EnableLayer);
+		BURGWAR_FUZZ_PACKET(EntitiesAnimation);
+		BURGWAR_FUZZ_PACKET(EntitiesDeath);
+		BURGWAR_FUZZ_PACKET(EntitiesInputs);
+		BURGWAR_FUZZ_PACKET(EntitiesLayerChange);
+		BURGWAR_FUZZ_PACKET(EntitiesPropertyUpdate);
+		BURGWAR_FUZZ_PACKET(EntityWeapon);
+		BURGWAR_FUZZ_PACKET(InputTimingCorrection);
+		BURGWAR_FUZZ_PACKET(HealthUpdate);
+		BURGWAR_FUZZ_PACKET(MapChange);
+		BURGWAR_FUZZ_PACKET(MatchData);
+		BURGWAR_FUZZ_PACKET(MatchState);
+		BURGWAR_FUZZ_PACKET(NetworkStrings);
+		BURGWAR_FUZZ_PACKET(PlayerChat);
+		BURGWAR_FUZZ_PACKET(PlayerConsoleCommand);
+		BURGWAR_FUZZ_PACKET(PlayerJoined);
+		BURGWAR_FUZZ_PACKET(PlayerLayer);
+		BURGWAR_FUZZ_PACKET(PlayerLeaving);
+		BURGWAR_FUZZ_PACKET(PlayerNameUpdate);
+		BURGWAR_FUZZ_PACKET(PlayerPingUpdate);
+		BURGWAR_FUZZ_PACKET(PlayersInput);
+		BURGWAR_FUZZ_PACKET(PlayerSelectWeapon);
+		BURGWAR_FUZZ_PACKET(PlayerWeapons);
+		BURGWAR_FUZZ_PACKET(Ready);
+		BURGWAR_FUZZ_PACKET(ScriptPacket);
+		BURGWAR_FUZZ_PACKET(UpdatePlayerName);
+
+#undef BURGWAR_FUZZ_PACKET
+
+		default:
+			break; //< CommandStore rejects unknown opcodes before decoding
+	}
+
+	return 0;
+}
+
+#ifndef BURGWAR_LIBFUZZER
+int main(int argc, char* argv[])
+{
+	LLVMFuzzerInitialize(&argc, &argv);
+
+	auto Run = [](std::istream& input)
+	{
+		std::vector<std::uint8_t> content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+		LLVMFuzzerTestOneInput(content.data(), content.size());
+	};
+
+	if (argc < 2)
+	{
+		Run(std::cin);
+		return EXIT_SUCCESS;
+	}
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::ifstream inputFile(argv[i], std::ios::binary);
+		if (!inputFile)
+		{
+			std::cerr << "failed to open " << argv[i] << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		Run(inputFile);
+	}
+
+	return EXIT_SUCCESS;
+}
+#endif
@@ -4,14 +4,20 @@
 
 #include <Server/ServerApp.hpp>
 #include <CoreLib/NetworkSessionManager.hpp>
+#include <CoreLib/LogSystem/Logger.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <Nazara/Core/Thread.hpp>
+#include <algorithm>
 
 namespace bw
 {
 	ServerApp::ServerApp(int argc, char* argv[]) :
 	Application(argc, argv),
 	BurgApp(LogSide::Server, m_configFile),
-	m_configFile(*this)
+	m_configFile(*this),
+	m_lastStatusPublication(0),
+	m_lastStatusTick(0),
+	m_peakUpdateTime(0)
 	{
 		if (!m_configFile.LoadFromFile("serverconfig.lua"))
 			throw std::runtime_error("Failed to load config file");
@@ -20,7 +26,27 @@ namespace bw
 		float tickRate = GetConfig().GetFloatValue<float>("GameSettings.TickRate");
 
 		m_match = std::make_unique<Match>(*this, "local", "gamemodes/test", std::move(map), 64, 1.f / tickRate);
-		m_match->GetSessions().CreateSessionManager<NetworkSessionManager>(Nz::UInt16(14768), 64);
+		NetworkSessionManager* sessionManager = m_match->GetSessions().CreateSessionManager<NetworkSessionManager>(Nz::UInt16(14768), 64);
+		sessionManager->SimulateNetworkConditions(NetworkConditions::FromConfig(GetConfig()));
+
+		if (Nz::UInt16 statusPort = GetConfig().GetIntegerValue<Nz::UInt16>("Network.StatusQuery.Port"); statusPort > 0)
+		{
+			StatusQueryResponder::Settings statusSettings;
+			statusSettings.globalBurst = GetConfig().GetFloatValue<float>("Network.StatusQuery.GlobalBurst");
+			statusSettings.globalRate = GetConfig().GetFloatValue<float>("Network.StatusQuery.GlobalRate");
+			statusSettings.sourceBurst = GetConfig().GetFloatValue<float>("Network.StatusQuery.Burst");
+			statusSettings.sourceRate = GetConfig().GetFloatValue<float>("Network.StatusQuery.Rate");
+
+			try
+			{
+				m_statusResponder = std::make_shared<StatusQueryResponder>(Nz::NetProtocol_Any, statusPort, statusSettings);
+				sessionManager->EnableStatusQueries(m_statusResponder);
+			}
+			catch (const std::exception& e)
+			{
+				bwLog(GetLogger(), LogLevel::Error, "Failed to enable status queries: {0}", e.what());
+			}
+		}
 	}
 
 	int ServerApp::Run()
@@ -29,12 +55,39 @@ namespace bw
 		{
 			BurgApp::Update();
 
+			Nz::UInt64 updateStartTime = Nz::GetElapsedMicroseconds();
 			m_match->Update(GetUpdateTime());
 
+			if (m_statusResponder)
+				PublishStatus(Nz::GetElapsedMicroseconds() - updateStartTime);
+
 			//TODO: Sleep only when server is not overloaded
 			Nz::Thread::Sleep(1);
 		}
 
 		return 0;
 	}
+
+	void ServerApp::PublishStatus(Nz::UInt64 updateTime)
+	{
+		m_peakUpdateTime = std::max(m_peakUpdateTime, updateTime);
+
+		// Query answers are served from this snapshot by the network thread, refreshing it more often would only cost the simulation
+		Nz::UInt64 appTime = GetAppTime();
+		if (appTime - m_lastStatusPublication < StatusPublicationInterval)
+			return;
+
+		Nz::UInt64 currentTick = m_match->GetCurrentTick();
+
+		ServerStatus status;
+		m_match->BuildStatus(status);
+		status.effectiveTickRate = (currentTick - m_lastStatusTick) * 1000.f / (appTime - m_lastStatusPublication);
+		status.peakUpdateTime = static_cast<Nz::UInt32>(std::min<Nz::UInt64>(m_peakUpdateTime, 0xFFFFFFFF));
+
+		m_statusResponder->Publish(status);
+
+		m_lastStatusPublication = appTime;
+		m_lastStatusTick = currentTick;
+		m_peakUpdateTime = 0;
+	}
 }
@@ -9,6 +9,7 @@
 
 #include <CoreLib/BurgApp.hpp>
 #include <CoreLib/Match.hpp>
+#include <CoreLib/StatusQueryResponder.hpp>
 #include <Server/ServerAppConfig.hpp>
 #include <NDK/Application.hpp>
 #include <memory>
@@ -23,9 +24,17 @@ namespace bw
 
 			int Run();
 
+			static constexpr Nz::UInt64 StatusPublicationInterval = 1000;
+
 		private:
+			void PublishStatus(Nz::UInt64 updateTime);
+
 			ServerAppConfig m_configFile;
+			std::shared_ptr<StatusQueryResponder> m_statusResponder;
 			std::unique_ptr<Match> m_match;
+			Nz::UInt64 m_lastStatusPublication;
+			Nz::UInt64 m_lastStatusTick;
+			Nz::UInt64 m_peakUpdateTime;
 	};
 }
 
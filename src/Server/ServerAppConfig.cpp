@@ -11,5 +11,10 @@ namespace bw
 	SharedAppConfig(app)
 	{
 		RegisterStringOption("GameSettings.MapFile");
+		RegisterFloatOption("Network.StatusQuery.Burst", 1.0, 1000.0, 4.0);
+		RegisterFloatOption("Network.StatusQuery.GlobalBurst", 1.0, 100'000.0, 100.0);
+		RegisterFloatOption("Network.StatusQuery.GlobalRate", 1.0, 100'000.0, 200.0); //< replies per second, all sources together
+		RegisterIntegerOption("Network.StatusQuery.Port", 0, 0xFFFF, 14769); //< 0 disables status queries
+		RegisterFloatOption("Network.StatusQuery.Rate", 0.01, 1000.0, 1.0); //< replies per second and per source address
 	}
 }